@@ -0,0 +1,226 @@
+// async_channel.h
+//
+// Bounded channel between C++20 coroutines, with a circular_buffer as the
+// storage.
+//
+//   co_await channel.push(value)  suspends while the channel is full;
+//   co_await channel.pop()        suspends while it is empty.
+//
+// A suspended operation is completed by its counterpart rather than retried.
+// pop() takes the oldest element and moves the first waiting pusher's value
+// into the freed slot; push() into an empty channel with a waiting popper
+// hands the value straight to that popper. The completed waiter is then
+// scheduled on the executor, so it resumes with its result already in hand and
+// waiters are served in FIFO order.
+//
+// Waiters are linked through their awaiter objects, which live in the
+// suspended coroutine frames, so suspending allocates nothing.
+//
+// Executor is anything with schedule(std::coroutine_handle<>), such as
+// single_thread_executor. The channel is not thread-safe: all coroutines using
+// it must run on the executor's thread.
+//
+
+#pragma once
+
+#include <cassert>
+#include <coroutine>
+#include <cstddef>
+#include <optional>
+#include <utility>
+
+#include "circular_buffer.h"
+#include "single_thread_executor.h"
+
+template <typename T, typename Executor = single_thread_executor>
+class async_channel
+{
+public:
+	using value_type = T;
+	using size_type = std::size_t;
+
+	class push_awaiter;
+	class pop_awaiter;
+
+	async_channel(Executor& executor, std::size_t capacity)
+		: m_executor{ executor },
+		m_buffer(capacity)
+	{
+		assert(capacity > 0);
+	}
+
+	async_channel(const async_channel&) = delete;
+	async_channel& operator=(const async_channel&) = delete;
+
+	~async_channel()
+	{
+		assert(!m_pushers.head && !m_poppers.head);
+	}
+
+	size_type capacity() const { return m_buffer.capacity(); }
+	size_type size() const { return m_buffer.size(); }
+	bool empty() const { return m_buffer.empty(); }
+	bool full() const { return m_buffer.size() == m_buffer.capacity(); }
+	bool closed() const { return m_closed; }
+
+	// co_await yields true once value is in the channel (or handed to a
+	// popper), false if the channel is closed.
+	push_awaiter push(value_type value) { return push_awaiter(*this, std::move(value)); }
+
+	// co_await yields the oldest element, or std::nullopt once the channel is
+	// closed and drained.
+	pop_awaiter pop() { return pop_awaiter(*this); }
+
+	// Non-suspending versions. try_push copies or moves value into the
+	// channel and returns true, or returns false, leaving an rvalue argument
+	// untouched, if the channel is full or closed.
+	bool try_push(const value_type& value)
+	{
+		if (!accepting())
+			return false;
+		value_type copy(value);
+		return push_from(copy);
+	}
+
+	bool try_push(value_type&& value) { return push_from(value); }
+
+	std::optional<value_type> try_pop()
+	{
+		if (m_buffer.empty())
+			return std::nullopt;
+		std::optional<value_type> result(std::move(m_buffer.front()));
+		m_buffer.pop_front();
+		if (push_awaiter* pusher = m_pushers.pop()) {
+			m_buffer.push_back(std::move(pusher->m_value));
+			pusher->m_accepted = true;
+			m_executor.schedule(pusher->m_handle);
+		}
+		return result;
+	}
+
+	// Wakes every waiter: pending pushes fail, pending pops get std::nullopt.
+	// Elements already in the channel can still be popped.
+	void close()
+	{
+		m_closed = true;
+		while (push_awaiter* pusher = m_pushers.pop())
+			m_executor.schedule(pusher->m_handle);
+		while (pop_awaiter* popper = m_poppers.pop())
+			m_executor.schedule(popper->m_handle);
+	}
+
+private:
+	bool accepting() const { return !m_closed && (m_poppers.head || !full()); }
+
+	// Moves value into the channel, or hands it to a waiting popper, if there
+	// is room; otherwise leaves it alone for push_awaiter to keep.
+	bool push_from(value_type& value)
+	{
+		if (!accepting())
+			return false;
+		if (pop_awaiter* popper = m_poppers.pop()) {
+			popper->m_result.emplace(std::move(value));
+			m_executor.schedule(popper->m_handle);
+			return true;
+		}
+		m_buffer.push_back(std::move(value));
+		return true;
+	}
+
+	// Intrusive FIFO of suspended awaiters.
+	template <typename Awaiter>
+	struct wait_list {
+		Awaiter* head = nullptr;
+		Awaiter* tail = nullptr;
+
+		void push(Awaiter* waiter)
+		{
+			waiter->m_next = nullptr;
+			if (tail)
+				tail->m_next = waiter;
+			else
+				head = waiter;
+			tail = waiter;
+		}
+
+		Awaiter* pop()
+		{
+			Awaiter* waiter = head;
+			if (waiter) {
+				head = waiter->m_next;
+				if (!head)
+					tail = nullptr;
+			}
+			return waiter;
+		}
+	};
+
+	Executor& m_executor;
+	circular_buffer<value_type> m_buffer;
+	wait_list<push_awaiter> m_pushers;
+	wait_list<pop_awaiter> m_poppers;
+	bool m_closed = false;
+};
+
+template <typename T, typename Executor>
+class async_channel<T, Executor>::push_awaiter
+{
+public:
+	bool await_ready()
+	{
+		m_accepted = m_channel.push_from(m_value);
+		return m_accepted || m_channel.m_closed;
+	}
+
+	void await_suspend(std::coroutine_handle<> handle)
+	{
+		m_handle = handle;
+		m_channel.m_pushers.push(this);
+	}
+
+	bool await_resume() const noexcept { return m_accepted; }
+
+private:
+	friend class async_channel<T, Executor>;
+
+	push_awaiter(async_channel& channel, value_type&& value)
+		: m_channel{ channel }, m_value{ std::move(value) }
+	{}
+
+	async_channel& m_channel;
+	value_type m_value;
+	bool m_accepted = false;
+	std::coroutine_handle<> m_handle;
+	push_awaiter* m_next = nullptr;
+};
+
+template <typename T, typename Executor>
+class async_channel<T, Executor>::pop_awaiter
+{
+public:
+	bool await_ready()
+	{
+		m_result = m_channel.try_pop();
+		return m_result || m_channel.m_closed;
+	}
+
+	void await_suspend(std::coroutine_handle<> handle)
+	{
+		m_handle = handle;
+		m_channel.m_poppers.push(this);
+	}
+
+	std::optional<value_type> await_resume() { return std::move(m_result); }
+
+private:
+	friend class async_channel<T, Executor>;
+
+	explicit pop_awaiter(async_channel& channel)
+		: m_channel{ channel }
+	{}
+
+	async_channel& m_channel;
+	std::optional<value_type> m_result;
+	std::coroutine_handle<> m_handle;
+	pop_awaiter* m_next = nullptr;
+};
@@ -0,0 +1,104 @@
+#include "catch.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#include "async_channel.h"
+#include "circular_buffer.h"
+#include "single_thread_executor.h"
+
+namespace {
+
+constexpr std::uint64_t messages = 1 << 20;
+
+// The usual blocking alternative: circular_buffer behind a mutex, with a
+// condition variable for each direction and a thread per side.
+class locked_queue
+{
+public:
+	explicit locked_queue(std::size_t capacity) : m_buffer(capacity) {}
+
+	void push(std::uint64_t value)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_not_full.wait(lock, [&] { return m_buffer.size() < m_buffer.capacity(); });
+		m_buffer.push_back(value);
+		lock.unlock();
+		m_not_empty.notify_one();
+	}
+
+	std::uint64_t pop()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_not_empty.wait(lock, [&] { return !m_buffer.empty(); });
+		const std::uint64_t value = m_buffer.front();
+		m_buffer.pop_front();
+		lock.unlock();
+		m_not_full.notify_one();
+		return value;
+	}
+
+private:
+	std::mutex m_mutex;
+	std::condition_variable m_not_full;
+	std::condition_variable m_not_empty;
+	circular_buffer<std::uint64_t> m_buffer;
+};
+
+task produce(async_channel<std::uint64_t>& channel)
+{
+	for (std::uint64_t i = 0; i < messages; ++i)
+		co_await channel.push(i);
+	channel.close();
+}
+
+task consume(async_channel<std::uint64_t>& channel, std::uint64_t& sum)
+{
+	while (std::optional<std::uint64_t> value = co_await channel.pop())
+		sum += *value;
+}
+
+void report(const char* name, std::chrono::steady_clock::time_point start, std::uint64_t sum)
+{
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::printf("%-28s %8.1f ns/message  (sum %llu)\n",
+		name, seconds * 1e9 / messages, static_cast<unsigned long long>(sum));
+}
+
+} // namespace
+
+TEST_CASE("async_channel against a mutex and condition variable queue", "[.][benchmark][async_channel]")
+{
+	for (std::size_t capacity : { 1u, 64u }) {
+		std::printf("capacity %zu\n", capacity);
+		{
+			single_thread_executor ex;
+			async_channel<std::uint64_t> channel(ex, capacity);
+			std::uint64_t sum = 0;
+			const auto start = std::chrono::steady_clock::now();
+			ex.spawn(produce(channel));
+			ex.spawn(consume(channel, sum));
+			ex.run();
+			report("  async_channel coroutines", start, sum);
+		}
+		{
+			locked_queue queue(capacity);
+			std::uint64_t sum = 0;
+			const auto start = std::chrono::steady_clock::now();
+			std::thread consumer([&] {
+				for (std::uint64_t i = 0; i < messages; ++i)
+					sum += queue.pop();
+			});
+			for (std::uint64_t i = 0; i < messages; ++i)
+				queue.push(i);
+			consumer.join();
+			report("  mutex + condvar threads", start, sum);
+		}
+	}
+	SUCCEED();
+}
@@ -0,0 +1,157 @@
+#include "catch.hpp"
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "async_channel.h"
+#include "single_thread_executor.h"
+
+namespace {
+
+task produce(async_channel<int>& channel, int first, int count, std::vector<int>& log)
+{
+	for (int i = first; i < first + count; ++i) {
+		co_await channel.push(i);
+		log.push_back(i);
+	}
+}
+
+task consume(async_channel<int>& channel, std::vector<int>& received)
+{
+	while (std::optional<int> value = co_await channel.pop())
+		received.push_back(*value);
+}
+
+} // namespace
+
+TEST_CASE("Producer suspends when full and consumer when empty", "[async_channel]")
+{
+	single_thread_executor ex;
+	async_channel<int> channel(ex, 2);
+	std::vector<int> pushed, received;
+
+	ex.spawn(produce(channel, 0, 5, pushed));
+	ex.run();
+	// Two fit; the third push is suspended with its value.
+	REQUIRE(channel.full());
+	REQUIRE(pushed == std::vector<int>{ 0, 1 });
+
+	ex.spawn(consume(channel, received));
+	ex.run();
+	REQUIRE(pushed.size() == 5);
+	REQUIRE(received == std::vector<int>{ 0, 1, 2, 3, 4 });
+	REQUIRE(channel.empty());
+
+	// The consumer is now suspended; a push hands the value straight over.
+	int value = 7;
+	REQUIRE(channel.try_push(value));
+	REQUIRE(channel.empty());
+	ex.run();
+	REQUIRE(received.back() == 7);
+
+	channel.close();
+	ex.run();
+	REQUIRE(!channel.try_push(value));
+}
+
+TEST_CASE("try_push copies lvalues and moves rvalues only on success", "[async_channel]")
+{
+	single_thread_executor ex;
+	async_channel<std::unique_ptr<int>> owners(ex, 1);
+	auto first = std::make_unique<int>(1);
+	REQUIRE(owners.try_push(std::move(first)));
+	REQUIRE(!first);
+
+	// Full: the argument is left as it was.
+	auto second = std::make_unique<int>(2);
+	REQUIRE(!owners.try_push(std::move(second)));
+	REQUIRE(second);
+	REQUIRE(*second == 2);
+
+	async_channel<std::string> strings(ex, 1);
+	const std::string text = "kept";
+	REQUIRE(strings.try_push(text));
+	REQUIRE(text == "kept");
+	REQUIRE(!strings.try_push(text));
+	REQUIRE(*strings.try_pop() == "kept");
+}
+
+TEST_CASE("Waiters are served in FIFO order", "[async_channel]")
+{
+	single_thread_executor ex;
+	async_channel<int> channel(ex, 1);
+	std::vector<int> pushed, received;
+
+	ex.spawn(produce(channel, 0, 3, pushed));
+	ex.spawn(produce(channel, 100, 3, pushed));
+	ex.run();
+	REQUIRE(channel.size() == 1);
+
+	// 1 and 100 are waiting in that order and move into the buffer as the
+	// consumer frees it; after that the producers alternate.
+	ex.spawn(consume(channel, received));
+	ex.run();
+	REQUIRE(received == std::vector<int>{ 0, 1, 100, 2, 101, 102 });
+	channel.close();
+	ex.run();
+}
+
+TEST_CASE("Closing wakes pending pushes and pops", "[async_channel]")
+{
+	single_thread_executor ex;
+	async_channel<std::unique_ptr<int>> channel(ex, 1);
+
+	int failed_pushes = 0, empty_pops = 0;
+	auto pusher = [&]() -> task {
+		if (!co_await channel.push(std::make_unique<int>(1)))
+			++failed_pushes;
+	};
+	auto popper = [&]() -> task {
+		if (!co_await channel.pop())
+			++empty_pops;
+	};
+
+	ex.spawn(pusher());
+	ex.spawn(pusher());
+	ex.run();
+	channel.close();
+	ex.run();
+	REQUIRE(failed_pushes == 1);
+
+	// What was pushed before the close can still be popped.
+	std::optional<std::unique_ptr<int>> value = channel.try_pop();
+	REQUIRE(value);
+	REQUIRE(**value == 1);
+
+	ex.spawn(popper());
+	ex.run();
+	REQUIRE(empty_pops == 1);
+}
+
+TEST_CASE("Many producers and consumers", "[async_channel]")
+{
+	single_thread_executor ex;
+	async_channel<int> channel(ex, 4);
+	std::vector<int> pushed;
+	std::vector<std::vector<int>> received(3);
+
+	for (int p = 0; p < 4; ++p)
+		ex.spawn(produce(channel, p * 1000, 250, pushed));
+	for (auto& r : received)
+		ex.spawn(consume(channel, r));
+	ex.run();
+	channel.close();
+	ex.run();
+
+	std::size_t total = 0;
+	long long sum = 0;
+	for (const auto& r : received) {
+		total += r.size();
+		for (int v : r)
+			sum += v;
+	}
+	REQUIRE(total == 1000);
+	REQUIRE(sum == 4 * (249 * 250 / 2) + 250 * (0 + 1000 + 2000 + 3000));
+}
@@ -0,0 +1,401 @@
+// async_logger.h
+//
+// Logger for latency-critical threads. Logging a message only copies a
+// compact binary record into the calling thread's own ring: the format string
+// pointer, a pointer to a static table of argument kinds (one per argument
+// type list, built at compile time) and the raw argument bits. A background
+// thread drains all rings, in timestamp order, formats the records with
+// printf-style conversion and writes each batch with one fwrite.
+//
+//   async_logger logger(stderr);
+//   auto log = logger.attach();               // once per thread
+//   log.log("order %llu filled at %.2f", id, price);
+//
+// Records are fixed size; a message takes at most max_args arguments of
+// arithmetic, pointer or C string type. Strings are logged by pointer, so
+// they must be literals or otherwise outlive the next flush(). When a
+// thread's ring is full the message is dropped and counted rather than
+// blocking the caller.
+//
+// The rings are the per-thread shards of a sharded_ring, so producers never
+// contend with each other or wait for the writer.
+//
+
+#pragma once
+
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+#include "sharded_ring.h"
+
+enum class log_arg : unsigned char { signed_int, unsigned_int, floating, pointer, string };
+
+namespace logger_detail {
+
+constexpr std::size_t max_args = 5;
+
+// What format_record needs to know about the arguments of one log call; one
+// static instance per argument type list.
+struct signature {
+	std::size_t count;
+	log_arg kinds[max_args];
+};
+
+template <typename T>
+constexpr log_arg kind_of()
+{
+	using U = typename std::decay<T>::type;
+	static_assert(std::is_arithmetic<U>::value || std::is_pointer<U>::value, "Log arguments must be arithmetic, pointers or C strings");
+	if constexpr (std::is_same<U, const char*>::value || std::is_same<U, char*>::value)
+		return log_arg::string;
+	else if constexpr (std::is_pointer<U>::value)
+		return log_arg::pointer;
+	else if constexpr (std::is_floating_point<U>::value)
+		return log_arg::floating;
+	else if constexpr (std::is_signed<U>::value)
+		return log_arg::signed_int;
+	else
+		return log_arg::unsigned_int;
+}
+
+template <typename... Args>
+struct signature_of {
+	static_assert(sizeof...(Args) <= max_args, "Too many log arguments");
+	static constexpr signature value{ sizeof...(Args), { kind_of<Args>()... } };
+};
+
+template <typename T>
+std::uint64_t to_bits(const T& value)
+{
+	using U = typename std::decay<T>::type;
+	std::uint64_t bits = 0;
+	if constexpr (std::is_floating_point<U>::value) {
+		const double d = static_cast<double>(value);
+		std::memcpy(&bits, &d, sizeof d);
+	}
+	else if constexpr (std::is_pointer<U>::value) {
+		bits = reinterpret_cast<std::uintptr_t>(value);
+	}
+	else if constexpr (std::is_signed<U>::value) {
+		bits = static_cast<std::uint64_t>(static_cast<std::int64_t>(value));
+	}
+	else {
+		bits = static_cast<std::uint64_t>(value);
+	}
+	return bits;
+}
+
+template <typename V>
+void append_formatted(std::string& out, const char* spec, V value)
+{
+	char buffer[128];
+	const int n = std::snprintf(buffer, sizeof buffer, spec, value);
+	if (n < 0)
+		return;
+	if (static_cast<std::size_t>(n) < sizeof buffer) {
+		out.append(buffer, static_cast<std::size_t>(n));
+		return;
+	}
+	const std::size_t at = out.size();
+	out.resize(at + static_cast<std::size_t>(n) + 1);
+	std::snprintf(&out[at], static_cast<std::size_t>(n) + 1, spec, value);
+	out.resize(at + static_cast<std::size_t>(n));
+}
+
+template <typename V>
+void append_integer(std::string& out, V value)
+{
+	char buffer[24];
+	const auto result = std::to_chars(buffer, buffer + sizeof buffer, value);
+	out.append(buffer, static_cast<std::size_t>(result.ptr - buffer));
+}
+
+// Appends "[seconds.microseconds] " with the seconds right-aligned in five
+// columns.
+inline void append_elapsed(std::string& out, std::chrono::nanoseconds elapsed)
+{
+	const auto us = static_cast<std::uint64_t>(elapsed.count()) / 1000;
+	char buffer[40] = "[     ";
+	char* const seconds_end = std::to_chars(buffer + 1, buffer + 21, us / 1000000).ptr;
+	std::size_t len = static_cast<std::size_t>(seconds_end - buffer);
+	if (len < 6) {
+		// Right-align: move the digits to end at column 6.
+		const std::size_t digits = len - 1;
+		std::memmove(buffer + 6 - digits, buffer + 1, digits);
+		std::memset(buffer + 1, ' ', 5 - digits);
+		len = 6;
+	}
+	char micros[8];
+	const std::uint64_t fraction = us % 1000000 + 1000000;
+	std::to_chars(micros, micros + sizeof micros, fraction);
+	// micros is "1dddddd"; replace the leading 1 with the point.
+	micros[0] = '.';
+	std::memcpy(buffer + len, micros, 7);
+	len += 7;
+	buffer[len++] = ']';
+	buffer[len++] = ' ';
+	out.append(buffer, len);
+}
+
+// Expands format with the recorded arguments, one conversion at a time. The
+// argument's recorded kind decides how it is passed to snprintf; length
+// modifiers in the format are ignored and conversions that do not suit the
+// kind are replaced with one that does. Conversions without a matching
+// argument are copied through literally.
+inline void format_record(std::string& out, const char* format, const signature& sig, const std::uint64_t* args)
+{
+	std::size_t next = 0;
+	const char* p = format;
+	while (*p) {
+		if (*p != '%') {
+			const char* end = std::strchr(p, '%');
+			if (!end)
+				end = p + std::strlen(p);
+			out.append(p, static_cast<std::size_t>(end - p));
+			p = end;
+			continue;
+		}
+		if (p[1] == '%') {
+			out += '%';
+			p += 2;
+			continue;
+		}
+
+		// %[flags][width][.precision][length]conversion
+		const char* const start = p++;
+		char spec[32] = "%";
+		std::size_t len = 1;
+		while (*p && std::strchr("-+ #0123456789.", *p)) {
+			if (len < sizeof spec - 4)
+				spec[len++] = *p;
+			++p;
+		}
+		while (*p && std::strchr("hlLqjzt", *p))
+			++p;
+		const char conversion = *p;
+		if (conversion)
+			++p;
+		if (next == sig.count || !conversion) {
+			out.append(start, static_cast<std::size_t>(p - start));
+			continue;
+		}
+
+		const std::uint64_t bits = args[next];
+		const log_arg kind = sig.kinds[next];
+		++next;
+		const bool float_conversion = conversion && std::strchr("fFeEgGaA", conversion);
+		switch (kind) {
+		case log_arg::string: {
+			const char* s = reinterpret_cast<const char*>(static_cast<std::uintptr_t>(bits));
+			if (len == 1) {
+				out += s ? s : "(null)";
+				break;
+			}
+			spec[len++] = 's';
+			spec[len] = '\0';
+			append_formatted(out, spec, s ? s : "(null)");
+			break;
+		}
+		case log_arg::pointer:
+			spec[len++] = 'p';
+			spec[len] = '\0';
+			append_formatted(out, spec, reinterpret_cast<const void*>(static_cast<std::uintptr_t>(bits)));
+			break;
+		case log_arg::floating: {
+			double d;
+			std::memcpy(&d, &bits, sizeof d);
+			spec[len++] = float_conversion ? conversion : 'g';
+			spec[len] = '\0';
+			append_formatted(out, spec, d);
+			break;
+		}
+		case log_arg::signed_int:
+		case log_arg::unsigned_int:
+			if (float_conversion) {
+				spec[len++] = conversion;
+				spec[len] = '\0';
+				append_formatted(out, spec, kind == log_arg::signed_int
+					? static_cast<double>(static_cast<std::int64_t>(bits)) : static_cast<double>(bits));
+			}
+			else if (conversion == 'c') {
+				spec[len++] = 'c';
+				spec[len] = '\0';
+				append_formatted(out, spec, static_cast<int>(bits));
+			}
+			else if (len == 1 && !std::strchr("oxX", conversion)) {
+				// No flags, width or precision: the common case, without snprintf.
+				if (kind == log_arg::signed_int && conversion != 'u')
+					append_integer(out, static_cast<std::int64_t>(bits));
+				else
+					append_integer(out, bits);
+			}
+			else if (std::strchr("ouxX", conversion) || (kind == log_arg::unsigned_int && !std::strchr("di", conversion))) {
+				spec[len++] = 'l';
+				spec[len++] = 'l';
+				spec[len++] = std::strchr("ouxX", conversion) ? conversion : 'u';
+				spec[len] = '\0';
+				append_formatted(out, spec, static_cast<unsigned long long>(bits));
+			}
+			else {
+				spec[len++] = 'l';
+				spec[len++] = 'l';
+				spec[len++] = 'd';
+				spec[len] = '\0';
+				append_formatted(out, spec, static_cast<long long>(static_cast<std::int64_t>(bits)));
+			}
+			break;
+		}
+	}
+}
+
+} // namespace logger_detail
+
+class async_logger
+{
+public:
+	static constexpr std::size_t max_args = logger_detail::max_args;
+
+	// 64 bytes with the ring's timestamp.
+	struct record {
+		const char* format;
+		const logger_detail::signature* signature;
+		std::uint64_t args[max_args];
+	};
+
+	class writer;
+
+	// Writes to out (which the logger does not close) from a background
+	// thread. Up to threads writers may be attached at once, each with a ring
+	// of capacity records. The writer thread checks for records every
+	// poll_interval when idle.
+	explicit async_logger(std::FILE* out, std::size_t threads = 16, std::size_t capacity = 4096,
+		std::chrono::microseconds poll_interval = std::chrono::microseconds(1000))
+		: m_out{ out },
+		m_poll_interval{ poll_interval },
+		m_rings(threads, capacity),
+		m_start{ steady_clock_stamp()() },
+		m_thread([this] { run(); })
+	{}
+
+	async_logger(const async_logger&) = delete;
+	async_logger& operator=(const async_logger&) = delete;
+
+	// Writes everything still queued, then stops the writer thread.
+	~async_logger()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_wake.notify_one();
+		m_thread.join();
+	}
+
+	// Claims a ring for the calling thread; throws std::length_error if all
+	// are taken.
+	writer attach();
+
+	// Blocks until everything logged before the call has been written.
+	void flush()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		const std::uint64_t ticket = ++m_flush_requested;
+		m_wake.notify_one();
+		m_flushed_cv.wait(lock, [&] { return m_flushed >= ticket; });
+	}
+
+	// Messages dropped because a thread's ring was full.
+	std::uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+	using ring_type = sharded_ring<record>;
+
+	void run()
+	{
+		std::string text;
+		std::unique_lock<std::mutex> lock(m_mutex);
+		for (;;) {
+			const std::uint64_t requested = m_flush_requested;
+			const bool stopping = m_stop;
+			lock.unlock();
+
+			text.clear();
+			m_rings.drain([&](const ring_type::entry& e) {
+				const std::chrono::steady_clock::duration elapsed(static_cast<std::chrono::steady_clock::rep>(e.stamp - m_start));
+				logger_detail::append_elapsed(text, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed));
+				logger_detail::format_record(text, e.value.format, *e.value.signature, e.value.args);
+				text += '\n';
+			});
+			if (!text.empty()) {
+				std::fwrite(text.data(), 1, text.size(), m_out);
+				std::fflush(m_out);
+			}
+
+			lock.lock();
+			if (requested > m_flushed) {
+				m_flushed = requested;
+				m_flushed_cv.notify_all();
+			}
+			if (stopping)
+				return;
+			if (text.empty())
+				m_wake.wait_for(lock, m_poll_interval, [&] { return m_stop || m_flush_requested > m_flushed; });
+		}
+	}
+
+	std::FILE* const m_out;
+	const std::chrono::microseconds m_poll_interval;
+	ring_type m_rings;
+	const std::uint64_t m_start;
+	std::atomic<std::uint64_t> m_dropped{ 0 };
+
+	// Control only; never touched when logging.
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::condition_variable m_flushed_cv;
+	std::uint64_t m_flush_requested = 0;
+	std::uint64_t m_flushed = 0;
+	bool m_stop = false;
+
+	std::thread m_thread;
+};
+
+// Logs from the one thread that attached it.
+class async_logger::writer
+{
+public:
+	template <typename... Args>
+	bool log(const char* format, const Args&... args)
+	{
+		const record r{ format, &logger_detail::signature_of<Args...>::value, { logger_detail::to_bits(args)... } };
+		if (m_producer.try_push(r))
+			return true;
+		m_logger->m_dropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+private:
+	friend class async_logger;
+
+	writer(async_logger* logger, ring_type::producer&& producer)
+		: m_logger{ logger }, m_producer{ std::move(producer) }
+	{}
+
+	async_logger* m_logger;
+	ring_type::producer m_producer;
+};
+
+inline async_logger::writer async_logger::attach()
+{
+	return writer(this, m_rings.attach());
+}
@@ -0,0 +1,60 @@
+#include "catch.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+#include "async_logger.h"
+
+namespace {
+
+constexpr int messages = 1 << 17;
+
+double ns_per_call(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / messages;
+}
+
+} // namespace
+
+TEST_CASE("async_logger against synchronous fprintf", "[.][benchmark][async_logger]")
+{
+	std::FILE* out = std::fopen("/dev/null", "w");
+	REQUIRE(out);
+
+	// Both log the same message; only the calling thread's time is measured.
+	{
+		const auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < messages; ++i)
+			std::fprintf(out, "order %d filled %u lots at %.4f on %s\n", i, 17u, 101.25 + i, "XNAS");
+		std::fflush(out);
+		std::printf("%-24s %7.1f ns/message\n", "fprintf", ns_per_call(start));
+	}
+	{
+		// Bursts that fit the default ring, with the writer catching up in
+		// between; only the bursts are timed.
+		constexpr int burst = 2048;
+		async_logger logger(out);
+		auto log = logger.attach();
+		for (int i = 0; i < burst; ++i)
+			log.log("warm up %d", i);
+		logger.flush();
+
+		std::chrono::steady_clock::duration producer{}, writer{};
+		for (int b = 0; b < messages / burst; ++b) {
+			auto start = std::chrono::steady_clock::now();
+			for (int i = b * burst; i < (b + 1) * burst; ++i)
+				log.log("order %d filled %u lots at %.4f on %s", i, 17u, 101.25 + i, "XNAS");
+			producer += std::chrono::steady_clock::now() - start;
+			start = std::chrono::steady_clock::now();
+			logger.flush();
+			writer += std::chrono::steady_clock::now() - start;
+		}
+		std::printf("%-24s %7.1f ns/message  (then %.1f ns/message to format and write, %llu dropped)\n", "async_logger",
+			std::chrono::duration<double, std::nano>(producer).count() / messages,
+			std::chrono::duration<double, std::nano>(writer).count() / messages,
+			static_cast<unsigned long long>(logger.dropped()));
+	}
+	std::fclose(out);
+	SUCCEED();
+}
@@ -0,0 +1,155 @@
+#include "catch.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "async_logger.h"
+
+namespace {
+
+template <typename... Args>
+std::string format(const char* fmt, const Args&... args)
+{
+	const std::uint64_t bits[async_logger::max_args + 1] = { logger_detail::to_bits(args)... };
+	std::string out;
+	logger_detail::format_record(out, fmt, logger_detail::signature_of<Args...>::value, bits);
+	return out;
+}
+
+std::vector<std::string> read_lines(std::FILE* f)
+{
+	std::vector<std::string> lines;
+	std::rewind(f);
+	char line[256];
+	while (std::fgets(line, sizeof line, f)) {
+		std::string s(line);
+		if (!s.empty() && s.back() == '\n')
+			s.pop_back();
+		lines.push_back(s);
+	}
+	return lines;
+}
+
+} // namespace
+
+TEST_CASE("Records format like printf", "[async_logger]")
+{
+	REQUIRE(format("plain") == "plain");
+	REQUIRE(format("%d and %5.2f%%", -42, 3.14159) == "-42 and  3.14%");
+	REQUIRE(format("%llu %lx %zu", std::uint64_t{ 18446744073709551615u }, 255ul, std::size_t{ 7 }) == "18446744073709551615 ff 7");
+	REQUIRE(format("%s=%-4d|", "width", 3) == "width=3   |");
+	REQUIRE(format("%c%c", 'o', 'k') == "ok");
+	REQUIRE(format("%.1f", 2.0f) == "2.0");
+
+	// Conversions are adapted to the recorded argument kinds.
+	REQUIRE(format("%d %s %f", 1.5, 7u, 2) == "1.5 7 2.000000");
+	const char* null_string = nullptr;
+	REQUIRE(format("%s", null_string) == "(null)");
+	int x = 0;
+	REQUIRE(format("%p", &x) == [&] { char b[32]; std::snprintf(b, sizeof b, "%p", static_cast<void*>(&x)); return std::string(b); }());
+
+	// Missing arguments leave the conversion as it was; extra ones are ignored.
+	REQUIRE(format("%d %d", 1) == "1 %d");
+	REQUIRE(format("none", 1, 2) == "none");
+
+	// Long output falls back to a second snprintf.
+	REQUIRE(format("%300d", 1).size() == 300);
+}
+
+TEST_CASE("Elapsed time prefix", "[async_logger]")
+{
+	auto elapsed = [](long long ns) {
+		std::string out;
+		logger_detail::append_elapsed(out, std::chrono::nanoseconds(ns));
+		return out;
+	};
+	REQUIRE(elapsed(0) == "[    0.000000] ");
+	REQUIRE(elapsed(1234567891) == "[    1.234567] ");
+	REQUIRE(elapsed(98765000000000LL) == "[98765.000000] ");
+	REQUIRE(elapsed(123456000000000LL) == "[123456.000000] ");
+}
+
+TEST_CASE("Logged messages are written by the background thread", "[async_logger]")
+{
+	std::FILE* out = std::tmpfile();
+	REQUIRE(out);
+	{
+		async_logger logger(out, 2, 8);
+		auto log = logger.attach();
+		REQUIRE(log.log("first %d", 1));
+		REQUIRE(log.log("second %s", "two"));
+		logger.flush();
+
+		const auto lines = read_lines(out);
+		REQUIRE(lines.size() == 2);
+		REQUIRE(lines[0].size() > 15);
+		REQUIRE(lines[0].substr(0, 1) == "[");
+		REQUIRE(lines[0].substr(lines[0].size() - 7) == "first 1");
+		REQUIRE(lines[1].substr(lines[1].size() - 10) == "second two");
+
+		std::fseek(out, 0, SEEK_END);
+		REQUIRE(log.log("on the way out"));
+	}
+	// The destructor writes what is left.
+	const auto lines = read_lines(out);
+	REQUIRE(lines.size() == 3);
+	std::fclose(out);
+}
+
+TEST_CASE("A full ring drops and counts", "[async_logger]")
+{
+	std::FILE* out = std::tmpfile();
+	REQUIRE(out);
+	// A poll interval long enough that the writer does not empty the ring
+	// while we fill it.
+	async_logger logger(out, 1, 4, std::chrono::seconds(10));
+	auto log = logger.attach();
+	int accepted = 0;
+	for (int i = 0; i < 6; ++i)
+		accepted += log.log("%d", i);
+	REQUIRE(accepted >= 4);
+	REQUIRE(logger.dropped() == static_cast<std::uint64_t>(6 - accepted));
+	logger.flush();
+	REQUIRE(read_lines(out).size() == static_cast<std::size_t>(accepted));
+	std::fclose(out);
+}
+
+TEST_CASE("Many threads log into one time-ordered stream", "[async_logger]")
+{
+	constexpr int threads = 4;
+	constexpr int per_thread = 500;
+	std::FILE* out = std::tmpfile();
+	REQUIRE(out);
+	{
+		// A thread that finishes hands its ring, maybe still full, to the next
+		// one to attach, so size the rings for everything.
+		async_logger logger(out, threads, threads * per_thread);
+		std::vector<std::thread> workers;
+		for (int t = 0; t < threads; ++t) {
+			workers.emplace_back([&, t] {
+				auto log = logger.attach();
+				for (int i = 0; i < per_thread; ++i)
+					log.log("thread %d message %d", t, i);
+			});
+		}
+		for (auto& w : workers)
+			w.join();
+		REQUIRE(logger.dropped() == 0);
+	}
+
+	const auto lines = read_lines(out);
+	REQUIRE(lines.size() == threads * per_thread);
+	std::vector<int> next(threads, 0);
+	bool ordered = true;
+	for (const auto& line : lines) {
+		int t = -1, i = -1;
+		ordered = ordered && std::sscanf(line.c_str() + line.find(']') + 1, " thread %d message %d", &t, &i) == 2
+			&& t >= 0 && t < threads && next[t]++ == i;
+	}
+	REQUIRE(ordered);
+	std::fclose(out);
+}
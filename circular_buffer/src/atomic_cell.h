@@ -0,0 +1,64 @@
+// atomic_cell.h
+//
+// Storage for a trivially copyable value that one thread may overwrite while
+// others are copying it out, as the readers of a seqlock do. The bytes are
+// held in std::atomic<std::uint64_t> words and accessed with relaxed loads
+// and stores, so a copy that races with a write is torn but is not a data
+// race: under the memory model a plain copy there would be undefined
+// behaviour, even though the torn copy is thrown away, and TSan reports it.
+// On the usual targets the relaxed word accesses compile to plain moves.
+//
+// Readers must still detect torn copies themselves, by checking a sequence
+// number before and after (with an acquire fence between the copy and the
+// second check), and the writer must order its stores the same way.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+template <typename T>
+class atomic_cell
+{
+	static_assert(std::is_trivially_copyable<T>::value, "atomic_cell copies values as bytes");
+
+public:
+	using value_type = T;
+
+	void store(const value_type& value)
+	{
+		const auto* bytes = reinterpret_cast<const unsigned char*>(&value);
+		for (std::size_t i = 0; i < word_count; ++i) {
+			word_type word = 0;
+			std::memcpy(&word, bytes + i * sizeof(word_type), bytes_in(i));
+			m_words[i].store(word, std::memory_order_relaxed);
+		}
+	}
+
+	void load(value_type& out) const
+	{
+		auto* bytes = reinterpret_cast<unsigned char*>(&out);
+		for (std::size_t i = 0; i < word_count; ++i) {
+			const word_type word = m_words[i].load(std::memory_order_relaxed);
+			std::memcpy(bytes + i * sizeof(word_type), &word, bytes_in(i));
+		}
+	}
+
+private:
+	using word_type = std::uint64_t;
+
+	static constexpr std::size_t word_count = (sizeof(value_type) + sizeof(word_type) - 1) / sizeof(word_type);
+
+	// Word by word, straight between the value and the atomics: staging
+	// through a local array makes wide loads wait on narrow stores.
+	static constexpr std::size_t bytes_in(std::size_t word)
+	{
+		return word + 1 < word_count ? sizeof(word_type) : sizeof(value_type) - word * sizeof(word_type);
+	}
+
+	std::atomic<word_type> m_words[word_count] = {};
+};
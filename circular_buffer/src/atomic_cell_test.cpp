@@ -0,0 +1,49 @@
+#include "catch.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+#include "atomic_cell.h"
+
+namespace {
+
+struct odd_sized {
+	char text[13];
+	std::uint16_t tag;
+};
+
+struct alignas(32) over_aligned {
+	double values[5];
+};
+
+} // namespace
+
+TEST_CASE("atomic_cell stores and loads values of any size", "[atomic_cell]")
+{
+	atomic_cell<char> c;
+	c.store('x');
+	char ch = 0;
+	c.load(ch);
+	CHECK(ch == 'x');
+
+	atomic_cell<odd_sized> odd;
+	const odd_sized in{ "twelve chars", 0xbeef };
+	odd.store(in);
+	odd_sized out{};
+	odd.load(out);
+	CHECK(std::memcmp(out.text, in.text, sizeof(in.text)) == 0);
+	CHECK(out.tag == 0xbeef);
+
+	atomic_cell<over_aligned> wide;
+	wide.store(over_aligned{ { 1.5, 2.5, 3.5, 4.5, 5.5 } });
+	over_aligned values{};
+	wide.load(values);
+	CHECK(values.values[0] == 1.5);
+	CHECK(values.values[4] == 5.5);
+
+	// A fresh cell holds zero bytes.
+	atomic_cell<std::uint64_t> fresh;
+	std::uint64_t zero = 1;
+	fresh.load(zero);
+	CHECK(zero == 0);
+}
@@ -0,0 +1,357 @@
+// broadcast_ring.h
+//
+// Single producer, many consumer broadcast ring in the style of the LMAX
+// disruptor: the producer writes each element once into a power-of-two slot
+// array, and every subscribed consumer reads every element through its own
+// sequence cursor, so fanning out to N readers costs no copies beyond the
+// reads themselves.
+//
+// In broadcast_mode::block the producer is gated on the slowest consumer and
+// never overwrites an element someone has yet to read. Consumers should
+// subscribe before publishing starts; one that subscribes later starts at the
+// current position. In broadcast_mode::overwrite the producer never waits and
+// a consumer that falls a full ring behind finds out it has been lapped when
+// it next pops, then resumes from the oldest element still intact. Elements
+// must be trivially copyable since in that mode a read can race with the
+// write that laps it (the copy is then detected and discarded). In that mode
+// the slots are atomic_cells, so the race is a torn copy rather than a data
+// race; a blocking ring never races and keeps plain slots, which copy faster.
+//
+// Wait is one of the strategies from wait_strategy.h. It decides how
+// consumers blocked in pop() wait for data and how a producer blocked in
+// publish() waits for the slowest consumer.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "atomic_cell.h"
+#include "power_of_two.h"
+#include "wait_strategy.h"
+
+enum class broadcast_mode { block, overwrite };
+
+enum class pop_result { ok, empty, lapped };
+
+template <typename T, typename Wait = spin_yield_wait>
+class broadcast_ring
+{
+	static_assert(std::is_trivially_copyable<T>::value, "broadcast_ring elements must be trivially copyable");
+
+public:
+	using value_type = T;
+	using size_type = std::size_t;
+	using sequence_type = std::uint64_t;
+
+	class consumer;
+
+	// capacity is rounded up to a power of two.
+	explicit broadcast_ring(std::size_t capacity, broadcast_mode mode = broadcast_mode::block, std::size_t max_consumers = 16)
+		: m_capacity{ power_of_two::round_up(capacity) },
+		m_mask{ m_capacity - 1 },
+		m_mode{ mode },
+		m_slots(mode == broadcast_mode::block ? new value_type[m_capacity] : nullptr),
+		m_cells(mode == broadcast_mode::overwrite ? new atomic_cell<value_type>[m_capacity] : nullptr),
+		m_cursors(max_consumers)
+	{
+		for (auto& c : m_cursors)
+			c.value.store(inactive, std::memory_order_relaxed);
+	}
+
+	broadcast_ring(const broadcast_ring&) = delete;
+	broadcast_ring& operator=(const broadcast_ring&) = delete;
+
+	size_type capacity() const { return m_capacity; }
+	broadcast_mode mode() const { return m_mode; }
+
+	// Number of elements published so far.
+	sequence_type published() const { return m_published.value.load(std::memory_order_acquire); }
+
+	// Registers a consumer that will see every element published from now on.
+	// Throws std::length_error when all consumer slots are taken.
+	consumer subscribe()
+	{
+		for (std::size_t i = 0; i < m_cursors.size(); ++i) {
+			sequence_type expected = inactive;
+			if (m_cursors[i].value.compare_exchange_strong(expected, published(), std::memory_order_acq_rel))
+				return consumer(this, i);
+		}
+		throw std::length_error("Too many consumers");
+	}
+
+	// Producer side. Returns false, without publishing, if a blocking ring is
+	// full from the point of view of its slowest consumer.
+	bool try_publish(const value_type& value)
+	{
+		const sequence_type seq = m_next;
+		if (m_mode == broadcast_mode::block && seq - m_gate >= m_capacity) {
+			m_gate = slowest(seq);
+			if (seq - m_gate >= m_capacity)
+				return false;
+		}
+		if (m_mode == broadcast_mode::overwrite) {
+			// Announce the slot before writing it so that readers can tell a
+			// copy was torn (see consumer::try_pop).
+			m_claimed.value.store(seq + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+		}
+		if (m_mode == broadcast_mode::block)
+			m_slots[seq & m_mask] = value;
+		else
+			m_cells[seq & m_mask].store(value);
+		m_next = seq + 1;
+		m_published.value.store(m_next, std::memory_order_release);
+		m_data_wait.notify();
+		return true;
+	}
+
+	// Publishes up to n elements from items with a single release store and
+	// returns how many were published: fewer than n if a blocking ring fills
+	// up, and at most capacity() in overwrite mode.
+	size_type try_publish_n(const value_type* items, size_type n)
+	{
+		const sequence_type seq = m_next;
+		if (n > m_capacity)
+			n = m_capacity;
+		if (m_mode == broadcast_mode::block) {
+			if (seq - m_gate + n > m_capacity)
+				m_gate = slowest(seq);
+			const size_type room = static_cast<size_type>(m_capacity - (seq - m_gate));
+			if (n > room)
+				n = room;
+			if (n == 0)
+				return 0;
+		}
+		else {
+			m_claimed.value.store(seq + n, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+		}
+		if (m_mode == broadcast_mode::block) {
+			for (size_type i = 0; i < n; ++i)
+				m_slots[(seq + i) & m_mask] = items[i];
+		}
+		else {
+			for (size_type i = 0; i < n; ++i)
+				m_cells[(seq + i) & m_mask].store(items[i]);
+		}
+		m_next = seq + n;
+		m_published.value.store(m_next, std::memory_order_release);
+		m_data_wait.notify();
+		return n;
+	}
+
+	// Publishes, waiting while a blocking ring is full.
+	void publish(const value_type& value)
+	{
+		if (!try_publish(value))
+			m_space_wait.wait_until([&] { return try_publish(value); });
+	}
+
+private:
+	static constexpr sequence_type inactive = std::numeric_limits<sequence_type>::max();
+
+	// Keeps each atomic on its own cache line so that the producer and the
+	// consumers do not false-share.
+	struct alignas(64) padded_sequence {
+		std::atomic<sequence_type> value{ 0 };
+	};
+
+	// The smallest active consumer cursor, or seq if there are no consumers.
+	sequence_type slowest(sequence_type seq) const
+	{
+		sequence_type lowest = seq;
+		for (const auto& c : m_cursors) {
+			const sequence_type s = c.value.load(std::memory_order_acquire);
+			if (s != inactive && s < lowest)
+				lowest = s;
+		}
+		return lowest;
+	}
+
+	const std::size_t m_capacity;
+	const std::size_t m_mask;
+	const broadcast_mode m_mode;
+	// Exactly one of these is allocated, according to m_mode.
+	std::unique_ptr<value_type[]> m_slots;
+	std::unique_ptr<atomic_cell<value_type>[]> m_cells;
+	std::vector<padded_sequence> m_cursors;
+
+	// Producer-only state: the next sequence to publish and the cached gate
+	// (a lower bound on every consumer cursor).
+	sequence_type m_next = 0;
+	sequence_type m_gate = 0;
+
+	padded_sequence m_published;
+	padded_sequence m_claimed;
+
+	// Consumers wait on m_data_wait for the producer; the producer waits on
+	// m_space_wait for consumers.
+	Wait m_data_wait;
+	Wait m_space_wait;
+};
+
+// A consumer reads from a single thread. It unsubscribes when destroyed.
+template <typename T, typename Wait>
+class broadcast_ring<T, Wait>::consumer
+{
+public:
+	consumer(consumer&& other) noexcept
+		: m_ring{ other.m_ring }, m_index{ other.m_index }, m_next{ other.m_next }, m_lost{ other.m_lost }
+	{
+		other.m_ring = nullptr;
+	}
+
+	consumer& operator=(consumer&&) = delete;
+	consumer(const consumer&) = delete;
+	consumer& operator=(const consumer&) = delete;
+
+	~consumer()
+	{
+		if (m_ring) {
+			cursor().store(inactive, std::memory_order_release);
+			// The producer may be waiting on this consumer.
+			m_ring->m_space_wait.notify();
+		}
+	}
+
+	// Copies the next element into out. Returns lapped (and skips ahead to the
+	// oldest intact element) if an overwriting producer has overtaken this
+	// consumer; lost() counts the elements skipped that way.
+	pop_result try_pop(value_type& out)
+	{
+		const sequence_type available = m_ring->m_published.value.load(std::memory_order_acquire);
+		if (m_next == available)
+			return pop_result::empty;
+
+		if (m_ring->m_mode == broadcast_mode::overwrite) {
+			if (available - m_next > m_ring->m_capacity)
+				return skip_to(available);
+			m_ring->m_cells[m_next & m_ring->m_mask].load(out);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			const sequence_type claimed = m_ring->m_claimed.value.load(std::memory_order_relaxed);
+			if (claimed - m_next > m_ring->m_capacity)
+				return skip_to(claimed);
+		}
+		else {
+			out = m_ring->m_slots[m_next & m_ring->m_mask];
+		}
+
+		++m_next;
+		cursor().store(m_next, std::memory_order_release);
+		if (m_ring->m_mode == broadcast_mode::block)
+			m_ring->m_space_wait.notify();
+		return pop_result::ok;
+	}
+
+	// Copies up to n of the next elements into out and returns how many, with
+	// a single cursor store for the batch. If an overwriting producer lapped
+	// part of the batch, only the intact tail of it is returned and the rest
+	// is counted in lost().
+	size_type try_pop_n(value_type* out, size_type n)
+	{
+		sequence_type skipped;
+		return try_pop_n(out, n, skipped);
+	}
+
+	// As above, and sets skipped to the number of elements lost to a lap
+	// during this call. A lap can take the whole batch, so 0 is returned with
+	// skipped > 0 when the ring was not empty; call again to read on from the
+	// oldest intact element.
+	size_type try_pop_n(value_type* out, size_type n, sequence_type& skipped)
+	{
+		const sequence_type lost_before = m_lost;
+		skipped = 0;
+		const sequence_type available = m_ring->m_published.value.load(std::memory_order_acquire);
+		if (m_ring->m_mode == broadcast_mode::overwrite && available - m_next > m_ring->m_capacity)
+			skip_to(available);
+		const sequence_type ready = available - m_next;
+		if (n > ready)
+			n = static_cast<size_type>(ready);
+		if (n == 0) {
+			skipped = m_lost - lost_before;
+			return 0;
+		}
+
+		if (m_ring->m_mode == broadcast_mode::block) {
+			for (size_type i = 0; i < n; ++i)
+				out[i] = m_ring->m_slots[(m_next + i) & m_ring->m_mask];
+		}
+		else {
+			for (size_type i = 0; i < n; ++i)
+				m_ring->m_cells[(m_next + i) & m_ring->m_mask].load(out[i]);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			const sequence_type claimed = m_ring->m_claimed.value.load(std::memory_order_relaxed);
+			if (claimed - m_next > m_ring->m_capacity) {
+				// Elements before claimed - capacity + 1 may be torn.
+				const sequence_type intact = claimed - m_ring->m_capacity + 1;
+				const sequence_type end = m_next + n;
+				const size_type keep = intact < end ? static_cast<size_type>(end - intact) : 0;
+				for (size_type i = 0; i < keep; ++i)
+					out[i] = out[n - keep + i];
+				m_lost += n - keep;
+				n = keep;
+				m_next = end - keep;
+			}
+			skipped = m_lost - lost_before;
+		}
+
+		m_next += n;
+		cursor().store(m_next, std::memory_order_release);
+		if (m_ring->m_mode == broadcast_mode::block)
+			m_ring->m_space_wait.notify();
+		return n;
+	}
+
+	// Like try_pop, but waits (according to the ring's Wait strategy) instead
+	// of returning empty.
+	pop_result pop(value_type& out)
+	{
+		m_ring->m_data_wait.wait_until([this] {
+			return m_ring->m_published.value.load(std::memory_order_acquire) != m_next;
+		});
+		return try_pop(out);
+	}
+
+	// Sequence number of the next element this consumer will read.
+	sequence_type position() const { return m_next; }
+
+	// Number of published elements not yet read.
+	sequence_type backlog() const { return m_ring->published() - m_next; }
+
+	sequence_type lost() const { return m_lost; }
+
+private:
+	friend class broadcast_ring<T, Wait>;
+
+	consumer(broadcast_ring* ring, std::size_t index)
+		: m_ring{ ring }, m_index{ index },
+		m_next{ ring->m_cursors[index].value.load(std::memory_order_relaxed) }
+	{}
+
+	std::atomic<sequence_type>& cursor() { return m_ring->m_cursors[m_index].value; }
+
+	// The producer has written up to (but excluding) head, so everything
+	// before head - capacity is gone; the slot at head - capacity may be
+	// mid-write, so resume one past it.
+	pop_result skip_to(sequence_type head)
+	{
+		const sequence_type resume = head - m_ring->m_capacity + 1;
+		m_lost += resume - m_next;
+		m_next = resume;
+		cursor().store(m_next, std::memory_order_release);
+		return pop_result::lapped;
+	}
+
+	broadcast_ring* m_ring;
+	std::size_t m_index;
+	sequence_type m_next;
+	sequence_type m_lost = 0;
+};
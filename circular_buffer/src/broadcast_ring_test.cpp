@@ -0,0 +1,244 @@
+#include "catch.hpp"
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "broadcast_ring.h"
+
+TEST_CASE("Every consumer sees every element", "[broadcast_ring]")
+{
+	broadcast_ring<int> ring(3);
+	REQUIRE(ring.capacity() == 4);
+
+	auto a = ring.subscribe();
+	auto b = ring.subscribe();
+	int value = 0;
+	REQUIRE(a.try_pop(value) == pop_result::empty);
+
+	REQUIRE(ring.try_publish(1));
+	REQUIRE(ring.try_publish(2));
+	REQUIRE(a.try_pop(value) == pop_result::ok);
+	REQUIRE(value == 1);
+	REQUIRE(a.try_pop(value) == pop_result::ok);
+	REQUIRE(value == 2);
+	REQUIRE(a.try_pop(value) == pop_result::empty);
+	REQUIRE(b.backlog() == 2);
+
+	// b has not read anything, so the ring is gated on it.
+	REQUIRE(ring.try_publish(3));
+	REQUIRE(ring.try_publish(4));
+	REQUIRE(!ring.try_publish(5));
+	REQUIRE(b.try_pop(value) == pop_result::ok);
+	REQUIRE(value == 1);
+	REQUIRE(ring.try_publish(5));
+	REQUIRE(!ring.try_publish(6));
+
+	for (int expected = 2; expected <= 5; ++expected) {
+		REQUIRE(b.try_pop(value) == pop_result::ok);
+		REQUIRE(value == expected);
+	}
+	REQUIRE(b.lost() == 0);
+}
+
+TEST_CASE("Consumers come and go", "[broadcast_ring]")
+{
+	broadcast_ring<int> ring(2, broadcast_mode::block, 2);
+	{
+		auto a = ring.subscribe();
+		auto b = ring.subscribe();
+		REQUIRE_THROWS_AS(ring.subscribe(), std::length_error);
+		ring.publish(1);
+		ring.publish(2);
+		REQUIRE(!ring.try_publish(3));
+	}
+	// With nobody subscribed the producer is not gated.
+	REQUIRE(ring.try_publish(3));
+	REQUIRE(ring.try_publish(4));
+	REQUIRE(ring.try_publish(5));
+
+	auto late = ring.subscribe();
+	REQUIRE(late.position() == 5);
+	int value = 0;
+	REQUIRE(late.try_pop(value) == pop_result::empty);
+	ring.publish(6);
+	REQUIRE(late.try_pop(value) == pop_result::ok);
+	REQUIRE(value == 6);
+}
+
+TEST_CASE("Overwrite mode reports lapped consumers", "[broadcast_ring]")
+{
+	broadcast_ring<int> ring(4, broadcast_mode::overwrite);
+	auto c = ring.subscribe();
+	for (int i = 0; i < 10; ++i)
+		REQUIRE(ring.try_publish(i));
+
+	int value = -1;
+	REQUIRE(c.try_pop(value) == pop_result::lapped);
+	REQUIRE(c.lost() == 7);
+	REQUIRE(c.try_pop(value) == pop_result::ok);
+	REQUIRE(value == 7);
+	REQUIRE(c.try_pop(value) == pop_result::ok);
+	REQUIRE(c.try_pop(value) == pop_result::ok);
+	REQUIRE(value == 9);
+	REQUIRE(c.try_pop(value) == pop_result::empty);
+}
+
+TEST_CASE("Batched publish and pop", "[broadcast_ring]")
+{
+	broadcast_ring<int> ring(8);
+	auto c = ring.subscribe();
+	const int in[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+	int out[10] = {};
+
+	REQUIRE(ring.try_publish_n(in, 6) == 6);
+	REQUIRE(c.try_pop_n(out, 4) == 4);
+	REQUIRE(out[3] == 3);
+	// Two unread, so six fit, straddling the end of the slots.
+	REQUIRE(ring.try_publish_n(in, 10) == 6);
+	REQUIRE(ring.try_publish_n(in, 1) == 0);
+	REQUIRE(c.try_pop_n(out, 10) == 8);
+	REQUIRE(out[0] == 4);
+	REQUIRE(out[1] == 5);
+	REQUIRE(out[2] == 0);
+	REQUIRE(out[7] == 5);
+	REQUIRE(c.try_pop_n(out, 10) == 0);
+}
+
+TEST_CASE("Batched pop in overwrite mode skips lost elements", "[broadcast_ring]")
+{
+	broadcast_ring<int> ring(4, broadcast_mode::overwrite);
+	auto c = ring.subscribe();
+	const int in[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+	REQUIRE(ring.try_publish_n(in, 10) == 4);
+	REQUIRE(ring.try_publish_n(in + 4, 6) == 4);
+	REQUIRE(ring.try_publish_n(in + 8, 2) == 2);
+
+	int out[10] = {};
+	broadcast_ring<int>::sequence_type skipped = 0;
+	REQUIRE(c.try_pop_n(out, 10, skipped) == 3);
+	REQUIRE(skipped == 7);
+	REQUIRE(c.lost() == 7);
+	REQUIRE(out[0] == 7);
+	REQUIRE(out[2] == 9);
+	REQUIRE(c.try_pop_n(out, 10, skipped) == 0);
+	REQUIRE(skipped == 0);
+
+	// Lapped again with no room asked for: 0 elements, but not empty.
+	REQUIRE(ring.try_publish_n(in, 4) == 4);
+	REQUIRE(ring.try_publish_n(in + 4, 2) == 2);
+	REQUIRE(c.try_pop_n(out, 0, skipped) == 0);
+	REQUIRE(skipped == 3);
+	REQUIRE(c.lost() == 10);
+	REQUIRE(c.try_pop_n(out, 10, skipped) == 3);
+	REQUIRE(skipped == 0);
+	REQUIRE(out[0] == 3);
+	REQUIRE(out[2] == 5);
+}
+
+TEST_CASE("Concurrent fan-out in blocking mode", "[broadcast_ring]")
+{
+	constexpr std::uint64_t count = 200000;
+	broadcast_ring<std::uint64_t> ring(64);
+	std::vector<broadcast_ring<std::uint64_t>::consumer> consumers;
+	for (int i = 0; i < 3; ++i)
+		consumers.push_back(ring.subscribe());
+
+	std::vector<std::uint64_t> sums(consumers.size());
+	std::vector<char> ordered(consumers.size(), 1);
+	std::vector<std::thread> threads;
+	for (std::size_t i = 0; i < consumers.size(); ++i) {
+		threads.emplace_back([&, i] {
+			std::uint64_t expected = 0, value = 0;
+			while (expected < count) {
+				if (consumers[i].try_pop(value) != pop_result::ok) {
+					std::this_thread::yield();
+					continue;
+				}
+				ordered[i] = ordered[i] && value == expected;
+				sums[i] += value;
+				++expected;
+			}
+		});
+	}
+	for (std::uint64_t i = 0; i < count; ++i)
+		ring.publish(i);
+	for (auto& t : threads)
+		t.join();
+
+	for (std::size_t i = 0; i < consumers.size(); ++i) {
+		REQUIRE(ordered[i]);
+		REQUIRE(sums[i] == count * (count - 1) / 2);
+	}
+}
+
+TEST_CASE("Concurrent overwrite mode never yields torn or reordered data", "[broadcast_ring]")
+{
+	struct record {
+		std::uint64_t seq;
+		std::uint64_t check;
+	};
+	constexpr std::uint64_t count = 200000;
+	broadcast_ring<record> ring(16, broadcast_mode::overwrite);
+	auto c = ring.subscribe();
+
+	bool consistent = true;
+	std::uint64_t received = 0;
+	std::thread reader([&] {
+		std::uint64_t last = 0;
+		bool first = true;
+		record r{};
+		while (first || last + 1 < count) {
+			const auto result = c.try_pop(r);
+			if (result != pop_result::ok)
+				continue;
+			consistent = consistent && r.check == ~r.seq && (first || r.seq > last);
+			last = r.seq;
+			first = false;
+			++received;
+		}
+	});
+	for (std::uint64_t i = 0; i < count; ++i)
+		ring.publish(record{ i, ~i });
+	reader.join();
+
+	REQUIRE(consistent);
+	REQUIRE(received + c.lost() == count);
+}
+
+TEST_CASE("Concurrent batched overwrite never yields torn or reordered data", "[broadcast_ring]")
+{
+	struct record {
+		std::uint64_t seq;
+		std::uint64_t check;
+	};
+	constexpr std::uint64_t count = 200000;
+	broadcast_ring<record> ring(16, broadcast_mode::overwrite);
+	auto c = ring.subscribe();
+
+	bool consistent = true;
+	std::uint64_t received = 0;
+	std::uint64_t skipped = 0;
+	std::thread reader([&] {
+		record batch[8];
+		while (c.position() < count) {
+			broadcast_ring<record>::sequence_type lapped;
+			const std::size_t n = c.try_pop_n(batch, 8, lapped);
+			for (std::size_t i = 0; i < n; ++i)
+				consistent = consistent && batch[i].check == ~batch[i].seq && batch[i].seq == c.position() - n + i;
+			received += n;
+			skipped += lapped;
+		}
+	});
+	record batch[5];
+	for (std::uint64_t i = 0; i < count; i += 5) {
+		for (std::uint64_t j = 0; j < 5; ++j)
+			batch[j] = record{ i + j, ~(i + j) };
+		REQUIRE(ring.try_publish_n(batch, 5) == 5);
+	}
+	reader.join();
+
+	REQUIRE(consistent);
+	REQUIRE(received + c.lost() == count);
+	REQUIRE(skipped == c.lost());
+}
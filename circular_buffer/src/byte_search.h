@@ -0,0 +1,211 @@
+// byte_search.h
+//
+// Searching circular_buffers of bytes (char, signed char, unsigned char or
+// std::byte) in place, without copying the contents out to make them
+// contiguous first. The functions live in namespace byte_search, so that
+// search() cannot be confused with std::search. find_byte() runs memchr over
+// the two segments from array_one()/array_two(). search() looks for a
+// pattern with memchr on its first byte and memcmp to confirm, inside each
+// segment. Matches that straddle the wrap point are checked separately, by
+// comparing the pattern in two pieces.
+//
+// rolling_hash_window is a Rabin-Karp adaptor: a circular_buffer window of
+// the last N bytes pushed, and a polynomial hash of exactly those bytes. The
+// hash is updated in O(1) as each byte comes in and the oldest drops out. It
+// suits streaming signature matches (compare hash() with hash_of(pattern),
+// then confirm with byte_search::search()) and content-defined chunking (cut
+// wherever the low bits of hash() are zero, so cut points move with the
+// content rather than with byte offsets).
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+#include "circular_buffer.h"
+
+namespace byte_search {
+
+namespace detail {
+
+template <typename T>
+struct is_byte : std::integral_constant<bool, sizeof(T) == 1 && std::is_trivially_copyable<T>::value> {};
+
+// First i < starts such that the m bytes at p + i equal pattern, or starts.
+// p must hold starts + m - 1 bytes.
+inline std::size_t search_run(const unsigned char* p, std::size_t starts, const unsigned char* pattern, std::size_t m)
+{
+	std::size_t i = 0;
+	while (i < starts) {
+		const void* hit = std::memchr(p + i, pattern[0], starts - i);
+		if (!hit)
+			return starts;
+		i = static_cast<std::size_t>(static_cast<const unsigned char*>(hit) - p);
+		if (std::memcmp(p + i + 1, pattern + 1, m - 1) == 0)
+			return i;
+		++i;
+	}
+	return starts;
+}
+
+} // namespace detail
+
+// Index, counted from front(), of the first element equal to value at or
+// after from, or size() if there is none.
+template <typename T, typename A>
+typename circular_buffer<T, A>::size_type find_byte(const circular_buffer<T, A>& cb, T value, std::size_t from = 0)
+{
+	static_assert(detail::is_byte<T>::value, "find_byte() searches rings of bytes");
+	const unsigned char byte = static_cast<unsigned char>(value);
+	const auto one = cb.array_one();
+	const auto two = cb.array_two();
+	if (from < one.second) {
+		const auto* p = reinterpret_cast<const unsigned char*>(one.first);
+		if (const void* hit = std::memchr(p + from, byte, one.second - from))
+			return static_cast<std::size_t>(static_cast<const unsigned char*>(hit) - p);
+		from = one.second;
+	}
+	if (from - one.second < two.second) {
+		const auto* p = reinterpret_cast<const unsigned char*>(two.first);
+		const std::size_t skip = from - one.second;
+		if (const void* hit = std::memchr(p + skip, byte, two.second - skip))
+			return one.second + static_cast<std::size_t>(static_cast<const unsigned char*>(hit) - p);
+	}
+	return cb.size();
+}
+
+// Index, counted from front(), of the first occurrence of the m-byte
+// pattern starting at or after from, or size() if there is none. An empty
+// pattern matches at from. from has no default so that search(cb, "GET", 2)
+// means the string_view overload below, not a two-byte pattern.
+template <typename T, typename A>
+typename circular_buffer<T, A>::size_type search(const circular_buffer<T, A>& cb, const T* pattern, std::size_t m,
+	std::size_t from)
+{
+	static_assert(detail::is_byte<T>::value, "search() searches rings of bytes");
+	const std::size_t n = cb.size();
+	if (m == 0)
+		return from < n ? from : n;
+	if (m > n || from > n - m)
+		return n;
+	const std::size_t last = n - m;
+	const auto* pat = reinterpret_cast<const unsigned char*>(pattern);
+	const auto one = cb.array_one();
+	const auto two = cb.array_two();
+	const auto* p1 = reinterpret_cast<const unsigned char*>(one.first);
+	const auto* p2 = reinterpret_cast<const unsigned char*>(two.first);
+	const std::size_t len1 = one.second;
+
+	// Starts whose match lies wholly inside array_one().
+	if (len1 >= m && from <= len1 - m) {
+		const std::size_t starts = len1 - m + 1 - from;
+		const std::size_t i = detail::search_run(p1 + from, starts, pat, m);
+		if (i < starts)
+			return from + i;
+		from = len1 - m + 1;
+	}
+	// Starts in array_one() whose match runs on into array_two().
+	for (; from < len1 && from <= last; ++from) {
+		const std::size_t head = len1 - from;
+		if (std::memcmp(p1 + from, pat, head) == 0 && std::memcmp(p2, pat + head, m - head) == 0)
+			return from;
+	}
+	// Starts inside array_two(), which is the end of the contents.
+	if (from <= last) {
+		const std::size_t starts = last - from + 1;
+		const std::size_t i = detail::search_run(p2 + (from - len1), starts, pat, m);
+		if (i < starts)
+			return from + i;
+	}
+	return n;
+}
+
+// For char rings.
+template <typename A>
+typename circular_buffer<char, A>::size_type search(const circular_buffer<char, A>& cb, std::string_view pattern,
+	std::size_t from = 0)
+{
+	return search(cb, pattern.data(), pattern.size(), from);
+}
+
+} // namespace byte_search
+
+// A window over the last window() bytes pushed, with a rolling polynomial
+// hash of them: for bytes b[0] (oldest) to b[k - 1],
+// hash() == b[0] * base^(k-1) + ... + b[k - 1], modulo 2^64. Collisions are
+// possible, so confirm a hash match against the bytes.
+template <typename T = char, typename A = std::allocator<T>>
+class rolling_hash_window
+{
+	static_assert(byte_search::detail::is_byte<T>::value, "rolling_hash_window hashes bytes");
+
+public:
+	using buffer_type = circular_buffer<T, A>;
+	using size_type = std::size_t;
+
+	static constexpr std::uint64_t default_base = 0x100000001b3ull;
+
+	explicit rolling_hash_window(std::size_t window, std::uint64_t base = default_base)
+		: m_bytes(window),
+		m_base{ base },
+		m_outgoing{ power(base, window ? window - 1 : 0) }
+	{
+		if (window == 0)
+			throw std::invalid_argument("Window must not be empty");
+	}
+
+	// Hash of the m bytes at p, as hash() would be with them in the window.
+	static std::uint64_t hash_of(const T* p, std::size_t m, std::uint64_t base = default_base)
+	{
+		std::uint64_t h = 0;
+		for (std::size_t i = 0; i < m; ++i)
+			h = h * base + static_cast<unsigned char>(p[i]);
+		return h;
+	}
+
+	// Returns false when the oldest byte was evicted to make room, as
+	// circular_buffer::push_back does.
+	bool push_back(T value)
+	{
+		if (m_bytes.size() == m_bytes.capacity())
+			m_hash -= static_cast<unsigned char>(m_bytes.front()) * m_outgoing;
+		m_hash = m_hash * m_base + static_cast<unsigned char>(value);
+		return m_bytes.push_back(value);
+	}
+
+	void clear()
+	{
+		m_bytes.clear();
+		m_hash = 0;
+	}
+
+	std::uint64_t hash() const { return m_hash; }
+	bool full() const { return m_bytes.size() == m_bytes.capacity(); }
+	size_type window() const { return m_bytes.capacity(); }
+
+	// The bytes hashed, oldest first, for byte_search::search() and friends.
+	const buffer_type& bytes() const { return m_bytes; }
+
+private:
+	static std::uint64_t power(std::uint64_t base, std::size_t exponent)
+	{
+		std::uint64_t result = 1;
+		for (; exponent; exponent >>= 1, base *= base) {
+			if (exponent & 1)
+				result *= base;
+		}
+		return result;
+	}
+
+	buffer_type m_bytes;
+	std::uint64_t m_base;
+	// base^(window - 1): the weight of the oldest byte in a full window.
+	std::uint64_t m_outgoing;
+	std::uint64_t m_hash = 0;
+};
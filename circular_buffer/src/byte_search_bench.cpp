@@ -0,0 +1,54 @@
+#include "catch.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+
+#include "byte_search.h"
+
+TEST_CASE("Scanning a wrapped 4 MiB byte ring", "[.][benchmark][byte_search]")
+{
+	const std::size_t n = 4 << 20;
+	circular_buffer<char> cb(n);
+	std::mt19937 rng(1);
+	// Printable noise with no '\0' in it, wrapped half way round, and a
+	// signature that straddles the wrap point at the very end.
+	for (std::size_t i = 0; i < n + n / 2 - 8; ++i)
+		cb.push_back(static_cast<char>('!' + rng() % 90));
+	for (char c : std::string("SIG\x01\x02\x03!!"))
+		cb.push_back(c);
+	const std::string signature = "\x01\x02\x03";
+	std::size_t sink = 0;
+
+	BENCHMARK("Copy to a std::string, then find the signature") {
+		std::string copy;
+		copy.reserve(cb.size());
+		for (auto range : { cb.array_one(), cb.array_two() })
+			copy.append(range.first, range.second);
+		sink += copy.find(signature);
+	}
+	BENCHMARK("Iterator walk with std::search") {
+		sink += std::search(cb.begin(), cb.end(), signature.begin(), signature.end()) - cb.begin();
+	}
+	BENCHMARK("search() in place") {
+		sink += byte_search::search(cb, signature);
+	}
+	BENCHMARK("byte_search::find_byte() for an absent delimiter") {
+		sink += byte_search::find_byte(cb, '\0');
+	}
+	BENCHMARK("rolling_hash_window(48) chunking") {
+		rolling_hash_window<> window(48);
+		std::size_t cuts = 0;
+		for (auto range : { cb.array_one(), cb.array_two() }) {
+			for (std::size_t i = 0; i < range.second; ++i) {
+				window.push_back(range.first[i]);
+				cuts += (window.hash() & 0x1fff) == 0;
+			}
+		}
+		sink += cuts;
+	}
+	CHECK(byte_search::search(cb, signature) == n - 5);
+	CHECK(sink != 0);
+}
@@ -0,0 +1,167 @@
+#include "catch.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "byte_search.h"
+
+namespace {
+
+// A ring of the given contents whose front() sits at slot offset.
+circular_buffer<char>* make_ring(std::size_t capacity, std::size_t offset, const std::string& contents)
+{
+	auto* cb = new circular_buffer<char>(capacity);
+	for (std::size_t i = 0; i < offset; ++i)
+		cb->push_back('#');
+	for (std::size_t i = 0; i < offset; ++i)
+		cb->pop_front();
+	for (char c : contents)
+		cb->push_back(c);
+	return cb;
+}
+
+std::string contents(const circular_buffer<char>& cb)
+{
+	std::string s;
+	for (auto range : { cb.array_one(), cb.array_two() })
+		s.append(range.first, range.second);
+	return s;
+}
+
+} // namespace
+
+TEST_CASE("find_byte and search across the wrap point", "[byte_search]")
+{
+	// Capacity 10, front at slot 7: "GET /\r\n" wraps after "GET".
+	std::unique_ptr<circular_buffer<char>> cb(make_ring(10, 7, "GET /\r\nHo:"));
+	REQUIRE(cb->array_two().second == 7);
+
+	CHECK(byte_search::find_byte(*cb, 'G') == 0);
+	CHECK(byte_search::find_byte(*cb, '/') == 4);
+	CHECK(byte_search::find_byte(*cb, '\n') == 6);
+	CHECK(byte_search::find_byte(*cb, ':', 8) == 9);
+	CHECK(byte_search::find_byte(*cb, 'x') == 10);
+	CHECK(byte_search::find_byte(*cb, 'G', 1) == 10);
+
+	CHECK(byte_search::search(*cb, "GET") == 0);
+	CHECK(byte_search::search(*cb, "ET /") == 1);
+	CHECK(byte_search::search(*cb, "T /\r") == 2);
+	CHECK(byte_search::search(*cb, "\r\n") == 5);
+	CHECK(byte_search::search(*cb, "Ho") == 7);
+	CHECK(byte_search::search(*cb, "GET /\r\nHo:") == 0);
+	CHECK(byte_search::search(*cb, "GET /\r\nHo:!") == 10);
+	CHECK(byte_search::search(*cb, "ET", 2) == 10);
+	CHECK(byte_search::search(*cb, "") == 0);
+	CHECK(byte_search::search(*cb, "", 10) == 10);
+
+	const unsigned char bytes[] = { 0x00, 0xff, 0x80 };
+	circular_buffer<unsigned char> raw(4);
+	for (unsigned char b : { 0x01, 0x00, 0xff, 0x80, 0x00 })
+		raw.push_back(b);
+	CHECK(byte_search::search(raw, bytes, 3, 0) == 0);
+	CHECK(byte_search::search(raw, bytes, 3, 1) == 4);
+	CHECK(byte_search::find_byte(raw, static_cast<unsigned char>(0x80)) == 2);
+}
+
+TEST_CASE("search agrees with std::string::find", "[byte_search]")
+{
+	std::mt19937 rng(11);
+	for (int round = 0; round < 3000; ++round) {
+		const std::size_t capacity = 1 + rng() % 24;
+		const std::size_t offset = rng() % capacity;
+		std::string text;
+		const std::size_t size = rng() % (capacity + 1);
+		for (std::size_t i = 0; i < size; ++i)
+			text += static_cast<char>('a' + rng() % 3);
+		std::unique_ptr<circular_buffer<char>> cb(make_ring(capacity, offset, text));
+		REQUIRE(contents(*cb) == text);
+
+		std::string pattern;
+		const std::size_t m = rng() % 5;
+		for (std::size_t i = 0; i < m; ++i)
+			pattern += static_cast<char>('a' + rng() % 3);
+		const std::size_t from = rng() % (size + 2);
+		const std::size_t expected = from <= size ? text.find(pattern, from) : std::string::npos;
+		REQUIRE(byte_search::search(*cb, pattern, from) == (expected == std::string::npos ? size : expected));
+
+		const char byte = static_cast<char>('a' + rng() % 3);
+		const std::size_t expected_byte = from <= size ? text.find(byte, from) : std::string::npos;
+		REQUIRE(byte_search::find_byte(*cb, byte, from) == (expected_byte == std::string::npos ? size : expected_byte));
+	}
+}
+
+TEST_CASE("rolling_hash_window hashes exactly the bytes in the window", "[byte_search]")
+{
+	rolling_hash_window<> window(8);
+	CHECK(window.window() == 8);
+	CHECK(window.hash() == 0);
+	CHECK_THROWS_AS(rolling_hash_window<>(0), std::invalid_argument);
+
+	std::mt19937 rng(5);
+	for (int i = 0; i < 1000; ++i) {
+		window.push_back(static_cast<char>(rng()));
+		const std::string bytes = contents(window.bytes());
+		REQUIRE(window.hash() == rolling_hash_window<>::hash_of(bytes.data(), bytes.size()));
+	}
+	CHECK(window.full());
+	window.clear();
+	CHECK(window.hash() == 0);
+}
+
+TEST_CASE("rolling_hash_window finds a signature in a stream", "[byte_search]")
+{
+	const std::string signature = "\x7f" "ELF\x02\x01";
+	const std::uint64_t wanted = rolling_hash_window<>::hash_of(signature.data(), signature.size());
+	rolling_hash_window<> window(signature.size());
+
+	std::string stream(5000, 'x');
+	stream.replace(1234, signature.size(), signature);
+	stream.replace(4321, signature.size(), signature);
+	std::vector<std::size_t> found;
+	for (std::size_t i = 0; i < stream.size(); ++i) {
+		window.push_back(stream[i]);
+		if (window.full() && window.hash() == wanted && byte_search::search(window.bytes(), signature) == 0)
+			found.push_back(i + 1 - signature.size());
+	}
+	CHECK(found == std::vector<std::size_t>{ 1234, 4321 });
+}
+
+TEST_CASE("Content-defined chunk boundaries survive an insertion", "[byte_search]")
+{
+	std::mt19937 rng(9);
+	std::string data(1 << 16, '\0');
+	for (char& c : data)
+		c = static_cast<char>(rng());
+	std::string edited = data;
+	edited.insert(100, "an insertion near the start");
+
+	// Cut after any byte where the low 8 bits of a 32-byte window's hash are
+	// zero; report cut points counted from the end of the data.
+	const auto cuts_from_end = [](const std::string& s) {
+		rolling_hash_window<> window(32);
+		std::vector<std::size_t> cuts;
+		for (std::size_t i = 0; i < s.size(); ++i) {
+			window.push_back(s[i]);
+			if (window.full() && (window.hash() & 0xff) == 0)
+				cuts.push_back(s.size() - i);
+		}
+		return cuts;
+	};
+	const std::vector<std::size_t> before = cuts_from_end(data);
+	const std::vector<std::size_t> after = cuts_from_end(edited);
+	REQUIRE(before.size() > 100);
+	// Every cut more than a window past the insertion is unchanged.
+	std::size_t shared = 0;
+	for (std::size_t cut : before)
+		shared += cut < data.size() - 200 && std::find(after.begin(), after.end(), cut) != after.end();
+	std::size_t eligible = 0;
+	for (std::size_t cut : before)
+		eligible += cut < data.size() - 200;
+	CHECK(shared == eligible);
+}
@@ -0,0 +1,4 @@
+#define CATCH_CONFIG_MAIN
+// See cb_test.cpp.
+#define CATCH_CONFIG_NO_POSIX_SIGNALS
+#include "catch.hpp"
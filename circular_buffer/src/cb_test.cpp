@@ -1,7 +1,13 @@
 #define CATCH_CONFIG_MAIN
+// Catch 2.0.1 sizes its alternate signal stack with SIGSTKSZ, which is no
+// longer a constant expression on newer glibc.
+#define CATCH_CONFIG_NO_POSIX_SIGNALS
 #include "catch.hpp"
 
 #include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
 
 #include "circular_buffer.h"
 
@@ -17,7 +23,10 @@ struct leak_checker {
 	{
 		++count;
 	}
-	leak_checker(leak_checker&& lc) = default;
+	leak_checker(leak_checker&& lc) : m_value{ lc.m_value }
+	{
+		++count;
+	}
 	leak_checker& operator=(const leak_checker&) = default;
 	leak_checker& operator=(leak_checker&&) = default;
 
@@ -298,4 +307,194 @@ TEST_CASE("Using Iterators", "[circular_buffer]") {
 		REQUIRE(dest[1] == 1);
 		REQUIRE(dest[2] == 0);
 	}
-}
\ No newline at end of file
+}
+
+TEST_CASE("Popping from the back", "[circular_buffer]") {
+	leak_checker::count = 0;
+	auto cb = circular_buffer<leak_checker>(3);
+
+	cb.push_back(1);
+	cb.push_back(2);
+	cb.pop_back();
+	REQUIRE(cb.size() == 1);
+	REQUIRE(cb.back().value() == 1);
+	REQUIRE(leak_checker::count == 1);
+
+	cb.pop_back();
+	REQUIRE(cb.empty());
+	REQUIRE(leak_checker::count == 0);
+
+	// Wrap round the end of the storage, then pop back across the seam.
+	for (int i = 1; i <= 5; ++i)
+		cb.push_back(i);
+	REQUIRE(cb.front().value() == 3);
+	REQUIRE(cb.back().value() == 5);
+	cb.pop_back();
+	REQUIRE(cb.size() == 2);
+	REQUIRE(cb.back().value() == 4);
+	cb.pop_back();
+	REQUIRE(cb.back().value() == 3);
+	cb.push_back(6);
+	cb.push_back(7);
+	REQUIRE(cb.size() == 3);
+	REQUIRE(cb[0].value() == 3);
+	REQUIRE(cb[1].value() == 6);
+	REQUIRE(cb[2].value() == 7);
+	REQUIRE(leak_checker::count == 3);
+
+	cb.clear();
+	REQUIRE(leak_checker::count == 0);
+}
+
+TEST_CASE("Saving and loading snapshots", "[circular_buffer]") {
+	circular_buffer<int> cb(5);
+	std::stringstream empty;
+	cb.save(empty);
+	CHECK(empty.str().size() == 16);
+
+	// Wrapped: storage holds 5 6 2 3 4, front() is 2.
+	for (int i = 0; i < 7; ++i)
+		cb.push_back(i);
+	REQUIRE(cb.array_two().second == 2);
+	std::stringstream snapshot;
+	cb.save(snapshot);
+	CHECK(snapshot.str().size() == 16 + 5 * sizeof(int));
+
+	circular_buffer<int> restored(5);
+	restored.push_back(42);
+	restored.load(snapshot);
+	REQUIRE(restored.size() == 5);
+	CHECK(restored.array_two().second == 0);
+	for (int i = 0; i < 5; ++i)
+		CHECK(restored[i] == i + 2);
+	// Loaded contents wrap and overwrite as usual.
+	CHECK_FALSE(restored.push_back(7));
+	CHECK(restored.front() == 3);
+	CHECK(restored.back() == 7);
+
+	// Into a smaller buffer, keeping the newest elements.
+	snapshot.clear();
+	snapshot.seekg(0);
+	circular_buffer<int> small(3);
+	small.load(snapshot);
+	REQUIRE(small.size() == 3);
+	CHECK(small[0] == 4);
+	CHECK(small[2] == 6);
+	CHECK(small.push_back(8) == false);
+
+	// Into a larger one, which is left with room to spare.
+	snapshot.clear();
+	snapshot.seekg(0);
+	circular_buffer<int> large(8);
+	large.load(snapshot);
+	REQUIRE(large.size() == 5);
+	CHECK(large.push_back(7));
+	CHECK(large.back() == 7);
+
+	empty.seekg(0);
+	large.load(empty);
+	CHECK(large.empty());
+	CHECK(large.push_back(1));
+	CHECK(large.size() == 1);
+
+	// Malformed or truncated input leaves the buffer empty.
+	std::stringstream wrong_type;
+	circular_buffer<double> doubles(2);
+	doubles.push_back(1.0);
+	doubles.save(wrong_type);
+	CHECK_THROWS_AS(large.load(wrong_type), std::runtime_error);
+	CHECK(large.empty());
+
+	std::stringstream truncated(snapshot.str().substr(0, 20));
+	CHECK_THROWS_AS(restored.load(truncated), std::runtime_error);
+	CHECK(restored.empty());
+}
+
+namespace {
+
+// Puts size elements, starting with first, into a buffer whose front() sits
+// at slot offset of its storage.
+template <typename T, typename Make>
+void fill_at(circular_buffer<T>& cb, std::size_t offset, std::size_t size, Make make)
+{
+	for (std::size_t i = 0; i < offset; ++i)
+		cb.push_back(make(-1));
+	for (std::size_t i = 0; i < offset; ++i)
+		cb.pop_front();
+	for (std::size_t i = 0; i < size; ++i)
+		cb.push_back(make(static_cast<int>(i)));
+}
+
+template <typename T, typename Make, typename Value>
+void check_linearize(Make make, Value value)
+{
+	for (std::size_t capacity = 1; capacity <= 7; ++capacity) {
+		for (std::size_t offset = 0; offset < capacity; ++offset) {
+			for (std::size_t size = 0; size <= capacity; ++size) {
+				circular_buffer<T> cb(capacity);
+				fill_at(cb, offset, size, make);
+				const bool wrapped = cb.array_two().second != 0;
+				REQUIRE(cb.is_linearized() == !wrapped);
+
+				const auto range = cb.linearize();
+				REQUIRE(cb.is_linearized());
+				REQUIRE(range.second == size);
+				REQUIRE(cb.size() == size);
+				if (wrapped)
+					REQUIRE(range.first == &cb[0]);
+				for (std::size_t i = 0; i < size; ++i)
+					REQUIRE(value(range.first[i]) == static_cast<int>(i));
+
+				// Still a working ring afterwards.
+				if (capacity > 1 && size) {
+					cb.pop_front();
+					cb.push_back(make(100));
+					cb.push_back(make(101));
+					REQUIRE(value(cb.back()) == 101);
+				}
+			}
+		}
+	}
+}
+
+} // namespace
+
+TEST_CASE("Linearizing in place", "[circular_buffer]") {
+	SECTION("Trivially copyable") {
+		check_linearize<int>([](int i) { return i; }, [](int i) { return i; });
+	}
+	SECTION("Moved and destroyed element by element") {
+		check_linearize<leak_checker>([](int i) { return leak_checker(i); }, [](leak_checker& lc) { return lc.value(); });
+		REQUIRE(leak_checker::count == 0);
+	}
+	SECTION("Owning resources") {
+		check_linearize<std::string>([](int i) { return std::string(40, 'x') + std::to_string(i); },
+			[](const std::string& s) { return std::stoi(s.substr(40)); });
+	}
+}
+
+TEST_CASE("Erasing from the front", "[circular_buffer]") {
+	circular_buffer<std::string> strings(4);
+	for (const char* s : { "a", "b", "c", "d", "e" })
+		strings.push_back(s);
+	strings.erase_begin(2);
+	REQUIRE(strings.size() == 2);
+	CHECK(strings.front() == "d");
+	strings.erase_begin(2);
+	CHECK(strings.empty());
+
+	circular_buffer<int> ints(5);
+	for (int i = 0; i < 7; ++i)
+		ints.push_back(i);
+	ints.erase_begin(0);
+	CHECK(ints.size() == 5);
+	ints.erase_begin(4);
+	REQUIRE(ints.size() == 1);
+	CHECK(ints.front() == 6);
+	ints.push_back(7);
+	CHECK(ints.back() == 7);
+	ints.erase_begin(2);
+	CHECK(ints.empty());
+	ints.push_back(8);
+	CHECK(ints.front() == 8);
+}
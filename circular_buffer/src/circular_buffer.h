@@ -3,9 +3,21 @@
 // Based off Pete Goodlife's articles from ~2008
 // 
 
+#pragma once
+
+#include <algorithm>
+#include <cassert>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <iterator>
 #include <limits>
+#include <memory>
+#include <ostream>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
 
 template <typename T, typename A = std::allocator<T>>
 class circular_buffer
@@ -13,22 +25,27 @@ class circular_buffer
 public:
 	using value_type = T;
 	using allocator_type = A;
+	using allocator_traits = std::allocator_traits<allocator_type>;
 	using self_type = circular_buffer<T, A>;
-	using size_type = typename allocator_type::size_type;
-	using difference_type = typename allocator_type::difference_type;
-	using reference = typename allocator_type::reference;
-	using const_reference = typename allocator_type::const_reference;
-	using pointer = typename allocator_type::pointer;
-	using const_pointer = typename allocator_type::const_pointer;
+	using size_type = typename allocator_traits::size_type;
+	using difference_type = typename allocator_traits::difference_type;
+	using reference = value_type&;
+	using const_reference = const value_type&;
+	using pointer = typename allocator_traits::pointer;
+	using const_pointer = typename allocator_traits::const_pointer;
 	using class_type = circular_buffer;
 
 	class iterator;
 	using reverse_iterator = std::reverse_iterator<iterator>;
 
+	// A contiguous run of elements inside m_buffer: (first element, count).
+	using array_range = std::pair<pointer, size_type>;
+	using const_array_range = std::pair<const_pointer, size_type>;
+
 	explicit circular_buffer(std::size_t capacity, const allocator_type& allocator = allocator_type())
 		: m_capacity{ capacity },
 		m_allocator{allocator},
-		m_buffer(m_allocator.allocate(capacity)),
+		m_buffer(allocator_traits::allocate(m_allocator, capacity)),
 		m_front{ nullptr },
 		m_back{ m_buffer }
 	{}
@@ -36,7 +53,7 @@ public:
 	~circular_buffer()
 	{
 		clear();
-		m_allocator.deallocate(m_buffer, m_capacity);
+		allocator_traits::deallocate(m_allocator, m_buffer, m_capacity);
 	}
 
 	circular_buffer(const class_type&) = default;
@@ -73,7 +90,7 @@ public:
 
 	size_type max_size() const
 	{
-		return m_allocator.max_size();
+		return allocator_traits::max_size(m_allocator);
 	}
 
 	bool empty() const
@@ -111,12 +128,23 @@ public:
 	// using the allocator's methods rather than traditional construction, copying
 	// and assignment.
 	bool push_back(const value_type &value)
+	{
+		return emplace_back(value);
+	}
+
+	bool push_back(value_type &&value)
+	{
+		return emplace_back(std::move(value));
+	}
+
+	template <typename... Args>
+	bool emplace_back(Args&&... args)
 	{
 		// If the buffer is full, old data will be deleted. 
 		if (m_front && m_front == m_back)
-			m_allocator.destroy(m_back);
+			allocator_traits::destroy(m_allocator, m_back);
 
-		m_allocator.construct(m_back, value);
+		allocator_traits::construct(m_allocator, m_back, std::forward<Args>(args)...);
 
 		value_type* const next = wrap(m_back + 1);
 		if (empty()) {
@@ -139,7 +167,7 @@ public:
 	{
 		assert(m_front);
 
-		m_allocator.destroy(m_front);
+		allocator_traits::destroy(m_allocator, m_front);
 
 		value_type* const next = wrap(m_front + 1);
 		if (next == m_back)
@@ -148,11 +176,39 @@ public:
 			m_front = next;
 	}
 
+	// Removes the n oldest elements; O(1) when T is trivially destructible.
+	void erase_begin(size_type n)
+	{
+		assert(n <= size());
+		if constexpr (!std::is_trivially_destructible<value_type>::value) {
+			for (; n; --n)
+				pop_front();
+		}
+		else if (n == size()) {
+			m_front = nullptr;
+		}
+		else if (n) {
+			m_front = wrap(m_front + n);
+		}
+	}
+
+	void pop_back()
+	{
+		assert(m_front);
+
+		value_type* const last = wrap(m_back - 1);
+		allocator_traits::destroy(m_allocator, last);
+
+		if (last == m_front)
+			m_front = nullptr;
+		m_back = last;
+	}
+
 	void clear()
 	{
 		if (m_front) {
 			do {
-				m_allocator.destroy(m_front);
+				allocator_traits::destroy(m_allocator, m_front);
 				m_front = wrap(m_front + 1);
 			} while (m_front != m_back);
 		}
@@ -183,6 +239,132 @@ public:
 		return (*this)[index];
 	}
 
+	// The contents occupy at most two contiguous runs of m_buffer. array_one()
+	// starts at front(); array_two() is the part that wrapped round to the start
+	// of the storage and is empty when the contents do not wrap. Together they
+	// hold size() elements in order, so bulk algorithms can work on raw pointers
+	// instead of going through wrap() for every element.
+	array_range array_one()
+	{
+		if (empty())
+			return array_range(m_buffer, 0);
+		if (m_back > m_front)
+			return array_range(m_front, m_back - m_front);
+		return array_range(m_front, m_buffer + m_capacity - m_front);
+	}
+
+	const_array_range array_one() const
+	{
+		return const_cast<self_type*>(this)->array_one();
+	}
+
+	array_range array_two()
+	{
+		if (empty() || m_back > m_front)
+			return array_range(m_buffer, 0);
+		return array_range(m_buffer, m_back - m_buffer);
+	}
+
+	const_array_range array_two() const
+	{
+		return const_cast<self_type*>(this)->array_two();
+	}
+
+	// True when the contents occupy one contiguous run, so that array_one()
+	// holds all of them.
+	bool is_linearized() const
+	{
+		return empty() || m_back > m_front || m_back == m_buffer;
+	}
+
+	// Makes the contents one contiguous run and returns it, for APIs that
+	// take a single pointer. Already linearized contents are left where
+	// they are; wrapped ones are rotated in place to start at the beginning
+	// of the storage, without allocating. Trivially copyable elements are
+	// moved with memmove; others are moved and the moved-from originals
+	// destroyed, which assumes T's move constructor does not throw.
+	// Invalidates iterators and pointers into the buffer.
+	array_range linearize()
+	{
+		if (is_linearized())
+			return array_one();
+
+		const size_type n = size();
+		const size_type first = static_cast<size_type>(m_buffer + m_capacity - m_front);
+		const size_type second = n - first;
+		const size_type gap = m_capacity - n;
+		if (gap == 0) {
+			// Full: every slot holds an element.
+			std::rotate(m_buffer, m_front, m_buffer + m_capacity);
+		}
+		else if (first <= gap) {
+			// The second run moves up by first slots, into the gap, and the
+			// first run drops down in front of it.
+			relocate(m_buffer + first, m_buffer, second);
+			relocate(m_buffer, m_front, first);
+		}
+		else {
+			// Close the gap by moving the second run up against the first,
+			// swap the two runs over, and move the result down.
+			pointer joined = m_front - second;
+			relocate(joined, m_buffer, second);
+			std::rotate(joined, m_front, m_buffer + m_capacity);
+			relocate(m_buffer, joined, n);
+		}
+		m_front = m_buffer;
+		m_back = wrap(m_buffer + n);
+		return array_range(m_buffer, n);
+	}
+
+	// Binary snapshots, for trivially copyable T only: a 16-byte header
+	// (magic, element size, element count) followed by the elements in
+	// order. save() writes the header and the two contiguous runs, at most
+	// three writes in all. The format is the platform's native one and is
+	// not meant to travel between architectures.
+	void save(std::ostream& out) const
+	{
+		static_assert(std::is_trivially_copyable<value_type>::value, "save() writes elements as bytes");
+		const snapshot_header header{ { 'C', 'B', 'U', 'F' }, sizeof(value_type), size() };
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		for (const_array_range range : { array_one(), array_two() }) {
+			if (range.second)
+				out.write(reinterpret_cast<const char*>(range.first),
+					static_cast<std::streamsize>(range.second * sizeof(value_type)));
+		}
+		if (!out)
+			throw std::runtime_error("Cannot write snapshot");
+	}
+
+	// Replaces the contents with a snapshot written by save(), read with one
+	// read into linear order from the start of the storage. A snapshot
+	// larger than capacity() is skipped up to its newest capacity()
+	// elements, as pushing them one at a time would leave it. Throws
+	// std::runtime_error, leaving the buffer empty, on a malformed or
+	// truncated snapshot.
+	void load(std::istream& in)
+	{
+		static_assert(std::is_trivially_copyable<value_type>::value, "load() reads elements as bytes");
+		clear();
+		m_back = m_buffer;
+
+		snapshot_header header;
+		if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))
+			|| std::memcmp(header.magic, "CBUF", 4) != 0 || header.element_size != sizeof(value_type))
+			throw std::runtime_error("Not a snapshot of this element type");
+
+		std::uint64_t count = header.count;
+		if (count > m_capacity) {
+			in.ignore(static_cast<std::streamsize>((count - m_capacity) * sizeof(value_type)));
+			count = m_capacity;
+		}
+		if (count == 0)
+			return;
+		if (!in.read(reinterpret_cast<char*>(m_buffer), static_cast<std::streamsize>(count * sizeof(value_type))))
+			throw std::runtime_error("Truncated snapshot");
+		m_front = m_buffer;
+		m_back = wrap(m_buffer + count);
+	}
+
 private:
 	value_type* wrap(value_type* ptr) const
 	{
@@ -196,6 +378,36 @@ private:
 		return ptr;
 	}
 	
+	// Moves n elements from src to dest, which may overlap, leaving the
+	// slots of src outside dest empty. Slots of dest outside src must be
+	// empty beforehand.
+	void relocate(pointer dest, pointer src, size_type n)
+	{
+		if constexpr (std::is_trivially_copyable<value_type>::value) {
+			std::memmove(static_cast<void*>(dest), static_cast<const void*>(src), n * sizeof(value_type));
+			return;
+		}
+		// Go in the direction that never overwrites an element not yet moved.
+		if (dest < src) {
+			for (size_type i = 0; i < n; ++i) {
+				allocator_traits::construct(m_allocator, dest + i, std::move(src[i]));
+				allocator_traits::destroy(m_allocator, src + i);
+			}
+		}
+		else {
+			for (size_type i = n; i-- > 0;) {
+				allocator_traits::construct(m_allocator, dest + i, std::move(src[i]));
+				allocator_traits::destroy(m_allocator, src + i);
+			}
+		}
+	}
+
+	struct snapshot_header {
+		char magic[4];
+		std::uint32_t element_size;
+		std::uint64_t count;
+	};
+
 	const size_type m_capacity;
 	allocator_type m_allocator;
 	pointer m_buffer;
@@ -0,0 +1,89 @@
+#include "catch.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+#include <vector>
+
+#include "circular_buffer.h"
+
+TEST_CASE("Checkpointing a 256 MiB buffer", "[.][benchmark][circular_buffer]")
+{
+	const std::size_t n = 32 << 20;
+	circular_buffer<double> cb(n);
+	// Overfill so that the contents wrap.
+	for (std::size_t i = 0; i < n + n / 3; ++i)
+		cb.push_back(i * 0.5);
+	const char* path = "circular_buffer_bench.bin";
+
+	const auto time = [&](const char* name, auto&& f) {
+		const auto start = std::chrono::steady_clock::now();
+		f();
+		const double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::printf("%-36s %8.1f ms  %6.0f MB/s\n", name, s * 1e3, n * sizeof(double) / s / 1e6);
+	};
+
+	for (int round = 0; round < 2; ++round) {
+		time("Element by element, write", [&] {
+			std::ofstream out(path, std::ios::binary);
+			for (double value : cb)
+				out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+		});
+		time("Element by element, read", [&] {
+			std::ifstream in(path, std::ios::binary);
+			cb.clear();
+			double value;
+			while (in.read(reinterpret_cast<char*>(&value), sizeof(value)))
+				cb.push_back(value);
+		});
+		time("save()", [&] {
+			std::ofstream out(path, std::ios::binary);
+			cb.save(out);
+		});
+		time("load()", [&] {
+			std::ifstream in(path, std::ios::binary);
+			cb.load(in);
+		});
+	}
+	std::remove(path);
+	CHECK(cb.size() == n);
+	CHECK(cb.back() == (n + n / 3 - 1) * 0.5);
+}
+
+TEST_CASE("Handing a wrapped buffer to a contiguous API", "[.][benchmark][circular_buffer]")
+{
+	const std::size_t n = 1 << 22;
+	// The API: a sum over one contiguous array.
+	const auto api = [](const double* p, std::size_t count) { return std::accumulate(p, p + count, 0.0); };
+	// size elements with front() three quarters of the way into the storage.
+	const auto wrapped = [n](circular_buffer<double>& cb, std::size_t size) {
+		for (std::size_t i = 0; i < n * 3 / 4; ++i)
+			cb.push_back(0.0);
+		cb.clear();
+		for (std::size_t i = 0; i < size; ++i)
+			cb.push_back(1.0);
+	};
+
+	for (std::size_t size : { n, n / 2 }) {
+		std::printf("%zu of %zu elements\n", size, n);
+		double sink = 0;
+		circular_buffer<double> copied(n);
+		wrapped(copied, size);
+		BENCHMARK("Copy into a std::vector") {
+			std::vector<double> copy;
+			copy.reserve(copied.size());
+			for (auto range : { copied.array_one(), copied.array_two() })
+				copy.insert(copy.end(), range.first, range.first + range.second);
+			sink += api(copy.data(), copy.size());
+		}
+		circular_buffer<double> linearized(n);
+		wrapped(linearized, size);
+		BENCHMARK("linearize()") {
+			const auto range = linearized.linearize();
+			sink += api(range.first, range.second);
+		}
+		CHECK(sink == 2.0 * size);
+	}
+}
@@ -0,0 +1,318 @@
+// delta_circular_buffer.h
+//
+// Compressed circular_buffer for integer series that change slowly, such as
+// timestamps and counters. Values are grouped into blocks of block_size().
+// A block keeps its first value as is and every later value as the
+// zigzag-varint encoded delta-of-delta from the previous two. A series sampled
+// at a steady rate then costs about one byte per value instead of eight.
+//
+// Only the newest block, which is still being appended to, is writable; it is
+// sealed into an exactly sized allocation once full. When the ring is full
+// the next push_back evicts the oldest whole block, so once full size()
+// stays between capacity() - block_size() + 1 and capacity().
+//
+// Values are read back in order, decoding a block at a time, through
+// for_each(), the iterators or decode(). There is no random access.
+//
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+template <typename T>
+class delta_circular_buffer
+{
+	static_assert(std::is_integral<T>::value && sizeof(T) <= 8, "delta_circular_buffer holds integers of up to 64 bits");
+
+public:
+	using value_type = T;
+	using size_type = std::size_t;
+
+	class const_iterator;
+	using iterator = const_iterator;
+
+	// Room for capacity values, rounded up to whole blocks of block_size.
+	// Throws std::invalid_argument if block_size is 0.
+	explicit delta_circular_buffer(std::size_t capacity, std::size_t block_size = 256)
+		: m_block_size{ checked(block_size) },
+		m_blocks(capacity ? (capacity - 1) / m_block_size + 1 : 1),
+		m_scratch(new std::uint8_t[m_block_size * max_varint_bytes])
+	{}
+
+	delta_circular_buffer(const delta_circular_buffer&) = delete;
+	delta_circular_buffer& operator=(const delta_circular_buffer&) = delete;
+
+	size_type capacity() const { return m_blocks.size() * m_block_size; }
+	size_type block_size() const { return m_block_size; }
+	size_type size() const { return m_size; }
+	bool empty() const { return m_size == 0; }
+
+	// Number of blocks holding values, the last of them possibly partial.
+	size_type block_count() const { return m_block_count; }
+
+	// Bytes of encoded values plus per-block bookkeeping, excluding the
+	// fixed scratch area of the block being appended to.
+	size_type memory_bytes() const { return m_encoded_bytes + m_blocks.size() * sizeof(block); }
+
+	// Returns false if the oldest block was evicted to make room.
+	bool push_back(T value)
+	{
+		const std::uint64_t bits = static_cast<std::uint64_t>(value);
+		if (m_block_count && m_blocks[last_block()].count < m_block_size) {
+			block& b = m_blocks[last_block()];
+			const std::uint64_t delta = bits - m_last;
+			m_open_bytes += write_varint(m_scratch.get() + m_open_bytes, zigzag(delta - m_last_delta));
+			m_last = bits;
+			m_last_delta = delta;
+			++b.count;
+			++m_size;
+			if (b.count == m_block_size)
+				seal(b);
+			return true;
+		}
+
+		const bool evicted = m_block_count == m_blocks.size();
+		if (evicted)
+			pop_front_block();
+		block& b = m_blocks[slot(m_block_count++)];
+		b.first = bits;
+		b.count = 1;
+		m_open_bytes = 0;
+		m_last = bits;
+		m_last_delta = 0;
+		++m_size;
+		if (m_block_size == 1)
+			seal(b);
+		return !evicted;
+	}
+
+	// Drops the oldest block, for callers trimming by age.
+	void pop_front_block()
+	{
+		assert(m_block_count);
+		block& b = m_blocks[m_first_block];
+		m_size -= b.count;
+		m_encoded_bytes -= b.bytes;
+		b.data.reset();
+		b.bytes = 0;
+		b.count = 0;
+		m_first_block = slot(1);
+		--m_block_count;
+	}
+
+	void clear()
+	{
+		while (m_block_count)
+			pop_front_block();
+		m_first_block = 0;
+	}
+
+	T front() const { assert(m_size); return static_cast<T>(m_blocks[m_first_block].first); }
+	T back() const { assert(m_size); return static_cast<T>(m_last); }
+
+	// Calls f(T) for every value, oldest first.
+	template <typename F>
+	void for_each(F&& f) const
+	{
+		for (size_type i = 0; i < m_block_count; ++i) {
+			const block& b = m_blocks[slot(i)];
+			const std::uint8_t* p = bytes(b);
+			std::uint64_t value = b.first;
+			std::uint64_t delta = 0;
+			f(static_cast<T>(value));
+			for (size_type k = 1; k < b.count; ++k) {
+				delta += unzigzag(read_varint(p));
+				value += delta;
+				f(static_cast<T>(value));
+			}
+		}
+	}
+
+	// Decodes block i (0 is the oldest) into out, which must have room for
+	// block_size() values, and returns how many values it held.
+	size_type decode(std::size_t i, T* out) const
+	{
+		assert(i < m_block_count);
+		const block& b = m_blocks[slot(i)];
+		const std::uint8_t* p = bytes(b);
+		std::uint64_t value = b.first;
+		std::uint64_t delta = 0;
+		out[0] = static_cast<T>(value);
+		for (size_type k = 1; k < b.count; ++k) {
+			delta += unzigzag(read_varint(p));
+			value += delta;
+			out[k] = static_cast<T>(value);
+		}
+		return b.count;
+	}
+
+	const_iterator begin() const { return const_iterator(this, 0); }
+	const_iterator end() const { return const_iterator(this, m_block_count); }
+
+private:
+	static constexpr size_type max_varint_bytes = 10;
+
+	// Every member initializer after m_block_size divides by it or sizes
+	// the scratch area from it, so it is checked first.
+	static size_type checked(size_type block_size)
+	{
+		if (block_size == 0)
+			throw std::invalid_argument("Block size must be at least 1");
+		if (block_size > std::numeric_limits<size_type>::max() / max_varint_bytes)
+			throw std::length_error("Block size is too large");
+		return block_size;
+	}
+
+	struct block {
+		std::unique_ptr<std::uint8_t[]> data;
+		std::uint64_t first = 0;
+		size_type count = 0;
+		size_type bytes = 0;
+	};
+
+	// Maps a zero-centred signed difference, held in two's complement, to a
+	// small unsigned one: 0, -1, 1, -2, ... become 0, 1, 2, 3, ...
+	static std::uint64_t zigzag(std::uint64_t x)
+	{
+		return (x << 1) ^ (0 - (x >> 63));
+	}
+
+	static std::uint64_t unzigzag(std::uint64_t u)
+	{
+		return (u >> 1) ^ (0 - (u & 1));
+	}
+
+	static size_type write_varint(std::uint8_t* p, std::uint64_t u)
+	{
+		size_type n = 0;
+		while (u >= 0x80) {
+			p[n++] = static_cast<std::uint8_t>(u | 0x80);
+			u >>= 7;
+		}
+		p[n++] = static_cast<std::uint8_t>(u);
+		return n;
+	}
+
+	static std::uint64_t read_varint(const std::uint8_t*& p)
+	{
+		std::uint64_t u = *p++;
+		if (u < 0x80)
+			return u;
+		u &= 0x7f;
+		for (unsigned shift = 7;; shift += 7) {
+			const std::uint64_t byte = *p++;
+			u |= (byte & 0x7f) << shift;
+			if (byte < 0x80)
+				return u;
+		}
+	}
+
+	std::size_t slot(std::size_t i) const
+	{
+		const std::size_t s = m_first_block + i;
+		return s >= m_blocks.size() ? s - m_blocks.size() : s;
+	}
+
+	std::size_t last_block() const { return slot(m_block_count - 1); }
+
+	// The open block's bytes live in m_scratch until it is sealed.
+	const std::uint8_t* bytes(const block& b) const
+	{
+		return b.data ? b.data.get() : m_scratch.get();
+	}
+
+	void seal(block& b)
+	{
+		b.data.reset(new std::uint8_t[m_open_bytes ? m_open_bytes : 1]);
+		std::memcpy(b.data.get(), m_scratch.get(), m_open_bytes);
+		b.bytes = m_open_bytes;
+		m_encoded_bytes += m_open_bytes;
+	}
+
+	const size_type m_block_size;
+	std::vector<block> m_blocks;
+	std::unique_ptr<std::uint8_t[]> m_scratch;
+	std::size_t m_first_block = 0;
+	size_type m_block_count = 0;
+	size_type m_size = 0;
+	size_type m_encoded_bytes = 0;
+	// Encoder state of the open block.
+	size_type m_open_bytes = 0;
+	std::uint64_t m_last = 0;
+	std::uint64_t m_last_delta = 0;
+};
+
+// Decodes as it goes, holding only the position within the current block.
+// Pushing to the buffer invalidates iterators.
+template <typename T>
+class delta_circular_buffer<T>::const_iterator
+{
+public:
+	using iterator_category = std::input_iterator_tag;
+	using value_type = T;
+	using difference_type = std::ptrdiff_t;
+	using reference = T;
+	using pointer = void;
+
+	const_iterator(const delta_circular_buffer* owner, std::size_t block)
+		: m_owner{ owner }, m_block{ block }
+	{
+		if (m_block < m_owner->m_block_count)
+			enter_block();
+	}
+
+	T operator*() const { return static_cast<T>(m_value); }
+
+	const_iterator& operator++()
+	{
+		if (--m_remaining == 0) {
+			if (++m_block < m_owner->m_block_count)
+				enter_block();
+			return *this;
+		}
+		m_delta += unzigzag(read_varint(m_next));
+		m_value += m_delta;
+		return *this;
+	}
+
+	const_iterator operator++(int)
+	{
+		const_iterator old = *this;
+		++*this;
+		return old;
+	}
+
+	bool operator==(const const_iterator& other) const
+	{
+		return m_block == other.m_block && m_remaining == other.m_remaining && m_owner == other.m_owner;
+	}
+
+	bool operator!=(const const_iterator& other) const { return !(*this == other); }
+
+private:
+	void enter_block()
+	{
+		const block& b = m_owner->m_blocks[m_owner->slot(m_block)];
+		m_next = m_owner->bytes(b);
+		m_value = b.first;
+		m_delta = 0;
+		m_remaining = b.count;
+	}
+
+	const delta_circular_buffer* m_owner;
+	std::size_t m_block;
+	const std::uint8_t* m_next = nullptr;
+	std::uint64_t m_value = 0;
+	std::uint64_t m_delta = 0;
+	// Values left in the current block, counting the current one.
+	size_type m_remaining = 0;
+};
@@ -0,0 +1,73 @@
+#include "catch.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "circular_buffer.h"
+#include "delta_circular_buffer.h"
+
+TEST_CASE("Ten million jittered timestamps, plain and delta-compressed", "[.][benchmark][delta_circular_buffer]")
+{
+	const std::size_t n = 10000000;
+	circular_buffer<std::uint64_t> plain(n);
+	delta_circular_buffer<std::uint64_t> compressed(n);
+	std::mt19937 rng(42);
+	std::uint64_t t = 1500000000000000000ull;
+	// A microsecond clock sampled about every millisecond, overfilled so
+	// that both wrap.
+	for (std::size_t i = 0; i < n + n / 3; ++i) {
+		t += 1000 + rng() % 40;
+		plain.push_back(t);
+		compressed.push_back(t);
+	}
+	std::printf("circular_buffer %zu MiB, delta_circular_buffer %.1f MiB (%.2f bytes/value)\n",
+		n * sizeof(std::uint64_t) >> 20, compressed.memory_bytes() / 1048576.0,
+		static_cast<double>(compressed.memory_bytes()) / compressed.size());
+
+	const auto scan = [&](const char* name, std::size_t values, auto&& sum) {
+		const auto start = std::chrono::steady_clock::now();
+		const std::uint64_t total = sum();
+		const double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::printf("%-34s %7.2f ms  %6.2f GB/s decoded  (%llu)\n", name, s * 1e3,
+			values * sizeof(std::uint64_t) / s / 1e9, static_cast<unsigned long long>(total));
+	};
+	for (int round = 0; round < 3; ++round) {
+		scan("circular_buffer, array_one/two", plain.size(), [&] {
+			std::uint64_t total = 0;
+			for (auto range : { plain.array_one(), plain.array_two() })
+				for (std::size_t i = 0; i < range.second; ++i)
+					total += range.first[i];
+			return total;
+		});
+		scan("delta_circular_buffer::for_each", compressed.size(), [&] {
+			std::uint64_t total = 0;
+			compressed.for_each([&](std::uint64_t value) { total += value; });
+			return total;
+		});
+		scan("delta_circular_buffer iterators", compressed.size(), [&] {
+			std::uint64_t total = 0;
+			for (std::uint64_t value : compressed)
+				total += value;
+			return total;
+		});
+		scan("delta_circular_buffer::decode", compressed.size(), [&] {
+			std::uint64_t total = 0;
+			std::vector<std::uint64_t> block(compressed.block_size());
+			for (std::size_t i = 0; i < compressed.block_count(); ++i) {
+				const std::size_t count = compressed.decode(i, block.data());
+				for (std::size_t k = 0; k < count; ++k)
+					total += block[k];
+			}
+			return total;
+		});
+	}
+
+	BENCHMARK("delta_circular_buffer::push_back, 1M values") {
+		for (std::size_t i = 0; i < 1000000; ++i)
+			compressed.push_back(t += 1000 + (i & 31));
+	}
+	SUCCEED();
+}
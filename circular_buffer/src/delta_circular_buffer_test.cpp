@@ -0,0 +1,152 @@
+#include "catch.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "delta_circular_buffer.h"
+
+namespace {
+
+template <typename T>
+std::vector<T> contents(const delta_circular_buffer<T>& cb)
+{
+	std::vector<T> out;
+	cb.for_each([&](T value) { out.push_back(value); });
+	return out;
+}
+
+template <typename T>
+std::vector<T> iterated(const delta_circular_buffer<T>& cb)
+{
+	return std::vector<T>(cb.begin(), cb.end());
+}
+
+template <typename T>
+std::vector<T> decoded(const delta_circular_buffer<T>& cb)
+{
+	std::vector<T> out;
+	std::vector<T> block(cb.block_size());
+	for (std::size_t i = 0; i < cb.block_count(); ++i) {
+		const std::size_t n = cb.decode(i, block.data());
+		out.insert(out.end(), block.begin(), block.begin() + n);
+	}
+	return out;
+}
+
+// Pushes next() repeatedly and checks against a std::deque that drops whole
+// blocks the same way.
+template <typename T, typename Next>
+void check_against_deque(std::size_t capacity, std::size_t block_size, Next next)
+{
+	delta_circular_buffer<T> cb(capacity, block_size);
+	std::deque<T> model;
+	for (int step = 0; step < 2000; ++step) {
+		const T value = next();
+		const bool evict = model.size() == cb.capacity();
+		REQUIRE(cb.push_back(value) == !evict);
+		if (evict)
+			model.erase(model.begin(), model.begin() + block_size);
+		model.push_back(value);
+
+		REQUIRE(cb.size() == model.size());
+		REQUIRE(cb.front() == model.front());
+		REQUIRE(cb.back() == model.back());
+		if (step % 97 == 0 || step < 40) {
+			const std::vector<T> expected(model.begin(), model.end());
+			REQUIRE(contents(cb) == expected);
+			REQUIRE(iterated(cb) == expected);
+			REQUIRE(decoded(cb) == expected);
+		}
+	}
+}
+
+} // namespace
+
+TEST_CASE("delta_circular_buffer basics", "[delta_circular_buffer]")
+{
+	delta_circular_buffer<std::uint64_t> cb(10, 4);
+	CHECK(cb.capacity() == 12);
+	CHECK(cb.block_size() == 4);
+	CHECK(cb.empty());
+	CHECK(cb.begin() == cb.end());
+
+	for (std::uint64_t t = 1000; t < 1012; t += 1)
+		CHECK(cb.push_back(t * 10));
+	CHECK(cb.size() == 12);
+	CHECK(cb.block_count() == 3);
+	CHECK(cb.front() == 10000);
+	CHECK(cb.back() == 10110);
+
+	// The next push evicts the oldest block of four.
+	CHECK_FALSE(cb.push_back(10120));
+	CHECK(cb.size() == 9);
+	CHECK(cb.front() == 10040);
+	CHECK(contents(cb) == std::vector<std::uint64_t>{ 10040, 10050, 10060, 10070, 10080, 10090, 10100, 10110, 10120 });
+
+	cb.pop_front_block();
+	CHECK(cb.size() == 5);
+	CHECK(cb.front() == 10080);
+
+	cb.clear();
+	CHECK(cb.empty());
+	CHECK(cb.block_count() == 0);
+	CHECK(cb.push_back(7));
+	CHECK(contents(cb) == std::vector<std::uint64_t>{ 7 });
+}
+
+TEST_CASE("delta_circular_buffer rejects a zero block size", "[delta_circular_buffer]")
+{
+	CHECK_THROWS_AS(delta_circular_buffer<std::int32_t>(10, 0), std::invalid_argument);
+	CHECK_THROWS_AS(delta_circular_buffer<std::int32_t>(10, std::numeric_limits<std::size_t>::max()), std::length_error);
+	CHECK(delta_circular_buffer<std::int32_t>(0, 4).capacity() == 4);
+	CHECK(delta_circular_buffer<std::int32_t>(9, 3).capacity() == 9);
+}
+
+TEST_CASE("delta_circular_buffer round trips arbitrary series", "[delta_circular_buffer]")
+{
+	std::mt19937_64 rng(7);
+
+	SECTION("Jittered timestamps") {
+		std::uint64_t t = 1500000000000000000ull;
+		check_against_deque<std::uint64_t>(300, 64, [&] { return t += 1000 + rng() % 16; });
+	}
+	SECTION("Random 64-bit values, including wrap-around deltas") {
+		check_against_deque<std::uint64_t>(100, 16, [&] { return static_cast<std::uint64_t>(rng()); });
+	}
+	SECTION("Signed values around the extremes") {
+		const std::int64_t picks[] = { std::numeric_limits<std::int64_t>::min(), std::numeric_limits<std::int64_t>::max(), -1, 0, 1 };
+		check_against_deque<std::int64_t>(50, 7, [&] { return picks[rng() % 5]; });
+	}
+	SECTION("Narrow signed counters") {
+		std::int16_t v = 0;
+		check_against_deque<std::int16_t>(40, 5, [&] { return v = static_cast<std::int16_t>(v + static_cast<int>(rng() % 200) - 100); });
+	}
+	SECTION("One value per block") {
+		std::uint32_t v = 0;
+		check_against_deque<std::uint32_t>(8, 1, [&] { return v += 3; });
+	}
+}
+
+TEST_CASE("delta_circular_buffer compresses a steady series", "[delta_circular_buffer]")
+{
+	delta_circular_buffer<std::uint64_t> cb(100000);
+	std::uint64_t t = 1500000000000000000ull;
+	std::mt19937 rng(1);
+	for (int i = 0; i < 100000; ++i)
+		cb.push_back(t += 1000000 + rng() % 50);
+	// Jitter of under 64 keeps every delta-of-delta in one byte.
+	CHECK(cb.memory_bytes() < cb.size() * 3 / 2);
+
+	std::uint64_t previous = 0;
+	bool increasing = true;
+	for (std::uint64_t value : cb) {
+		increasing = increasing && value > previous;
+		previous = value;
+	}
+	CHECK(increasing);
+	CHECK(previous == t);
+}
@@ -0,0 +1,115 @@
+// fir_filter.h
+//
+// K-tap FIR filter with its own sample history. The history is a ring of K
+// samples held twice over in 2K slots (each sample is written at i and i + K),
+// so the last K samples are always one contiguous run and every output is a
+// single vectorized dot product against the reversed coefficients, with no
+// wrap() per tap. process() filters a whole block, working on a scratch copy
+// of the history followed by the input so that it does not write the mirror
+// for samples that are about to fall out of the window anyway.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include "circular_buffer.h"
+#include "reductions.h"
+
+template <typename T>
+class fir_filter
+{
+public:
+	using value_type = T;
+	using size_type = std::size_t;
+
+	// coefficients[j] weights the sample j steps in the past, so
+	// y[n] = sum(coefficients[j] * x[n - j]). The history starts as zeros.
+	template <typename Iterator>
+	fir_filter(Iterator first, Iterator last)
+		: m_taps(first, last)
+	{
+		if (m_taps.empty())
+			throw std::invalid_argument("Filter needs at least one coefficient");
+		std::reverse(m_taps.begin(), m_taps.end());
+		m_history.assign(2 * m_taps.size(), value_type{});
+	}
+
+	explicit fir_filter(const std::vector<value_type>& coefficients)
+		: fir_filter(coefficients.begin(), coefficients.end())
+	{}
+
+	size_type taps() const { return m_taps.size(); }
+
+	// Zeroes the history.
+	void reset()
+	{
+		std::fill(m_history.begin(), m_history.end(), value_type{});
+		m_pos = 0;
+	}
+
+	// Replaces the history with the newest taps() samples of an existing
+	// window (zeros in front when the window is shorter).
+	template <typename A>
+	void load_history(const circular_buffer<value_type, A>& window)
+	{
+		reset();
+		const size_type skip = window.size() > taps() ? window.size() - taps() : 0;
+		const auto one = window.array_one();
+		const auto two = window.array_two();
+		for (size_type i = skip; i < window.size(); ++i)
+			write(i < one.second ? one.first[i] : two.first[i - one.second]);
+	}
+
+	// Feeds one sample and returns the filtered output.
+	value_type push(const value_type& sample)
+	{
+		write(sample);
+		// write() advanced m_pos, so the window is m_history[m_pos, m_pos + K).
+		return static_cast<value_type>(
+			reduce::detail::kernels<value_type>::dot(m_history.data() + m_pos, m_taps.data(), taps()));
+	}
+
+	// Filters count samples from in into out (which may alias in).
+	void process(const value_type* in, value_type* out, size_type count)
+	{
+		const size_type k = taps();
+		const size_type block = std::max<size_type>(1024, k);
+		m_scratch.resize(k - 1 + block);
+
+		while (count) {
+			const size_type n = std::min(count, block);
+			// Oldest first: the newest k - 1 history samples, then the input.
+			std::copy(m_history.begin() + m_pos + 1, m_history.begin() + m_pos + k, m_scratch.begin());
+			std::copy(in, in + n, m_scratch.begin() + (k - 1));
+			for (size_type i = 0; i < n; ++i)
+				out[i] = static_cast<value_type>(
+					reduce::detail::kernels<value_type>::dot(m_scratch.data() + i, m_taps.data(), k));
+			// Only the last k inputs can still be in the window.
+			for (size_type i = n > k ? n - k : 0; i < n; ++i)
+				write(m_scratch[k - 1 + i]);
+			in += n;
+			out += n;
+			count -= n;
+		}
+	}
+
+private:
+	void write(const value_type& sample)
+	{
+		m_history[m_pos] = sample;
+		m_history[m_pos + taps()] = sample;
+		if (++m_pos == taps())
+			m_pos = 0;
+	}
+
+	// Coefficients, oldest tap first, to line up with the history.
+	std::vector<value_type> m_taps;
+	std::vector<value_type> m_history;
+	std::vector<value_type> m_scratch;
+	// Next slot to write; the last K samples are m_history[m_pos, m_pos + K).
+	size_type m_pos = 0;
+};
@@ -0,0 +1,50 @@
+#include "catch.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "circular_buffer.h"
+#include "fir_filter.h"
+
+TEST_CASE("FIR filter against indexing the circular_buffer per tap", "[.][benchmark][fir_filter]")
+{
+	const std::size_t samples = 1 << 16;
+	std::vector<float> input(samples);
+	for (std::size_t i = 0; i < samples; ++i)
+		input[i] = static_cast<float>(i % 97) * 0.01f;
+
+	for (std::size_t taps : { 16u, 64u, 256u }) {
+		std::vector<float> coefficients(taps, 1.0f / static_cast<float>(taps));
+		std::vector<float> out(samples);
+		float sink = 0.0f;
+
+		BENCHMARK("indexed circular_buffer loop, " + std::to_string(taps) + " taps") {
+			circular_buffer<float> history(taps);
+			for (std::size_t i = 0; i < taps; ++i)
+				history.push_back(0.0f);
+			for (std::size_t n = 0; n < samples; ++n) {
+				history.push_back(input[n]);
+				float acc = 0.0f;
+				for (std::size_t j = 0; j < taps; ++j)
+					acc += coefficients[j] * history[taps - 1 - j];
+				out[n] = acc;
+			}
+		}
+		sink += out.back();
+
+		fir_filter<float> filter(coefficients);
+		BENCHMARK("fir_filter::push, " + std::to_string(taps) + " taps") {
+			for (std::size_t n = 0; n < samples; ++n)
+				out[n] = filter.push(input[n]);
+		}
+		sink += out.back();
+
+		BENCHMARK("fir_filter::process, " + std::to_string(taps) + " taps") {
+			filter.process(input.data(), out.data(), samples);
+		}
+		sink += out.back();
+
+		REQUIRE(sink != 0.0f);
+	}
+}
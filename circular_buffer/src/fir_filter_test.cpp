@@ -0,0 +1,99 @@
+#include "catch.hpp"
+
+#include <vector>
+
+#include "fir_filter.h"
+
+namespace {
+
+// Direct form over the full input with zeros before the start.
+std::vector<double> reference_fir(const std::vector<double>& taps, const std::vector<double>& in)
+{
+	std::vector<double> out(in.size());
+	for (std::size_t n = 0; n < in.size(); ++n)
+		for (std::size_t j = 0; j < taps.size() && j <= n; ++j)
+			out[n] += taps[j] * in[n - j];
+	return out;
+}
+
+std::vector<double> ramp(std::size_t n)
+{
+	std::vector<double> v(n);
+	for (std::size_t i = 0; i < n; ++i)
+		v[i] = static_cast<double>(static_cast<int>((i * 37) % 23) - 11);
+	return v;
+}
+
+} // namespace
+
+TEST_CASE("Filter construction", "[fir_filter]")
+{
+	REQUIRE_THROWS_AS(fir_filter<float>(std::vector<float>{}), std::invalid_argument);
+	fir_filter<float> f({ 1.0f, 2.0f, 3.0f });
+	REQUIRE(f.taps() == 3);
+}
+
+TEST_CASE("Sample-at-a-time filtering", "[fir_filter]")
+{
+	fir_filter<double> f({ 1.0, 0.5, 0.25 });
+	REQUIRE(f.push(4.0) == 4.0);
+	REQUIRE(f.push(0.0) == 2.0);
+	REQUIRE(f.push(0.0) == 1.0);
+	REQUIRE(f.push(0.0) == 0.0);
+
+	for (std::size_t taps : { 1u, 2u, 5u, 16u, 33u }) {
+		const auto coefficients = ramp(taps);
+		const auto input = ramp(200);
+		const auto expected = reference_fir(coefficients, input);
+		fir_filter<double> g(coefficients);
+		for (std::size_t i = 0; i < input.size(); ++i)
+			REQUIRE(g.push(input[i]) == expected[i]);
+	}
+}
+
+TEST_CASE("Block filtering matches sample-at-a-time", "[fir_filter]")
+{
+	for (std::size_t taps : { 1u, 3u, 16u, 1500u }) {
+		const auto coefficients = ramp(taps);
+		const auto input = ramp(5000);
+		const auto expected = reference_fir(coefficients, input);
+
+		fir_filter<double> f(coefficients);
+		std::vector<double> out(input.size());
+		// Uneven blocks, including ones shorter than the filter.
+		std::size_t done = 0;
+		for (std::size_t step = 1; done < input.size(); step = step * 3 + 1) {
+			const std::size_t n = std::min(step, input.size() - done);
+			f.process(input.data() + done, out.data() + done, n);
+			done += n;
+		}
+		REQUIRE(out == expected);
+
+		// In place, and continuing from the block history with push().
+		fir_filter<double> g(coefficients);
+		auto data = input;
+		g.process(data.data(), data.data(), 4000);
+		for (std::size_t i = 4000; i < input.size(); ++i)
+			data[i] = g.push(input[i]);
+		REQUIRE(data == expected);
+	}
+}
+
+TEST_CASE("History can be seeded from a circular_buffer", "[fir_filter]")
+{
+	const std::vector<double> coefficients{ 1.0, 10.0, 100.0 };
+	circular_buffer<double> window(4);
+	for (double v : { 1.0, 2.0, 3.0, 4.0, 5.0, 6.0 })
+		window.push_back(v);
+
+	fir_filter<double> f(coefficients);
+	f.load_history(window);
+	// Newest three samples were 4, 5, 6.
+	REQUIRE(f.push(0.0) == 0.0 + 60.0 + 500.0);
+
+	circular_buffer<double> short_window(4);
+	short_window.push_back(7.0);
+	f.load_history(short_window);
+	REQUIRE(f.push(1.0) == 1.0 + 70.0);
+	REQUIRE(f.push(0.0) == 10.0 + 700.0);
+}
@@ -0,0 +1,198 @@
+// frame_splitter.h
+//
+// Splitting a circular_buffer<char> of received bytes into complete frames,
+// without copying them out. A frame is handed back as a frame_view: the one
+// std::string_view it occupies in the ring's storage, or two when it runs
+// across the wrap point. The view stays valid until the frame is popped.
+// pop() releases the frame's bytes with erase_begin(), so the ring has room
+// for the next read from the socket.
+//
+// delimited_frames ends each frame at a delimiter ("\n", "\r\n", ...), found
+// with byte_search::search(). length_prefixed_frames reads a 1, 2 or 4 byte
+// big-endian length before each frame.
+//
+// The views point into the ring, so bytes must not be pushed while the ring
+// is full: push_back() would overwrite the oldest frame. Push at most
+// capacity() - size() bytes at a time. A frame that cannot fit in the ring,
+// delimiter or header included, throws std::length_error when it is found.
+//
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "byte_search.h"
+#include "circular_buffer.h"
+
+// A frame in a ring: first, then second, which is empty unless the frame
+// wraps round.
+struct frame_view
+{
+	std::string_view first;
+	std::string_view second;
+
+	std::size_t size() const { return first.size() + second.size(); }
+	bool empty() const { return first.empty(); }
+	bool contiguous() const { return second.empty(); }
+
+	char operator[](std::size_t index) const
+	{
+		return index < first.size() ? first[index] : second[index - first.size()];
+	}
+
+	// Copies the frame to out, which must have room for size() chars.
+	void copy(char* out) const
+	{
+		first.copy(out, first.size());
+		second.copy(out + first.size(), second.size());
+	}
+
+	std::string str() const
+	{
+		std::string s;
+		s.reserve(size());
+		s.append(first);
+		s.append(second);
+		return s;
+	}
+
+	bool operator==(std::string_view s) const
+	{
+		return s.size() == size() && s.substr(0, first.size()) == first && s.substr(first.size()) == second;
+	}
+	bool operator!=(std::string_view s) const { return !(*this == s); }
+};
+
+namespace frame_splitter_detail {
+
+// The n chars from index offset onwards of cb, as a frame_view.
+template <typename A>
+frame_view view(const circular_buffer<char, A>& cb, std::size_t offset, std::size_t n)
+{
+	assert(offset + n <= cb.size());
+	const auto one = cb.array_one();
+	const auto two = cb.array_two();
+	if (offset >= one.second)
+		return { std::string_view(two.first + (offset - one.second), n), {} };
+	const std::size_t head = n < one.second - offset ? n : one.second - offset;
+	return { std::string_view(one.first + offset, head), std::string_view(two.first, n - head) };
+}
+
+} // namespace frame_splitter_detail
+
+// Frames that end in a delimiter, which is not part of the frame.
+template <typename A = std::allocator<char>>
+class delimited_frames
+{
+public:
+	using buffer_type = circular_buffer<char, A>;
+
+	// delimiter is copied, so it need not outlive the splitter.
+	explicit delimited_frames(buffer_type& buffer, std::string_view delimiter = "\n")
+		: m_buffer{ buffer },
+		m_delimiter{ delimiter }
+	{
+		if (m_delimiter.empty())
+			throw std::invalid_argument("Delimiter must not be empty");
+		if (m_delimiter.size() > m_buffer.capacity())
+			throw std::length_error("Delimiter is longer than the buffer");
+	}
+
+	// The oldest complete frame, or nothing until its delimiter has arrived.
+	// Calling next() again without pop() returns the same frame.
+	std::optional<frame_view> next()
+	{
+		if (!m_found) {
+			const std::size_t size = m_buffer.size();
+			const std::size_t at = byte_search::search(m_buffer, m_delimiter.data(), m_delimiter.size(), m_scanned);
+			if (at == size) {
+				if (size == m_buffer.capacity())
+					throw std::length_error("Frame does not fit in the buffer");
+				// Only the last delimiter - 1 bytes could start a match once
+				// more bytes arrive, so the next search starts there.
+				const std::size_t keep = m_delimiter.size() - 1;
+				m_scanned = size > keep ? size - keep : 0;
+				return std::nullopt;
+			}
+			m_found = true;
+			m_length = at;
+		}
+		return frame_splitter_detail::view(m_buffer, 0, m_length);
+	}
+
+	// Releases the frame last returned by next(), and its delimiter.
+	void pop()
+	{
+		assert(m_found);
+		m_buffer.erase_begin(m_length + m_delimiter.size());
+		m_found = false;
+		m_scanned = 0;
+	}
+
+	// Forgets any partly searched frame, for when the buffer was cleared.
+	void reset()
+	{
+		m_found = false;
+		m_scanned = 0;
+	}
+
+private:
+	buffer_type& m_buffer;
+	std::string m_delimiter;
+	// Where the next search starts: no delimiter begins before it.
+	std::size_t m_scanned = 0;
+	std::size_t m_length = 0;
+	bool m_found = false;
+};
+
+// Frames that follow a big-endian length of header_size bytes, which is not
+// part of the frame.
+template <typename A = std::allocator<char>>
+class length_prefixed_frames
+{
+public:
+	using buffer_type = circular_buffer<char, A>;
+
+	explicit length_prefixed_frames(buffer_type& buffer, std::size_t header_size = 4)
+		: m_buffer{ buffer },
+		m_header_size{ header_size }
+	{
+		if (header_size != 1 && header_size != 2 && header_size != 4)
+			throw std::invalid_argument("Header must be 1, 2 or 4 bytes");
+		if (header_size > m_buffer.capacity())
+			throw std::length_error("Header is longer than the buffer");
+	}
+
+	// The oldest complete frame, or nothing until all of it has arrived.
+	std::optional<frame_view> next()
+	{
+		const std::size_t size = m_buffer.size();
+		if (size < m_header_size)
+			return std::nullopt;
+		std::uint32_t length = 0;
+		for (std::size_t i = 0; i < m_header_size; ++i)
+			length = length << 8 | static_cast<unsigned char>(m_buffer[i]);
+		if (length > m_buffer.capacity() - m_header_size)
+			throw std::length_error("Frame does not fit in the buffer");
+		if (size - m_header_size < length)
+			return std::nullopt;
+		m_length = length;
+		return frame_splitter_detail::view(m_buffer, m_header_size, length);
+	}
+
+	// Releases the frame last returned by next(), and its header.
+	void pop() { m_buffer.erase_begin(m_header_size + m_length); }
+
+	std::size_t header_size() const { return m_header_size; }
+
+private:
+	buffer_type& m_buffer;
+	std::size_t m_header_size;
+	std::size_t m_length = 0;
+};
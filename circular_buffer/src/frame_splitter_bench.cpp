@@ -0,0 +1,95 @@
+#include "catch.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+
+#include "frame_splitter.h"
+
+namespace {
+
+// Header-like lines of 10 to 120 bytes, as a protocol gateway would see.
+std::string make_lines(std::size_t count)
+{
+	std::mt19937 rng(50);
+	std::string stream;
+	for (std::size_t i = 0; i < count; ++i) {
+		stream += "X-Field-" + std::to_string(i % 97) + ": ";
+		const std::size_t length = rng() % 100;
+		for (std::size_t j = 0; j < length; ++j)
+			stream += static_cast<char>('a' + rng() % 26);
+		stream += '\n';
+	}
+	return stream;
+}
+
+// Feeds the stream through a ring in reads of up to 4 KiB, calling
+// drain(cb) after each read to take out whatever lines are complete.
+template <typename Drain>
+void replay(circular_buffer<char>& cb, const std::string& stream, Drain drain)
+{
+	std::size_t offset = 0;
+	while (offset < stream.size()) {
+		const std::size_t chunk = std::min<std::size_t>({ stream.size() - offset, cb.capacity() - cb.size(), 4096 });
+		for (std::size_t i = 0; i < chunk; ++i)
+			cb.push_back(stream[offset + i]);
+		offset += chunk;
+		drain(cb);
+	}
+}
+
+} // namespace
+
+TEST_CASE("Splitting 1M lines out of a 64 KiB ring", "[.][benchmark][frame_splitter]")
+{
+	const std::string stream = make_lines(1000000);
+	circular_buffer<char> cb(64 << 10);
+	std::size_t sink = 0;
+
+	BENCHMARK("Pushing the reads alone, for reference") {
+		replay(cb, stream, [&](circular_buffer<char>& ring) {
+			sink += ring.back();
+			ring.erase_begin(ring.size());
+		});
+	}
+	BENCHMARK("Popping bytes into a std::string per line") {
+		std::string line;
+		replay(cb, stream, [&](circular_buffer<char>& ring) {
+			// Every complete line, a byte at a time.
+			while (byte_search::find_byte(ring, '\n') != ring.size()) {
+				line.clear();
+				for (char c = ring.front(); c != '\n'; c = ring.front()) {
+					line += c;
+					ring.pop_front();
+				}
+				ring.pop_front();
+				sink += line.size() + static_cast<unsigned char>(line[0]);
+			}
+		});
+	}
+	BENCHMARK("delimited_frames, copying each frame out") {
+		delimited_frames<> lines(cb);
+		std::string line;
+		replay(cb, stream, [&](circular_buffer<char>&) {
+			while (auto frame = lines.next()) {
+				line.resize(frame->size());
+				frame->copy(&line[0]);
+				lines.pop();
+				sink += line.size() + static_cast<unsigned char>(line[0]);
+			}
+		});
+	}
+	BENCHMARK("delimited_frames, zero-copy views") {
+		delimited_frames<> lines(cb);
+		replay(cb, stream, [&](circular_buffer<char>&) {
+			while (auto frame = lines.next()) {
+				sink += frame->size() + static_cast<unsigned char>((*frame)[0]);
+				lines.pop();
+			}
+		});
+	}
+	CHECK(cb.empty());
+	CHECK(sink != 0);
+}
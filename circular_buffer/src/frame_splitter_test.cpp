@@ -0,0 +1,224 @@
+#include "catch.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "frame_splitter.h"
+
+namespace {
+
+void push(circular_buffer<char>& cb, std::string_view bytes)
+{
+	REQUIRE(bytes.size() <= cb.capacity() - cb.size());
+	for (char c : bytes)
+		cb.push_back(c);
+}
+
+bool points_into(const circular_buffer<char>& cb, std::string_view s)
+{
+	for (auto range : { cb.array_one(), cb.array_two() }) {
+		if (s.data() >= range.first && s.data() + s.size() <= range.first + range.second)
+			return true;
+	}
+	return false;
+}
+
+std::string length_prefixed(const std::string& payload, std::size_t header_size)
+{
+	std::string s;
+	for (std::size_t i = header_size; i-- > 0;)
+		s += static_cast<char>(payload.size() >> (8 * i) & 0xff);
+	return s + payload;
+}
+
+} // namespace
+
+TEST_CASE("frame_view", "[frame_splitter]")
+{
+	const std::string text = "hello, world";
+	const frame_view whole{ std::string_view(text), {} };
+	const frame_view split{ std::string_view(text).substr(0, 5), std::string_view(text).substr(5) };
+	CHECK(whole.contiguous());
+	CHECK_FALSE(split.contiguous());
+	for (const frame_view& v : { whole, split }) {
+		CHECK(v.size() == text.size());
+		CHECK(v == text);
+		CHECK(v != "hello, worlD");
+		CHECK(v != "hello");
+		CHECK(v.str() == text);
+		CHECK(v[4] == 'o');
+		CHECK(v[7] == 'w');
+		std::string out(text.size(), '\0');
+		v.copy(&out[0]);
+		CHECK(out == text);
+	}
+	CHECK(frame_view{}.empty());
+}
+
+TEST_CASE("delimited_frames yields views into the ring", "[frame_splitter]")
+{
+	circular_buffer<char> cb(16);
+	delimited_frames<> lines(cb);
+	CHECK_FALSE(lines.next());
+
+	push(cb, "GET / HT");
+	CHECK_FALSE(lines.next());
+	push(cb, "TP\nHost");
+	auto frame = lines.next();
+	REQUIRE(frame);
+	CHECK(*frame == "GET / HTTP");
+	CHECK(frame->contiguous());
+	CHECK(points_into(cb, frame->first));
+	// Asking again without pop() gives the same frame.
+	CHECK(lines.next()->first.data() == frame->first.data());
+	lines.pop();
+	CHECK(cb.size() == 4);
+	CHECK_FALSE(lines.next());
+
+	// "Host: x\n" now runs round the end of the ring.
+	push(cb, ": x\n\n");
+	frame = lines.next();
+	REQUIRE(frame);
+	CHECK(*frame == "Host: x");
+	CHECK_FALSE(frame->contiguous());
+	CHECK(points_into(cb, frame->first));
+	CHECK(points_into(cb, frame->second));
+	lines.pop();
+
+	// An empty line is an empty frame.
+	frame = lines.next();
+	REQUIRE(frame);
+	CHECK(frame->empty());
+	lines.pop();
+	CHECK(cb.empty());
+	CHECK_FALSE(lines.next());
+}
+
+TEST_CASE("delimited_frames with a delimiter split by the wrap point", "[frame_splitter]")
+{
+	circular_buffer<char> cb(8);
+	delimited_frames<> lines(cb, "\r\n");
+	push(cb, "abcdef");
+	cb.erase_begin(6);
+	// Slots 6 and 7, then 0 onwards: "ab\r" ... "\n" ... across two pushes.
+	push(cb, "ab\r");
+	CHECK_FALSE(lines.next());
+	push(cb, "\ncd\r");
+	auto frame = lines.next();
+	REQUIRE(frame);
+	CHECK(*frame == "ab");
+	lines.pop();
+	CHECK_FALSE(lines.next());
+	push(cb, "x\r\n");
+	frame = lines.next();
+	REQUIRE(frame);
+	CHECK(*frame == "cd\rx");
+	lines.pop();
+	CHECK(cb.empty());
+
+	CHECK_THROWS_AS(delimited_frames<>(cb, ""), std::invalid_argument);
+	CHECK_THROWS_AS(delimited_frames<>(cb, "123456789"), std::length_error);
+}
+
+TEST_CASE("delimited_frames throws for a frame larger than the ring", "[frame_splitter]")
+{
+	circular_buffer<char> cb(8);
+	delimited_frames<> lines(cb);
+	push(cb, "1234567");
+	CHECK_FALSE(lines.next());
+	push(cb, "8");
+	CHECK_THROWS_AS(lines.next(), std::length_error);
+
+	// A full ring that does hold a whole frame is fine.
+	cb.clear();
+	lines.reset();
+	push(cb, "1234567\n");
+	REQUIRE(lines.next());
+	CHECK(*lines.next() == "1234567");
+}
+
+TEST_CASE("length_prefixed_frames", "[frame_splitter]")
+{
+	circular_buffer<char> cb(12);
+	length_prefixed_frames<> frames(cb, 2);
+	CHECK(frames.header_size() == 2);
+	push(cb, std::string("\0", 1));
+	CHECK_FALSE(frames.next());
+	push(cb, "\x05hel");
+	CHECK_FALSE(frames.next());
+	push(cb, "lo");
+	auto frame = frames.next();
+	REQUIRE(frame);
+	CHECK(*frame == "hello");
+	CHECK(points_into(cb, frame->first));
+	frames.pop();
+	CHECK(cb.empty());
+
+	// Wraps round: the ring's front is at slot 7.
+	push(cb, length_prefixed("wrapped", 2));
+	frame = frames.next();
+	REQUIRE(frame);
+	CHECK(*frame == "wrapped");
+	CHECK_FALSE(frame->contiguous());
+	frames.pop();
+
+	push(cb, length_prefixed("", 2));
+	frame = frames.next();
+	REQUIRE(frame);
+	CHECK(frame->empty());
+	frames.pop();
+	CHECK(cb.empty());
+
+	// 11 bytes cannot fit after a 2 byte header in 12.
+	push(cb, std::string("\0\x0b", 2));
+	CHECK_THROWS_AS(frames.next(), std::length_error);
+
+	CHECK_THROWS_AS(length_prefixed_frames<>(cb, 3), std::invalid_argument);
+}
+
+TEST_CASE("Frames survive arbitrary chunking of the stream", "[frame_splitter]")
+{
+	std::mt19937 rng(50);
+	for (std::size_t header_size : { std::size_t{ 0 }, std::size_t{ 1 }, std::size_t{ 2 }, std::size_t{ 4 } }) {
+		for (std::size_t capacity : { std::size_t{ 9 }, std::size_t{ 16 }, std::size_t{ 37 } }) {
+			// header_size 0 means newline-delimited.
+			const std::size_t framing = header_size ? header_size : 1;
+			std::vector<std::string> sent;
+			std::string stream;
+			for (int i = 0; i < 2000; ++i) {
+				std::string payload(rng() % (capacity - framing + 1), '\0');
+				for (char& c : payload)
+					c = static_cast<char>(header_size ? rng() : 'a' + rng() % 26);
+				sent.push_back(payload);
+				stream += header_size ? length_prefixed(payload, header_size) : payload + "\n";
+			}
+
+			circular_buffer<char> cb(capacity);
+			delimited_frames<> lines(cb);
+			length_prefixed_frames<> prefixed(cb, header_size ? header_size : 4);
+			std::vector<std::string> received;
+			std::size_t offset = 0;
+			while (offset < stream.size()) {
+				const std::size_t room = cb.capacity() - cb.size();
+				const std::size_t chunk = std::min<std::size_t>(stream.size() - offset, rng() % (room + 1));
+				push(cb, std::string_view(stream).substr(offset, chunk));
+				offset += chunk;
+				while (auto frame = header_size ? prefixed.next() : lines.next()) {
+					REQUIRE(points_into(cb, frame->first));
+					received.push_back(frame->str());
+					if (header_size)
+						prefixed.pop();
+					else
+						lines.pop();
+				}
+			}
+			CHECK(cb.empty());
+			CHECK(received == sent);
+		}
+	}
+}
@@ -0,0 +1,315 @@
+// object_pool.h
+//
+// Fixed-capacity pools of T over one contiguous slab, replacing new/delete
+// for objects that are created and destroyed at a high rate, such as
+// messages. The free list is a ring of free slot indices rather than links
+// threaded through the slots, so T needs no intrusive hook and the free list
+// is never touched through a dangling object. Acquiring takes the index at
+// the front of the ring and releasing puts it at the back, so slots are
+// reused in FIFO order: every slot gets the same share of use, and a
+// released object's memory is not handed out again until all the others
+// have been.
+//
+// object_pool keeps its free indices in a circular_buffer and is for one
+// thread. concurrent_object_pool keeps them in a bounded lock-free ring and
+// can be acquired from and released to by any number of threads.
+//
+// Both return nullptr from acquire() when every slot is in use, and destroy
+// any objects still acquired when the pool itself is destroyed.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "circular_buffer.h"
+#include "power_of_two.h"
+#include "wait_strategy.h"
+
+namespace object_pool_detail {
+
+// The slab: capacity uninitialised slots of T.
+template <typename T>
+class slab
+{
+public:
+	explicit slab(std::size_t capacity)
+		: m_capacity{ checked(capacity) },
+		m_slots(std::allocator<T>().allocate(capacity))
+	{}
+
+	~slab() { std::allocator<T>().deallocate(m_slots, m_capacity); }
+
+	slab(const slab&) = delete;
+	slab& operator=(const slab&) = delete;
+
+	std::size_t capacity() const { return m_capacity; }
+
+	bool owns(const T* p) const
+	{
+		return p >= m_slots && p < m_slots + m_capacity;
+	}
+
+	template <typename... Args>
+	T* construct(std::uint32_t index, Args&&... args)
+	{
+		return ::new (static_cast<void*>(m_slots + index)) T(std::forward<Args>(args)...);
+	}
+
+	std::uint32_t index_of(T* p) const
+	{
+		assert(owns(p));
+		return static_cast<std::uint32_t>(p - m_slots);
+	}
+
+	// Destroys the objects in every slot not marked free.
+	void destroy_live(const std::vector<bool>& free)
+	{
+		for (std::size_t i = 0; i < m_capacity; ++i) {
+			if (!free[i])
+				m_slots[i].~T();
+		}
+	}
+
+private:
+	static std::size_t checked(std::size_t capacity)
+	{
+		if (capacity > std::numeric_limits<std::uint32_t>::max())
+			throw std::length_error("Pool capacity exceeds 32-bit slot indices");
+		return capacity;
+	}
+
+	const std::size_t m_capacity;
+	T* m_slots;
+};
+
+} // namespace object_pool_detail
+
+template <typename T>
+class object_pool
+{
+public:
+	using value_type = T;
+	using size_type = std::size_t;
+
+	explicit object_pool(std::size_t capacity)
+		: m_slab(capacity),
+		m_free(capacity)
+	{
+		for (std::size_t i = 0; i < capacity; ++i)
+			m_free.push_back(static_cast<std::uint32_t>(i));
+	}
+
+	~object_pool()
+	{
+		std::vector<bool> free(m_slab.capacity());
+		for (std::uint32_t index : m_free)
+			free[index] = true;
+		m_slab.destroy_live(free);
+	}
+
+	object_pool(const object_pool&) = delete;
+	object_pool& operator=(const object_pool&) = delete;
+
+	size_type capacity() const { return m_slab.capacity(); }
+	size_type available() const { return m_free.size(); }
+	size_type in_use() const { return capacity() - available(); }
+
+	bool owns(const T* p) const { return m_slab.owns(p); }
+
+	// Constructs a T from args in the least recently released slot. Returns
+	// nullptr if every slot is in use. If T's constructor throws, the slot
+	// goes back to the pool.
+	template <typename... Args>
+	T* acquire(Args&&... args)
+	{
+		if (m_free.empty())
+			return nullptr;
+		const std::uint32_t index = m_free.front();
+		m_free.pop_front();
+		try {
+			return m_slab.construct(index, std::forward<Args>(args)...);
+		}
+		catch (...) {
+			m_free.push_back(index);
+			throw;
+		}
+	}
+
+	// p must have come from this pool's acquire().
+	void release(T* p)
+	{
+		const std::uint32_t index = m_slab.index_of(p);
+		p->~T();
+		m_free.push_back(index);
+	}
+
+private:
+	object_pool_detail::slab<T> m_slab;
+	circular_buffer<std::uint32_t> m_free;
+};
+
+// The free indices live in a bounded multi-producer, multi-consumer ring
+// (Dmitry Vyukov's design). Each cell carries a sequence number that says
+// which lap of the ring may next write or read it. A thread claims a cell with
+// one compare-and-swap on the shared head or tail, then publishes its write
+// or read with a release store of the cell's sequence. Releases never fail,
+// because the ring has room for every index.
+template <typename T>
+class concurrent_object_pool
+{
+public:
+	using value_type = T;
+	using size_type = std::size_t;
+
+	explicit concurrent_object_pool(std::size_t capacity)
+		: m_slab(capacity),
+		m_mask{ power_of_two::round_up(capacity) - 1 },
+		m_cells(new cell[m_mask + 1])
+	{
+		for (std::size_t i = 0; i <= m_mask; ++i) {
+			const bool free = i < capacity;
+			m_cells[i].sequence.store(free ? i + 1 : i, std::memory_order_relaxed);
+			m_cells[i].index = static_cast<std::uint32_t>(i);
+		}
+		m_tail.value.store(capacity, std::memory_order_relaxed);
+	}
+
+	~concurrent_object_pool()
+	{
+		std::vector<bool> free(m_slab.capacity());
+		const std::uint64_t tail = m_tail.value.load(std::memory_order_relaxed);
+		for (std::uint64_t i = m_head.value.load(std::memory_order_relaxed); i != tail; ++i)
+			free[m_cells[i & m_mask].index] = true;
+		m_slab.destroy_live(free);
+	}
+
+	concurrent_object_pool(const concurrent_object_pool&) = delete;
+	concurrent_object_pool& operator=(const concurrent_object_pool&) = delete;
+
+	size_type capacity() const { return m_slab.capacity(); }
+
+	// Approximate while other threads acquire and release.
+	size_type available() const
+	{
+		const std::uint64_t head = m_head.value.load(std::memory_order_acquire);
+		const std::uint64_t tail = m_tail.value.load(std::memory_order_acquire);
+		return tail > head ? static_cast<size_type>(tail - head) : 0;
+	}
+
+	bool owns(const T* p) const { return m_slab.owns(p); }
+
+	// As object_pool::acquire(); safe to call from any thread.
+	template <typename... Args>
+	T* acquire(Args&&... args)
+	{
+		std::uint32_t index;
+		if (!pop(index))
+			return nullptr;
+		try {
+			return m_slab.construct(index, std::forward<Args>(args)...);
+		}
+		catch (...) {
+			push(index);
+			throw;
+		}
+	}
+
+	// Safe to call from any thread, not just the one that acquired p.
+	void release(T* p)
+	{
+		const std::uint32_t index = m_slab.index_of(p);
+		p->~T();
+		push(index);
+	}
+
+private:
+	struct cell {
+		std::atomic<std::uint64_t> sequence;
+		std::uint32_t index;
+	};
+
+	struct alignas(64) padded_index {
+		std::atomic<std::uint64_t> value{ 0 };
+	};
+
+	// Waits, spinning and then yielding, until another thread finishes with
+	// cell c or moves position on from seen.
+	static void wait_for_change(const cell& c, std::uint64_t sequence, const padded_index& position, std::uint64_t seen)
+	{
+		spin_yield_wait().wait_until([&] {
+			return c.sequence.load(std::memory_order_acquire) != sequence
+				|| position.value.load(std::memory_order_relaxed) != seen;
+		});
+	}
+
+	bool pop(std::uint32_t& index)
+	{
+		std::uint64_t head = m_head.value.load(std::memory_order_relaxed);
+		for (;;) {
+			cell& c = m_cells[head & m_mask];
+			const std::uint64_t sequence = c.sequence.load(std::memory_order_acquire);
+			const std::int64_t lag = static_cast<std::int64_t>(sequence - (head + 1));
+			if (lag == 0) {
+				if (m_head.value.compare_exchange_weak(head, head + 1, std::memory_order_relaxed)) {
+					index = c.index;
+					// Free for the push one lap on.
+					c.sequence.store(head + m_mask + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (lag < 0) {
+				// Not yet written this lap. The ring is empty unless a release
+				// has claimed the cell and is about to fill it in, in which
+				// case there is a free slot on its way and acquire() waits
+				// for it rather than failing.
+				if (m_tail.value.load(std::memory_order_acquire) == head)
+					return false;
+				wait_for_change(c, sequence, m_head, head);
+				head = m_head.value.load(std::memory_order_relaxed);
+			}
+			else {
+				head = m_head.value.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	void push(std::uint32_t index)
+	{
+		std::uint64_t tail = m_tail.value.load(std::memory_order_relaxed);
+		for (;;) {
+			cell& c = m_cells[tail & m_mask];
+			const std::uint64_t sequence = c.sequence.load(std::memory_order_acquire);
+			if (sequence == tail) {
+				if (m_tail.value.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed)) {
+					c.index = index;
+					c.sequence.store(tail + 1, std::memory_order_release);
+					return;
+				}
+			}
+			else {
+				// Either another release claimed this cell first, or the
+				// acquire that took it one lap back has not finished reading
+				// it yet.
+				if (sequence < tail)
+					wait_for_change(c, sequence, m_tail, tail);
+				tail = m_tail.value.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	object_pool_detail::slab<T> m_slab;
+	const std::size_t m_mask;
+	std::unique_ptr<cell[]> m_cells;
+	padded_index m_head;
+	padded_index m_tail;
+};
@@ -0,0 +1,84 @@
+#include "catch.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "circular_buffer.h"
+#include "object_pool.h"
+
+namespace {
+
+struct message {
+	explicit message(std::uint64_t sequence) : sequence{ sequence } {}
+
+	std::uint64_t sequence;
+	char payload[120];
+};
+
+// A stream of messages with up to in_flight alive at once, each released in
+// the order it was created; returns nanoseconds per create and destroy.
+template <typename Create, typename Destroy>
+double stream(std::size_t count, std::size_t in_flight, Create create, Destroy destroy)
+{
+	circular_buffer<message*> live(in_flight);
+	const auto start = std::chrono::steady_clock::now();
+	for (std::uint64_t i = 0; i < count; ++i) {
+		if (live.size() == in_flight) {
+			destroy(live.front());
+			live.pop_front();
+		}
+		message* m = create(i);
+		m->payload[0] = static_cast<char>(i);
+		live.push_back(m);
+	}
+	while (!live.empty()) {
+		destroy(live.front());
+		live.pop_front();
+	}
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / count;
+}
+
+} // namespace
+
+TEST_CASE("Message allocation with new/delete and with object pools", "[.][benchmark][object_pool]")
+{
+	const std::size_t count = 20000000;
+	for (std::size_t in_flight : { std::size_t{ 16 }, std::size_t{ 4096 } }) {
+		object_pool<message> pool(in_flight);
+		concurrent_object_pool<message> shared(in_flight);
+		for (int round = 0; round < 2; ++round) {
+			const double heap = stream(count, in_flight,
+				[](std::uint64_t i) { return new message(i); },
+				[](message* m) { delete m; });
+			const double pooled = stream(count, in_flight,
+				[&](std::uint64_t i) { return pool.acquire(i); },
+				[&](message* m) { pool.release(m); });
+			const double concurrent = stream(count, in_flight,
+				[&](std::uint64_t i) { return shared.acquire(i); },
+				[&](message* m) { shared.release(m); });
+			std::printf("%4zu in flight: new/delete %6.2f ns  object_pool %6.2f ns  concurrent_object_pool %6.2f ns\n",
+				in_flight, heap, pooled, concurrent);
+		}
+	}
+
+	// Every thread streams through the one shared pool.
+	const unsigned threads = std::max(2u, std::thread::hardware_concurrency());
+	concurrent_object_pool<message> shared(threads * 64);
+	std::vector<std::thread> workers;
+	std::vector<double> ns(threads);
+	for (unsigned t = 0; t < threads; ++t) {
+		workers.emplace_back([&, t] {
+			ns[t] = stream(count / threads, 64,
+				[&](std::uint64_t i) { return shared.acquire(i); },
+				[&](message* m) { shared.release(m); });
+		});
+	}
+	for (auto& w : workers)
+		w.join();
+	std::printf("%u threads sharing a concurrent_object_pool: %.2f ns per create and destroy on thread 0\n", threads, ns[0]);
+	SUCCEED();
+}
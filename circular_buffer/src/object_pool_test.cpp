@@ -0,0 +1,144 @@
+#include "catch.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "object_pool.h"
+
+namespace {
+
+struct message {
+	static int live;
+
+	explicit message(int id, bool fail = false) : id{ id }
+	{
+		if (fail)
+			throw std::runtime_error("construction failed");
+		++live;
+	}
+	~message() { --live; }
+
+	int id;
+	char payload[52] = {};
+};
+
+int message::live = 0;
+
+template <typename Pool>
+void check_basics()
+{
+	Pool pool(4);
+	CHECK(pool.capacity() == 4);
+	CHECK(pool.available() == 4);
+
+	message* a = pool.acquire(1);
+	message* b = pool.acquire(2);
+	REQUIRE(a);
+	REQUIRE(b);
+	CHECK(a != b);
+	CHECK(a->id == 1);
+	CHECK(pool.owns(a));
+	CHECK(pool.available() == 2);
+	CHECK(message::live == 2);
+
+	message* c = pool.acquire(3);
+	message* d = pool.acquire(4);
+	REQUIRE(d);
+	CHECK(pool.acquire(5) == nullptr);
+
+	// FIFO reuse: b's slot comes back only after a's.
+	pool.release(a);
+	pool.release(b);
+	CHECK(message::live == 2);
+	message* e = pool.acquire(6);
+	message* f = pool.acquire(7);
+	CHECK(e == a);
+	CHECK(f == b);
+	CHECK(e->id == 6);
+
+	// A throwing constructor leaves the slot free.
+	pool.release(c);
+	CHECK_THROWS_AS(pool.acquire(8, true), std::runtime_error);
+	CHECK(pool.available() == 1);
+	CHECK(pool.acquire(9) == c);
+
+	message outside(10);
+	CHECK_FALSE(pool.owns(&outside));
+	pool.release(d);
+	// e, f and c are still acquired; the pool destroys them.
+}
+
+} // namespace
+
+TEST_CASE("object_pool acquires and releases in FIFO order", "[object_pool]")
+{
+	check_basics<object_pool<message>>();
+	CHECK(message::live == 0);
+}
+
+TEST_CASE("concurrent_object_pool behaves like object_pool on one thread", "[object_pool]")
+{
+	check_basics<concurrent_object_pool<message>>();
+	CHECK(message::live == 0);
+
+	// Capacities that are not a power of two leave spare ring cells.
+	concurrent_object_pool<int> pool(5);
+	std::set<int*> seen;
+	for (int lap = 0; lap < 3; ++lap) {
+		std::vector<int*> taken;
+		while (int* p = pool.acquire(lap))
+			taken.push_back(p);
+		REQUIRE(taken.size() == 5);
+		for (int* p : taken) {
+			seen.insert(p);
+			pool.release(p);
+		}
+	}
+	CHECK(seen.size() == 5);
+}
+
+TEST_CASE("concurrent_object_pool never hands a slot to two threads", "[object_pool]")
+{
+	struct owned {
+		std::atomic<int> owner{ -1 };
+	};
+	concurrent_object_pool<owned> pool(64);
+	const int threads = 4;
+	std::atomic<int> clashes{ 0 };
+	std::vector<std::thread> workers;
+	for (int t = 0; t < threads; ++t) {
+		workers.emplace_back([&, t] {
+			std::vector<owned*> held;
+			for (int i = 0; i < 20000; ++i) {
+				if (held.size() < 24) {
+					if (owned* p = pool.acquire()) {
+						if (p->owner.exchange(t) != -1)
+							++clashes;
+						held.push_back(p);
+					}
+					else {
+						std::this_thread::yield();
+					}
+				}
+				if (!held.empty() && (i % 3 == 0 || held.size() == 24)) {
+					owned* p = held.front();
+					held.erase(held.begin());
+					p->owner.store(-1);
+					pool.release(p);
+				}
+			}
+			for (owned* p : held) {
+				p->owner.store(-1);
+				pool.release(p);
+			}
+		});
+	}
+	for (auto& w : workers)
+		w.join();
+	CHECK(clashes == 0);
+	CHECK(pool.available() == 64);
+}
@@ -0,0 +1,273 @@
+// packed_circular_buffer.h
+//
+// circular_buffer of small unsigned integers, Bits (1 to 16) bits each,
+// packed into 64-bit words: 64 / Bits values per word, with any leftover high
+// bits of a word unused so that no value straddles two words. A ring of a
+// million flags takes 128 KiB instead of the megabyte circular_buffer<bool>
+// needs.
+//
+// push_back overwrites the oldest value when full, as circular_buffer does.
+// count() works a word at a time: a few shifts and masks reduce each value to
+// one bit saying whether it is non-zero, and a popcount adds them up, so
+// counting N values (failures among the last N requests, say) is O(N / 64)
+// for flags. push_back_word() appends a whole word's worth of values at
+// once.
+//
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+template <unsigned Bits>
+class packed_circular_buffer
+{
+	static_assert(Bits >= 1 && Bits <= 16, "packed_circular_buffer holds 1 to 16 bit values");
+
+public:
+	using value_type = typename std::conditional<(Bits <= 8), std::uint8_t, std::uint16_t>::type;
+	using size_type = std::size_t;
+	using word_type = std::uint64_t;
+
+	static constexpr unsigned bits = Bits;
+	static constexpr size_type values_per_word = 64 / Bits;
+	static constexpr value_type max_value = static_cast<value_type>((1u << Bits) - 1);
+
+	explicit packed_circular_buffer(std::size_t capacity)
+		: m_capacity{ capacity },
+		m_words(new word_type[word_count(capacity)]())
+	{}
+
+	packed_circular_buffer(const packed_circular_buffer&) = delete;
+	packed_circular_buffer& operator=(const packed_circular_buffer&) = delete;
+
+	size_type capacity() const { return m_capacity; }
+	size_type size() const { return m_size; }
+	bool empty() const { return m_size == 0; }
+	bool full() const { return m_size == m_capacity; }
+
+	// Bytes of packed storage.
+	size_type storage_bytes() const { return word_count(m_capacity) * sizeof(word_type); }
+
+	// value is truncated to Bits bits. Returns false if the buffer was full
+	// and the oldest value was overwritten.
+	bool push_back(unsigned value)
+	{
+		assert(m_capacity > 0);
+		if (m_size == m_capacity) {
+			write(m_first, value);
+			m_first = advance(m_first, 1);
+			return false;
+		}
+		write(advance(m_first, m_size), value);
+		++m_size;
+		return true;
+	}
+
+	// Appends the first n (at most values_per_word) values packed in lanes,
+	// value i in bits [i * Bits, (i + 1) * Bits), which is the layout of the
+	// storage words; for flags, bit i of lanes is flag i. Costs one or two
+	// masked word writes (three if the ring wraps in between). Returns false
+	// if old values were overwritten.
+	bool push_back_word(word_type lanes, size_type n = values_per_word)
+	{
+		assert(n <= values_per_word);
+		const bool overwrote = m_size + n > m_capacity;
+		if (n > m_capacity) {
+			// Only the newest capacity() values survive.
+			lanes = shift_down(lanes, (n - m_capacity) * Bits);
+			n = m_capacity;
+		}
+		std::size_t slot = advance(m_first, m_size == m_capacity ? 0 : m_size);
+		size_type written = 0;
+		while (written < n) {
+			const size_type lane = slot % values_per_word;
+			size_type run = values_per_word - lane;
+			if (run > n - written)
+				run = n - written;
+			if (run > m_capacity - slot)
+				run = m_capacity - slot;
+			word_type& word = m_words[slot / values_per_word];
+			const word_type mask = low_bits(run * Bits) << (lane * Bits);
+			word = (word & ~mask) | ((lanes << (lane * Bits)) & mask);
+			lanes = shift_down(lanes, run * Bits);
+			written += run;
+			slot = advance(slot, run);
+		}
+
+		if (m_size + n > m_capacity) {
+			m_first = advance(m_first, m_size + n - m_capacity);
+			m_size = m_capacity;
+		}
+		else {
+			m_size += n;
+		}
+		return !overwrote;
+	}
+
+	void pop_front()
+	{
+		assert(m_size);
+		m_first = advance(m_first, 1);
+		--m_size;
+	}
+
+	void pop_back()
+	{
+		assert(m_size);
+		--m_size;
+	}
+
+	void clear()
+	{
+		m_first = 0;
+		m_size = 0;
+	}
+
+	value_type operator[](std::size_t index) const
+	{
+		return read(advance(m_first, index));
+	}
+
+	value_type at(std::size_t index) const
+	{
+		if (index >= m_size)
+			throw std::out_of_range("Index out of range");
+		return (*this)[index];
+	}
+
+	value_type front() const { assert(m_size); return (*this)[0]; }
+	value_type back() const { assert(m_size); return (*this)[m_size - 1]; }
+
+	void set(std::size_t index, unsigned value)
+	{
+		assert(index < m_size);
+		write(advance(m_first, index), value);
+	}
+
+	// Number of non-zero values (set flags, for Bits == 1) among the n values
+	// starting at index first.
+	size_type count(std::size_t first, std::size_t n) const
+	{
+		assert(first + n <= m_size);
+		if (n == 0)
+			return 0;
+		const std::size_t begin = advance(m_first, first);
+		const std::size_t to_end = m_capacity - begin;
+		if (n <= to_end)
+			return count_slots(begin, begin + n);
+		return count_slots(begin, m_capacity) + count_slots(0, n - to_end);
+	}
+
+	// Number of non-zero values in the whole buffer.
+	size_type count() const { return count(0, m_size); }
+
+	// Number of non-zero values among the newest n.
+	size_type count_back(std::size_t n) const
+	{
+		assert(n <= m_size);
+		return count(m_size - n, n);
+	}
+
+private:
+	static constexpr word_type low_bits(size_type n)
+	{
+		return n >= 64 ? ~word_type{ 0 } : (word_type{ 1 } << n) - 1;
+	}
+
+	// word >> n, which is undefined for n == 64, so spelled out.
+	static constexpr word_type shift_down(word_type word, size_type n)
+	{
+		return n >= 64 ? 0 : word >> n;
+	}
+
+	// A word with the given per-value pattern repeated in every lane.
+	static constexpr word_type repeat(word_type pattern)
+	{
+		word_type result = 0;
+		for (size_type i = 0; i < values_per_word; ++i)
+			result |= pattern << (i * Bits);
+		return result;
+	}
+
+	static constexpr word_type lane_top = repeat(word_type{ 1 } << (Bits - 1));
+	static constexpr word_type lane_rest = repeat((word_type{ 1 } << (Bits - 1)) - 1);
+
+	static size_type word_count(size_type capacity)
+	{
+		return (capacity + values_per_word - 1) / values_per_word;
+	}
+
+	static unsigned popcount(word_type x)
+	{
+#if defined(_MSC_VER)
+		return static_cast<unsigned>(__popcnt64(x));
+#else
+		return static_cast<unsigned>(__builtin_popcountll(x));
+#endif
+	}
+
+	// The top bit of each lane of the result is set if that lane of x is
+	// non-zero. Adding lane_rest carries into the top bit exactly when some
+	// lower bit is set, and the lanes cannot carry into each other.
+	static word_type nonzero_lanes(word_type x)
+	{
+		return (((x & lane_rest) + lane_rest) | x) & lane_top;
+	}
+
+	std::size_t advance(std::size_t slot, std::size_t n) const
+	{
+		slot += n;
+		return slot >= m_capacity ? slot - m_capacity : slot;
+	}
+
+	value_type read(std::size_t slot) const
+	{
+		const unsigned shift = static_cast<unsigned>(slot % values_per_word) * Bits;
+		return static_cast<value_type>((m_words[slot / values_per_word] >> shift) & max_value);
+	}
+
+	void write(std::size_t slot, unsigned value)
+	{
+		const unsigned shift = static_cast<unsigned>(slot % values_per_word) * Bits;
+		word_type& word = m_words[slot / values_per_word];
+		word = (word & ~(word_type{ max_value } << shift)) | (word_type{ value & max_value } << shift);
+	}
+
+	// Non-zero values in slots [begin, end), which must be non-empty and must
+	// not wrap.
+	size_type count_slots(std::size_t begin, std::size_t end) const
+	{
+		std::size_t word = begin / values_per_word;
+		const std::size_t last_word = (end - 1) / values_per_word;
+		const size_type first_lane = begin % values_per_word;
+		const size_type end_lane = (end - 1) % values_per_word + 1;
+
+		if (word == last_word)
+			return popcount(nonzero_lanes(m_words[word]) & lanes(first_lane, end_lane));
+
+		size_type total = popcount(nonzero_lanes(m_words[word]) & lanes(first_lane, values_per_word));
+		for (++word; word < last_word; ++word)
+			total += popcount(nonzero_lanes(m_words[word]));
+		return total + popcount(nonzero_lanes(m_words[last_word]) & lanes(0, end_lane));
+	}
+
+	// The top bits of lanes [from, to).
+	static word_type lanes(size_type from, size_type to)
+	{
+		return lane_top & low_bits(to * Bits) & ~low_bits(from * Bits);
+	}
+
+	const size_type m_capacity;
+	std::unique_ptr<word_type[]> m_words;
+	std::size_t m_first = 0;
+	size_type m_size = 0;
+};
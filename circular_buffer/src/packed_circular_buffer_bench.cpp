@@ -0,0 +1,48 @@
+#include "catch.hpp"
+
+#include <cstdint>
+#include <random>
+
+#include "circular_buffer.h"
+#include "packed_circular_buffer.h"
+
+TEST_CASE("Counting failures among the last million requests", "[.][benchmark][packed_circular_buffer]")
+{
+	const std::size_t n = 1 << 20;
+	circular_buffer<bool> bools(n);
+	packed_circular_buffer<1> flags(n);
+	std::mt19937 rng(42);
+	// Overfill so that both wrap.
+	for (std::size_t i = 0; i < n + n / 3; ++i) {
+		const bool failed = rng() % 50 == 0;
+		bools.push_back(failed);
+		flags.push_back(failed);
+	}
+	std::printf("circular_buffer<bool> %zu KiB, packed_circular_buffer<1> %zu KiB\n",
+		n * sizeof(bool) / 1024, flags.storage_bytes() / 1024);
+
+	std::size_t sink = 0;
+	BENCHMARK("circular_buffer<bool>, count") {
+		std::size_t failures = 0;
+		for (auto range : { bools.array_one(), bools.array_two() })
+			for (std::size_t i = 0; i < range.second; ++i)
+				failures += range.first[i];
+		sink += failures;
+	}
+	BENCHMARK("packed_circular_buffer<1>::count") {
+		sink += flags.count();
+	}
+	BENCHMARK("packed_circular_buffer<1>::count_back(1000)") {
+		sink += flags.count_back(1000);
+	}
+
+	BENCHMARK("push_back, one flag at a time") {
+		for (std::size_t i = 0; i < n; ++i)
+			flags.push_back(i % 50 == 0);
+	}
+	BENCHMARK("push_back_word, 64 flags at a time") {
+		for (std::size_t i = 0; i < n; i += 64)
+			flags.push_back_word(0x0004000000000001ull);
+	}
+	CHECK(sink != 0);
+}
@@ -0,0 +1,139 @@
+#include "catch.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <random>
+
+#include "packed_circular_buffer.h"
+
+namespace {
+
+// Random pushes, word pushes and pops, checked against a std::deque.
+template <unsigned Bits>
+void check_against_deque(std::size_t capacity)
+{
+	using buffer_type = packed_circular_buffer<Bits>;
+	buffer_type cb(capacity);
+	std::deque<unsigned> model;
+	std::mt19937 rng(Bits * 1000 + static_cast<unsigned>(capacity));
+
+	for (int step = 0; step < 3000; ++step) {
+		const unsigned op = rng() % 10;
+		if (op < 5) {
+			// Mostly zeros, so that count() has something to count.
+			const unsigned value = rng() % 3 == 0 ? rng() & buffer_type::max_value : 0;
+			const bool room = model.size() < capacity;
+			REQUIRE(cb.push_back(value) == room);
+			if (!room)
+				model.pop_front();
+			model.push_back(value);
+		}
+		else if (op < 7) {
+			const std::size_t n = rng() % (buffer_type::values_per_word + 1);
+			std::uint64_t lanes = 0;
+			for (std::size_t i = 0; i < n; ++i) {
+				const std::uint64_t value = rng() % 2 ? rng() & buffer_type::max_value : 0;
+				lanes |= value << (i * Bits);
+				model.push_back(static_cast<unsigned>(value));
+			}
+			const bool room = model.size() <= capacity;
+			while (model.size() > capacity)
+				model.pop_front();
+			REQUIRE(cb.push_back_word(lanes, n) == room);
+		}
+		else if (op < 8 && !model.empty()) {
+			cb.pop_front();
+			model.pop_front();
+		}
+		else if (op < 9 && !model.empty()) {
+			cb.pop_back();
+			model.pop_back();
+		}
+		else if (!model.empty()) {
+			const std::size_t i = rng() % model.size();
+			const unsigned value = rng() & buffer_type::max_value;
+			cb.set(i, value);
+			model[i] = value;
+		}
+
+		REQUIRE(cb.size() == model.size());
+		if (model.empty())
+			continue;
+		const std::size_t first = rng() % model.size();
+		const std::size_t n = rng() % (model.size() - first + 1);
+		std::size_t expected = 0;
+		for (std::size_t i = first; i < first + n; ++i)
+			expected += model[i] != 0;
+		REQUIRE(cb.count(first, n) == expected);
+	}
+
+	for (std::size_t i = 0; i < model.size(); ++i)
+		REQUIRE(cb[i] == model[i]);
+}
+
+} // namespace
+
+TEST_CASE("Flags", "[packed_circular_buffer]")
+{
+	packed_circular_buffer<1> flags(100);
+	REQUIRE(flags.storage_bytes() == 16);
+	for (int i = 0; i < 150; ++i)
+		flags.push_back(i % 3 == 0);
+	REQUIRE(flags.size() == 100);
+	REQUIRE(flags.front() == (50 % 3 == 0));
+	REQUIRE(flags.count() == 33);
+	REQUIRE(flags.count_back(10) == 3);
+
+	// 64 flags in one go: every other one set.
+	REQUIRE(!flags.push_back_word(0x5555555555555555ull));
+	REQUIRE(flags.count_back(64) == 32);
+	REQUIRE(flags.back() == 0);
+	REQUIRE_THROWS_AS(flags.at(100), std::out_of_range);
+}
+
+TEST_CASE("Whole words of flags", "[packed_circular_buffer]")
+{
+	// Word-aligned, so each push fills one storage word exactly.
+	packed_circular_buffer<1> flags(128);
+	REQUIRE(flags.push_back_word(~0ull));
+	REQUIRE(flags.push_back_word(0x8000000000000001ull));
+	REQUIRE(flags.count() == 66);
+	REQUIRE(!flags.push_back_word(0));
+	REQUIRE(flags.count() == 2);
+	REQUIRE(flags[64] == 0);
+	REQUIRE(flags[0] == 1);
+
+	// A whole word into a ring with no room at all keeps nothing.
+	packed_circular_buffer<1> none(0);
+	REQUIRE(!none.push_back_word(~0ull));
+	REQUIRE(none.empty());
+
+	packed_circular_buffer<16> wide(4);
+	REQUIRE(wide.push_back_word(0x0004000300020001ull));
+	REQUIRE(!wide.push_back_word(0x0008000700060005ull));
+	for (int i = 0; i < 4; ++i)
+		REQUIRE(wide[i] == i + 5);
+}
+
+TEST_CASE("Values are truncated to their width", "[packed_circular_buffer]")
+{
+	packed_circular_buffer<3> cb(4);
+	REQUIRE(packed_circular_buffer<3>::values_per_word == 21);
+	REQUIRE(cb.push_back(5));
+	REQUIRE(cb.push_back(9));
+	REQUIRE(cb[0] == 5);
+	REQUIRE(cb[1] == 1);
+	REQUIRE(cb.count() == 2);
+}
+
+TEST_CASE("Matches a std::deque", "[packed_circular_buffer]")
+{
+	check_against_deque<1>(1);
+	check_against_deque<1>(64);
+	check_against_deque<1>(200);
+	check_against_deque<3>(50);
+	check_against_deque<5>(13);
+	check_against_deque<8>(17);
+	check_against_deque<12>(29);
+	check_against_deque<16>(9);
+}
@@ -0,0 +1,32 @@
+// power_of_two.h
+//
+// Capacity rounding shared by the rings that index slots with a mask:
+// spsc_ring, seqlock_ring, broadcast_ring, work_stealing_deque,
+// concurrent_object_pool and ring_cache's bucket table.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+
+namespace power_of_two {
+
+// The largest power of two a std::size_t holds.
+constexpr std::size_t max_value = std::size_t{ 1 } << (std::numeric_limits<std::size_t>::digits - 1);
+
+// The smallest power of two not below n, and 1 for 0. Throws
+// std::length_error when there is none, rather than doubling past the top
+// bit to 0 and looping for ever.
+inline std::size_t round_up(std::size_t n)
+{
+	if (n > max_value)
+		throw std::length_error("Capacity cannot be rounded up to a power of two");
+	std::size_t p = 1;
+	while (p < n)
+		p *= 2;
+	return p;
+}
+
+} // namespace power_of_two
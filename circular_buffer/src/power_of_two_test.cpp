@@ -0,0 +1,24 @@
+#include "catch.hpp"
+
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+
+#include "power_of_two.h"
+#include "spsc_ring.h"
+
+TEST_CASE("Rounding up to a power of two", "[power_of_two]")
+{
+	CHECK(power_of_two::round_up(0) == 1);
+	CHECK(power_of_two::round_up(1) == 1);
+	CHECK(power_of_two::round_up(2) == 2);
+	CHECK(power_of_two::round_up(3) == 4);
+	CHECK(power_of_two::round_up(1000) == 1024);
+	CHECK(power_of_two::round_up(power_of_two::max_value - 1) == power_of_two::max_value);
+	CHECK(power_of_two::round_up(power_of_two::max_value) == power_of_two::max_value);
+
+	CHECK_THROWS_AS(power_of_two::round_up(power_of_two::max_value + 1), std::length_error);
+	CHECK_THROWS_AS(power_of_two::round_up(std::numeric_limits<std::size_t>::max()), std::length_error);
+	// The rings throw before allocating anything.
+	CHECK_THROWS_AS(spsc_ring<int>(std::numeric_limits<std::size_t>::max()), std::length_error);
+}
@@ -0,0 +1,778 @@
+// reductions.h
+//
+// Aggregates (sum, min, max, min/max index, mean, dot product) over the
+// contents of a circular_buffer. Rather than walking the iterator, which goes
+// through wrap() for every element, the kernels run over the two contiguous
+// segments returned by array_one()/array_two(). float, double and int32_t use
+// AVX2 or SSE kernels chosen at runtime; every other type, and every other
+// architecture, gets the scalar loops.
+//
+// Floating point results may differ in the last bits from a left-to-right sum
+// because the vector kernels accumulate in several lanes. Inputs containing
+// NaN give unspecified min/max results.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "circular_buffer.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CB_REDUCE_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define CB_TARGET(isa)
+#else
+#define CB_TARGET(isa) __attribute__((target(isa)))
+#endif
+#else
+#define CB_REDUCE_X86 0
+#endif
+
+namespace reduce {
+
+// Sums of integers are accumulated (and returned) in 64 bits so that windows
+// of int32_t cannot overflow; floating point sums stay in the element type.
+template <typename T>
+using sum_type = std::conditional_t<std::is_integral<T>::value,
+	std::conditional_t<std::is_signed<T>::value, std::int64_t, std::uint64_t>, T>;
+
+namespace detail {
+
+enum class isa { scalar, sse, avx2 };
+
+#if CB_REDUCE_X86
+inline isa detect_isa()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	int regs[4];
+	__cpuid(regs, 0);
+	if (regs[0] < 7)
+		return isa::scalar;
+	__cpuid(regs, 1);
+	const bool sse41 = (regs[2] & (1 << 19)) != 0;
+	const bool fma = (regs[2] & (1 << 12)) != 0;
+	const bool osxsave = (regs[2] & (1 << 27)) != 0;
+	const bool avx = (regs[2] & (1 << 28)) != 0;
+	__cpuidex(regs, 7, 0);
+	const bool avx2 = (regs[1] & (1 << 5)) != 0;
+	const bool ymm_enabled = osxsave && avx && (_xgetbv(0) & 0x6) == 0x6;
+	if (ymm_enabled && avx2 && fma)
+		return isa::avx2;
+	return sse41 ? isa::sse : isa::scalar;
+#else
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+		return isa::avx2;
+	return __builtin_cpu_supports("sse4.1") ? isa::sse : isa::scalar;
+#endif
+}
+#else
+inline isa detect_isa() { return isa::scalar; }
+#endif
+
+// Detected once per process.
+inline isa current_isa()
+{
+	static const isa level = detect_isa();
+	return level;
+}
+
+// Scalar kernels: the fallback for every type and the tail handler for the
+// vector kernels. All of them require n > 0 except sum, find and dot.
+template <typename T>
+sum_type<T> scalar_sum(const T* p, std::size_t n)
+{
+	sum_type<T> acc{};
+	for (std::size_t i = 0; i < n; ++i)
+		acc += p[i];
+	return acc;
+}
+
+template <typename T>
+T scalar_min(const T* p, std::size_t n)
+{
+	T m = p[0];
+	for (std::size_t i = 1; i < n; ++i)
+		if (p[i] < m)
+			m = p[i];
+	return m;
+}
+
+template <typename T>
+T scalar_max(const T* p, std::size_t n)
+{
+	T m = p[0];
+	for (std::size_t i = 1; i < n; ++i)
+		if (m < p[i])
+			m = p[i];
+	return m;
+}
+
+// Index of the first element equal to value, or n.
+template <typename T>
+std::size_t scalar_find(const T* p, std::size_t n, const T& value)
+{
+	for (std::size_t i = 0; i < n; ++i)
+		if (p[i] == value)
+			return i;
+	return n;
+}
+
+template <typename T>
+sum_type<T> scalar_dot(const T* a, const T* b, std::size_t n)
+{
+	sum_type<T> acc{};
+	for (std::size_t i = 0; i < n; ++i)
+		acc += static_cast<sum_type<T>>(a[i]) * static_cast<sum_type<T>>(b[i]);
+	return acc;
+}
+
+#if CB_REDUCE_X86
+
+// Position of the lowest set bit of a non-zero movemask result.
+inline std::size_t lowest_bit(int mask)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	unsigned long index;
+	_BitScanForward(&index, static_cast<unsigned long>(mask));
+	return index;
+#else
+	return static_cast<std::size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+#endif
+}
+
+// --- SSE (SSE4.1 for the int32_t min/max/dot kernels) ---------------------
+
+CB_TARGET("sse4.1") inline float hsum(__m128 v)
+{
+	__m128 shuf = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+	__m128 sums = _mm_add_ps(v, shuf);
+	shuf = _mm_movehl_ps(shuf, sums);
+	return _mm_cvtss_f32(_mm_add_ss(sums, shuf));
+}
+
+CB_TARGET("sse4.1") inline double hsum(__m128d v)
+{
+	return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+}
+
+CB_TARGET("sse4.1") inline std::int64_t hsum_epi64(__m128i v)
+{
+	alignas(16) std::int64_t lanes[2];
+	_mm_store_si128(reinterpret_cast<__m128i*>(lanes), v);
+	return lanes[0] + lanes[1];
+}
+
+CB_TARGET("sse4.1") inline float sse_sum(const float* p, std::size_t n)
+{
+	__m128 a0 = _mm_setzero_ps(), a1 = _mm_setzero_ps();
+	std::size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		a0 = _mm_add_ps(a0, _mm_loadu_ps(p + i));
+		a1 = _mm_add_ps(a1, _mm_loadu_ps(p + i + 4));
+	}
+	return hsum(_mm_add_ps(a0, a1)) + scalar_sum(p + i, n - i);
+}
+
+CB_TARGET("sse4.1") inline double sse_sum(const double* p, std::size_t n)
+{
+	__m128d a0 = _mm_setzero_pd(), a1 = _mm_setzero_pd();
+	std::size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		a0 = _mm_add_pd(a0, _mm_loadu_pd(p + i));
+		a1 = _mm_add_pd(a1, _mm_loadu_pd(p + i + 2));
+	}
+	return hsum(_mm_add_pd(a0, a1)) + scalar_sum(p + i, n - i);
+}
+
+CB_TARGET("sse4.1") inline std::int64_t sse_sum(const std::int32_t* p, std::size_t n)
+{
+	__m128i acc = _mm_setzero_si128();
+	std::size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+		acc = _mm_add_epi64(acc, _mm_cvtepi32_epi64(v));
+		acc = _mm_add_epi64(acc, _mm_cvtepi32_epi64(_mm_srli_si128(v, 8)));
+	}
+	return hsum_epi64(acc) + scalar_sum(p + i, n - i);
+}
+
+CB_TARGET("sse4.1") inline float sse_min(const float* p, std::size_t n)
+{
+	if (n < 4)
+		return scalar_min(p, n);
+	__m128 m = _mm_loadu_ps(p);
+	std::size_t i = 4;
+	for (; i + 4 <= n; i += 4)
+		m = _mm_min_ps(m, _mm_loadu_ps(p + i));
+	alignas(16) float lanes[4];
+	_mm_store_ps(lanes, m);
+	float r = scalar_min(lanes, 4);
+	return i < n ? std::min(r, scalar_min(p + i, n - i)) : r;
+}
+
+CB_TARGET("sse4.1") inline float sse_max(const float* p, std::size_t n)
+{
+	if (n < 4)
+		return scalar_max(p, n);
+	__m128 m = _mm_loadu_ps(p);
+	std::size_t i = 4;
+	for (; i + 4 <= n; i += 4)
+		m = _mm_max_ps(m, _mm_loadu_ps(p + i));
+	alignas(16) float lanes[4];
+	_mm_store_ps(lanes, m);
+	float r = scalar_max(lanes, 4);
+	return i < n ? std::max(r, scalar_max(p + i, n - i)) : r;
+}
+
+CB_TARGET("sse4.1") inline double sse_min(const double* p, std::size_t n)
+{
+	if (n < 2)
+		return scalar_min(p, n);
+	__m128d m = _mm_loadu_pd(p);
+	std::size_t i = 2;
+	for (; i + 2 <= n; i += 2)
+		m = _mm_min_pd(m, _mm_loadu_pd(p + i));
+	alignas(16) double lanes[2];
+	_mm_store_pd(lanes, m);
+	double r = scalar_min(lanes, 2);
+	return i < n ? std::min(r, p[i]) : r;
+}
+
+CB_TARGET("sse4.1") inline double sse_max(const double* p, std::size_t n)
+{
+	if (n < 2)
+		return scalar_max(p, n);
+	__m128d m = _mm_loadu_pd(p);
+	std::size_t i = 2;
+	for (; i + 2 <= n; i += 2)
+		m = _mm_max_pd(m, _mm_loadu_pd(p + i));
+	alignas(16) double lanes[2];
+	_mm_store_pd(lanes, m);
+	double r = scalar_max(lanes, 2);
+	return i < n ? std::max(r, p[i]) : r;
+}
+
+CB_TARGET("sse4.1") inline std::int32_t sse_min(const std::int32_t* p, std::size_t n)
+{
+	if (n < 4)
+		return scalar_min(p, n);
+	__m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+	std::size_t i = 4;
+	for (; i + 4 <= n; i += 4)
+		m = _mm_min_epi32(m, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)));
+	alignas(16) std::int32_t lanes[4];
+	_mm_store_si128(reinterpret_cast<__m128i*>(lanes), m);
+	std::int32_t r = scalar_min(lanes, 4);
+	return i < n ? std::min(r, scalar_min(p + i, n - i)) : r;
+}
+
+CB_TARGET("sse4.1") inline std::int32_t sse_max(const std::int32_t* p, std::size_t n)
+{
+	if (n < 4)
+		return scalar_max(p, n);
+	__m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+	std::size_t i = 4;
+	for (; i + 4 <= n; i += 4)
+		m = _mm_max_epi32(m, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)));
+	alignas(16) std::int32_t lanes[4];
+	_mm_store_si128(reinterpret_cast<__m128i*>(lanes), m);
+	std::int32_t r = scalar_max(lanes, 4);
+	return i < n ? std::max(r, scalar_max(p + i, n - i)) : r;
+}
+
+CB_TARGET("sse4.1") inline std::size_t sse_find(const float* p, std::size_t n, float value)
+{
+	const __m128 v = _mm_set1_ps(value);
+	std::size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		const int mask = _mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(p + i), v));
+		if (mask)
+			return i + lowest_bit(mask);
+	}
+	return i + scalar_find(p + i, n - i, value);
+}
+
+CB_TARGET("sse4.1") inline std::size_t sse_find(const double* p, std::size_t n, double value)
+{
+	const __m128d v = _mm_set1_pd(value);
+	std::size_t i = 0;
+	for (; i + 2 <= n; i += 2) {
+		const int mask = _mm_movemask_pd(_mm_cmpeq_pd(_mm_loadu_pd(p + i), v));
+		if (mask)
+			return i + lowest_bit(mask);
+	}
+	return i + scalar_find(p + i, n - i, value);
+}
+
+CB_TARGET("sse4.1") inline std::size_t sse_find(const std::int32_t* p, std::size_t n, std::int32_t value)
+{
+	const __m128i v = _mm_set1_epi32(value);
+	std::size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		const __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)), v);
+		const int mask = _mm_movemask_ps(_mm_castsi128_ps(eq));
+		if (mask)
+			return i + lowest_bit(mask);
+	}
+	return i + scalar_find(p + i, n - i, value);
+}
+
+CB_TARGET("sse4.1") inline float sse_dot(const float* a, const float* b, std::size_t n)
+{
+	__m128 a0 = _mm_setzero_ps(), a1 = _mm_setzero_ps();
+	std::size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		a0 = _mm_add_ps(a0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+		a1 = _mm_add_ps(a1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+	}
+	return hsum(_mm_add_ps(a0, a1)) + scalar_dot(a + i, b + i, n - i);
+}
+
+CB_TARGET("sse4.1") inline double sse_dot(const double* a, const double* b, std::size_t n)
+{
+	__m128d a0 = _mm_setzero_pd(), a1 = _mm_setzero_pd();
+	std::size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		a0 = _mm_add_pd(a0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+		a1 = _mm_add_pd(a1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+	}
+	return hsum(_mm_add_pd(a0, a1)) + scalar_dot(a + i, b + i, n - i);
+}
+
+CB_TARGET("sse4.1") inline std::int64_t sse_dot(const std::int32_t* a, const std::int32_t* b, std::size_t n)
+{
+	__m128i acc = _mm_setzero_si128();
+	std::size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+		const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+		// _mm_mul_epi32 multiplies the low (signed) 32 bits of each 64-bit lane.
+		acc = _mm_add_epi64(acc, _mm_mul_epi32(x, y));
+		acc = _mm_add_epi64(acc, _mm_mul_epi32(_mm_srli_epi64(x, 32), _mm_srli_epi64(y, 32)));
+	}
+	return hsum_epi64(acc) + scalar_dot(a + i, b + i, n - i);
+}
+
+// --- AVX2 + FMA -------------------------------------------------------------
+
+CB_TARGET("avx2,fma") inline float hsum(__m256 v)
+{
+	return hsum(_mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1)));
+}
+
+CB_TARGET("avx2,fma") inline double hsum(__m256d v)
+{
+	return hsum(_mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1)));
+}
+
+CB_TARGET("avx2,fma") inline std::int64_t hsum_epi64(__m256i v)
+{
+	return hsum_epi64(_mm_add_epi64(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1)));
+}
+
+CB_TARGET("avx2,fma") inline float avx2_sum(const float* p, std::size_t n)
+{
+	__m256 a0 = _mm256_setzero_ps(), a1 = _mm256_setzero_ps();
+	__m256 a2 = _mm256_setzero_ps(), a3 = _mm256_setzero_ps();
+	std::size_t i = 0;
+	for (; i + 32 <= n; i += 32) {
+		a0 = _mm256_add_ps(a0, _mm256_loadu_ps(p + i));
+		a1 = _mm256_add_ps(a1, _mm256_loadu_ps(p + i + 8));
+		a2 = _mm256_add_ps(a2, _mm256_loadu_ps(p + i + 16));
+		a3 = _mm256_add_ps(a3, _mm256_loadu_ps(p + i + 24));
+	}
+	for (; i + 8 <= n; i += 8)
+		a0 = _mm256_add_ps(a0, _mm256_loadu_ps(p + i));
+	return hsum(_mm256_add_ps(_mm256_add_ps(a0, a1), _mm256_add_ps(a2, a3))) + scalar_sum(p + i, n - i);
+}
+
+CB_TARGET("avx2,fma") inline double avx2_sum(const double* p, std::size_t n)
+{
+	__m256d a0 = _mm256_setzero_pd(), a1 = _mm256_setzero_pd();
+	__m256d a2 = _mm256_setzero_pd(), a3 = _mm256_setzero_pd();
+	std::size_t i = 0;
+	for (; i + 16 <= n; i += 16) {
+		a0 = _mm256_add_pd(a0, _mm256_loadu_pd(p + i));
+		a1 = _mm256_add_pd(a1, _mm256_loadu_pd(p + i + 4));
+		a2 = _mm256_add_pd(a2, _mm256_loadu_pd(p + i + 8));
+		a3 = _mm256_add_pd(a3, _mm256_loadu_pd(p + i + 12));
+	}
+	for (; i + 4 <= n; i += 4)
+		a0 = _mm256_add_pd(a0, _mm256_loadu_pd(p + i));
+	return hsum(_mm256_add_pd(_mm256_add_pd(a0, a1), _mm256_add_pd(a2, a3))) + scalar_sum(p + i, n - i);
+}
+
+CB_TARGET("avx2,fma") inline std::int64_t avx2_sum(const std::int32_t* p, std::size_t n)
+{
+	__m256i a0 = _mm256_setzero_si256(), a1 = _mm256_setzero_si256();
+	std::size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		a0 = _mm256_add_epi64(a0, _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i))));
+		a1 = _mm256_add_epi64(a1, _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i + 4))));
+	}
+	return hsum_epi64(_mm256_add_epi64(a0, a1)) + scalar_sum(p + i, n - i);
+}
+
+CB_TARGET("avx2,fma") inline float avx2_min(const float* p, std::size_t n)
+{
+	if (n < 8)
+		return sse_min(p, n);
+	__m256 m = _mm256_loadu_ps(p);
+	std::size_t i = 8;
+	for (; i + 8 <= n; i += 8)
+		m = _mm256_min_ps(m, _mm256_loadu_ps(p + i));
+	alignas(32) float lanes[8];
+	_mm256_store_ps(lanes, m);
+	float r = scalar_min(lanes, 8);
+	return i < n ? std::min(r, scalar_min(p + i, n - i)) : r;
+}
+
+CB_TARGET("avx2,fma") inline float avx2_max(const float* p, std::size_t n)
+{
+	if (n < 8)
+		return sse_max(p, n);
+	__m256 m = _mm256_loadu_ps(p);
+	std::size_t i = 8;
+	for (; i + 8 <= n; i += 8)
+		m = _mm256_max_ps(m, _mm256_loadu_ps(p + i));
+	alignas(32) float lanes[8];
+	_mm256_store_ps(lanes, m);
+	float r = scalar_max(lanes, 8);
+	return i < n ? std::max(r, scalar_max(p + i, n - i)) : r;
+}
+
+CB_TARGET("avx2,fma") inline double avx2_min(const double* p, std::size_t n)
+{
+	if (n < 4)
+		return sse_min(p, n);
+	__m256d m = _mm256_loadu_pd(p);
+	std::size_t i = 4;
+	for (; i + 4 <= n; i += 4)
+		m = _mm256_min_pd(m, _mm256_loadu_pd(p + i));
+	alignas(32) double lanes[4];
+	_mm256_store_pd(lanes, m);
+	double r = scalar_min(lanes, 4);
+	return i < n ? std::min(r, scalar_min(p + i, n - i)) : r;
+}
+
+CB_TARGET("avx2,fma") inline double avx2_max(const double* p, std::size_t n)
+{
+	if (n < 4)
+		return sse_max(p, n);
+	__m256d m = _mm256_loadu_pd(p);
+	std::size_t i = 4;
+	for (; i + 4 <= n; i += 4)
+		m = _mm256_max_pd(m, _mm256_loadu_pd(p + i));
+	alignas(32) double lanes[4];
+	_mm256_store_pd(lanes, m);
+	double r = scalar_max(lanes, 4);
+	return i < n ? std::max(r, scalar_max(p + i, n - i)) : r;
+}
+
+CB_TARGET("avx2,fma") inline std::int32_t avx2_min(const std::int32_t* p, std::size_t n)
+{
+	if (n < 8)
+		return sse_min(p, n);
+	__m256i m = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+	std::size_t i = 8;
+	for (; i + 8 <= n; i += 8)
+		m = _mm256_min_epi32(m, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)));
+	alignas(32) std::int32_t lanes[8];
+	_mm256_store_si256(reinterpret_cast<__m256i*>(lanes), m);
+	std::int32_t r = scalar_min(lanes, 8);
+	return i < n ? std::min(r, scalar_min(p + i, n - i)) : r;
+}
+
+CB_TARGET("avx2,fma") inline std::int32_t avx2_max(const std::int32_t* p, std::size_t n)
+{
+	if (n < 8)
+		return sse_max(p, n);
+	__m256i m = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+	std::size_t i = 8;
+	for (; i + 8 <= n; i += 8)
+		m = _mm256_max_epi32(m, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)));
+	alignas(32) std::int32_t lanes[8];
+	_mm256_store_si256(reinterpret_cast<__m256i*>(lanes), m);
+	std::int32_t r = scalar_max(lanes, 8);
+	return i < n ? std::max(r, scalar_max(p + i, n - i)) : r;
+}
+
+CB_TARGET("avx2,fma") inline std::size_t avx2_find(const float* p, std::size_t n, float value)
+{
+	const __m256 v = _mm256_set1_ps(value);
+	std::size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		const int mask = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(p + i), v, _CMP_EQ_OQ));
+		if (mask)
+			return i + lowest_bit(mask);
+	}
+	return i + scalar_find(p + i, n - i, value);
+}
+
+CB_TARGET("avx2,fma") inline std::size_t avx2_find(const double* p, std::size_t n, double value)
+{
+	const __m256d v = _mm256_set1_pd(value);
+	std::size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		const int mask = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(p + i), v, _CMP_EQ_OQ));
+		if (mask)
+			return i + lowest_bit(mask);
+	}
+	return i + scalar_find(p + i, n - i, value);
+}
+
+CB_TARGET("avx2,fma") inline std::size_t avx2_find(const std::int32_t* p, std::size_t n, std::int32_t value)
+{
+	const __m256i v = _mm256_set1_epi32(value);
+	std::size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		const __m256i eq = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)), v);
+		const int mask = _mm256_movemask_ps(_mm256_castsi256_ps(eq));
+		if (mask)
+			return i + lowest_bit(mask);
+	}
+	return i + scalar_find(p + i, n - i, value);
+}
+
+CB_TARGET("avx2,fma") inline float avx2_dot(const float* a, const float* b, std::size_t n)
+{
+	__m256 a0 = _mm256_setzero_ps(), a1 = _mm256_setzero_ps();
+	__m256 a2 = _mm256_setzero_ps(), a3 = _mm256_setzero_ps();
+	std::size_t i = 0;
+	for (; i + 32 <= n; i += 32) {
+		a0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), a0);
+		a1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), a1);
+		a2 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 16), _mm256_loadu_ps(b + i + 16), a2);
+		a3 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 24), _mm256_loadu_ps(b + i + 24), a3);
+	}
+	for (; i + 8 <= n; i += 8)
+		a0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), a0);
+	return hsum(_mm256_add_ps(_mm256_add_ps(a0, a1), _mm256_add_ps(a2, a3))) + scalar_dot(a + i, b + i, n - i);
+}
+
+CB_TARGET("avx2,fma") inline double avx2_dot(const double* a, const double* b, std::size_t n)
+{
+	__m256d a0 = _mm256_setzero_pd(), a1 = _mm256_setzero_pd();
+	__m256d a2 = _mm256_setzero_pd(), a3 = _mm256_setzero_pd();
+	std::size_t i = 0;
+	for (; i + 16 <= n; i += 16) {
+		a0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), a0);
+		a1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4), a1);
+		a2 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 8), _mm256_loadu_pd(b + i + 8), a2);
+		a3 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 12), _mm256_loadu_pd(b + i + 12), a3);
+	}
+	for (; i + 4 <= n; i += 4)
+		a0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), a0);
+	return hsum(_mm256_add_pd(_mm256_add_pd(a0, a1), _mm256_add_pd(a2, a3))) + scalar_dot(a + i, b + i, n - i);
+}
+
+CB_TARGET("avx2,fma") inline std::int64_t avx2_dot(const std::int32_t* a, const std::int32_t* b, std::size_t n)
+{
+	__m256i acc = _mm256_setzero_si256();
+	std::size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+		const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+		acc = _mm256_add_epi64(acc, _mm256_mul_epi32(x, y));
+		acc = _mm256_add_epi64(acc, _mm256_mul_epi32(_mm256_srli_epi64(x, 32), _mm256_srli_epi64(y, 32)));
+	}
+	return hsum_epi64(acc) + scalar_dot(a + i, b + i, n - i);
+}
+
+#endif // CB_REDUCE_X86
+
+// Per-type dispatch. The primary template is the scalar fallback; float,
+// double and int32_t pick a vector kernel from current_isa().
+template <typename T>
+struct kernels {
+	static sum_type<T> sum(const T* p, std::size_t n) { return scalar_sum(p, n); }
+	static T min(const T* p, std::size_t n) { return scalar_min(p, n); }
+	static T max(const T* p, std::size_t n) { return scalar_max(p, n); }
+	static std::size_t find(const T* p, std::size_t n, const T& v) { return scalar_find(p, n, v); }
+	static sum_type<T> dot(const T* a, const T* b, std::size_t n) { return scalar_dot(a, b, n); }
+};
+
+#if CB_REDUCE_X86
+template <typename T>
+struct vector_kernels {
+	static sum_type<T> sum(const T* p, std::size_t n)
+	{
+		switch (current_isa()) {
+		case isa::avx2: return avx2_sum(p, n);
+		case isa::sse: return sse_sum(p, n);
+		default: return scalar_sum(p, n);
+		}
+	}
+
+	static T min(const T* p, std::size_t n)
+	{
+		switch (current_isa()) {
+		case isa::avx2: return avx2_min(p, n);
+		case isa::sse: return sse_min(p, n);
+		default: return scalar_min(p, n);
+		}
+	}
+
+	static T max(const T* p, std::size_t n)
+	{
+		switch (current_isa()) {
+		case isa::avx2: return avx2_max(p, n);
+		case isa::sse: return sse_max(p, n);
+		default: return scalar_max(p, n);
+		}
+	}
+
+	static std::size_t find(const T* p, std::size_t n, const T& v)
+	{
+		switch (current_isa()) {
+		case isa::avx2: return avx2_find(p, n, v);
+		case isa::sse: return sse_find(p, n, v);
+		default: return scalar_find(p, n, v);
+		}
+	}
+
+	static sum_type<T> dot(const T* a, const T* b, std::size_t n)
+	{
+		switch (current_isa()) {
+		case isa::avx2: return avx2_dot(a, b, n);
+		case isa::sse: return sse_dot(a, b, n);
+		default: return scalar_dot(a, b, n);
+		}
+	}
+};
+
+template <> struct kernels<float> : vector_kernels<float> {};
+template <> struct kernels<double> : vector_kernels<double> {};
+template <> struct kernels<std::int32_t> : vector_kernels<std::int32_t> {};
+#endif
+
+// Calls f(a, b, n) for each run of elements that is contiguous in both
+// sequences, where x and y are the (array_one, array_two) pairs of two
+// equally sized buffers. There are at most three such runs.
+template <typename RangeX, typename RangeY, typename F>
+void for_each_paired_run(RangeX x1, RangeX x2, RangeY y1, RangeY y2, F f)
+{
+	auto* xs = x1.first;
+	auto* ys = y1.first;
+	std::size_t xleft = x1.second;
+	std::size_t yleft = y1.second;
+	bool xsecond = false, ysecond = false;
+	while (xleft && yleft) {
+		const std::size_t n = xleft < yleft ? xleft : yleft;
+		f(xs, ys, n);
+		xs += n; ys += n;
+		xleft -= n; yleft -= n;
+		if (!xleft && !xsecond) {
+			xs = x2.first; xleft = x2.second; xsecond = true;
+		}
+		if (!yleft && !ysecond) {
+			ys = y2.first; yleft = y2.second; ysecond = true;
+		}
+	}
+}
+
+} // namespace detail
+
+template <typename T, typename A>
+sum_type<T> sum(const circular_buffer<T, A>& cb)
+{
+	const auto one = cb.array_one();
+	const auto two = cb.array_two();
+	return detail::kernels<T>::sum(one.first, one.second)
+		+ detail::kernels<T>::sum(two.first, two.second);
+}
+
+// Arithmetic mean; 0 for an empty buffer.
+template <typename T, typename A>
+double mean(const circular_buffer<T, A>& cb)
+{
+	return cb.empty() ? 0.0 : static_cast<double>(reduce::sum(cb)) / static_cast<double>(cb.size());
+}
+
+// min()/max() require a non-empty buffer, like front().
+template <typename T, typename A>
+T min(const circular_buffer<T, A>& cb)
+{
+	assert(!cb.empty());
+	const auto one = cb.array_one();
+	const auto two = cb.array_two();
+	const T m = detail::kernels<T>::min(one.first, one.second);
+	if (!two.second)
+		return m;
+	const T m2 = detail::kernels<T>::min(two.first, two.second);
+	return m2 < m ? m2 : m;
+}
+
+template <typename T, typename A>
+T max(const circular_buffer<T, A>& cb)
+{
+	assert(!cb.empty());
+	const auto one = cb.array_one();
+	const auto two = cb.array_two();
+	const T m = detail::kernels<T>::max(one.first, one.second);
+	if (!two.second)
+		return m;
+	const T m2 = detail::kernels<T>::max(two.first, two.second);
+	return m < m2 ? m2 : m;
+}
+
+// Index, counted from front(), of the first element equal to value, or
+// size() if there is none.
+template <typename T, typename A>
+typename circular_buffer<T, A>::size_type find(const circular_buffer<T, A>& cb, const T& value)
+{
+	const auto one = cb.array_one();
+	const std::size_t i = detail::kernels<T>::find(one.first, one.second, value);
+	if (i < one.second)
+		return i;
+	const auto two = cb.array_two();
+	return one.second + detail::kernels<T>::find(two.first, two.second, value);
+}
+
+// Index of the first occurrence of the smallest/largest element. These make
+// two bandwidth-bound passes (reduce, then locate) which is cheaper than
+// carrying indices through the vector loop.
+template <typename T, typename A>
+typename circular_buffer<T, A>::size_type min_index(const circular_buffer<T, A>& cb)
+{
+	return reduce::find(cb, reduce::min(cb));
+}
+
+template <typename T, typename A>
+typename circular_buffer<T, A>::size_type max_index(const circular_buffer<T, A>& cb)
+{
+	return reduce::find(cb, reduce::max(cb));
+}
+
+// Dot product of the buffer contents with the first size() elements of other.
+template <typename T, typename A>
+sum_type<T> dot(const circular_buffer<T, A>& cb, const T* other)
+{
+	const auto one = cb.array_one();
+	const auto two = cb.array_two();
+	return detail::kernels<T>::dot(one.first, other, one.second)
+		+ detail::kernels<T>::dot(two.first, other + one.second, two.second);
+}
+
+// Dot product of two buffers holding the same number of elements.
+template <typename T, typename A1, typename A2>
+sum_type<T> dot(const circular_buffer<T, A1>& a, const circular_buffer<T, A2>& b)
+{
+	if (a.size() != b.size())
+		throw std::invalid_argument("Buffers differ in size");
+	sum_type<T> acc{};
+	detail::for_each_paired_run(a.array_one(), a.array_two(), b.array_one(), b.array_two(),
+		[&acc](const T* x, const T* y, std::size_t n) { acc += detail::kernels<T>::dot(x, y, n); });
+	return acc;
+}
+
+} // namespace reduce
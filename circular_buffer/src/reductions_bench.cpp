@@ -0,0 +1,93 @@
+#include "catch.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "circular_buffer.h"
+#include "reductions.h"
+
+namespace {
+
+// A full buffer of size elements whose front is half way round, so every
+// reduction runs over both segments.
+template <typename T>
+circular_buffer<T> wrapped(std::size_t size)
+{
+	circular_buffer<T> cb(size);
+	for (std::size_t i = 0; i < size + size / 2; ++i)
+		cb.push_back(static_cast<T>(i % 1000));
+	return cb;
+}
+
+template <typename T>
+void compare(const std::string& type)
+{
+	const std::size_t size = 1 << 16;
+	circular_buffer<T> cb = wrapped<T>(size);
+	const std::vector<T> other(size, static_cast<T>(2));
+	// Not present, so find scans the whole buffer.
+	const T missing = static_cast<T>(-1);
+	double sink = 0.0;
+
+	BENCHMARK("sum, iterator loop, " + type) {
+		reduce::sum_type<T> acc{};
+		for (const T& v : cb)
+			acc += v;
+		sink += static_cast<double>(acc);
+	}
+	BENCHMARK("sum, scalar loop per segment, " + type) {
+		const auto one = cb.array_one();
+		const auto two = cb.array_two();
+		sink += static_cast<double>(reduce::detail::scalar_sum(one.first, one.second)
+			+ reduce::detail::scalar_sum(two.first, two.second));
+	}
+	BENCHMARK("sum, reduce::sum, " + type) {
+		sink += static_cast<double>(reduce::sum(cb));
+	}
+
+	BENCHMARK("min, iterator loop, " + type) {
+		T m = cb.front();
+		for (const T& v : cb)
+			m = v < m ? v : m;
+		sink += static_cast<double>(m);
+	}
+	BENCHMARK("min, reduce::min, " + type) {
+		sink += static_cast<double>(reduce::min(cb));
+	}
+
+	BENCHMARK("find, iterator loop, " + type) {
+		std::size_t i = 0;
+		for (const T& v : cb) {
+			if (v == missing)
+				break;
+			++i;
+		}
+		sink += static_cast<double>(i);
+	}
+	BENCHMARK("find, reduce::find, " + type) {
+		sink += static_cast<double>(reduce::find(cb, missing));
+	}
+
+	BENCHMARK("dot, indexed loop, " + type) {
+		reduce::sum_type<T> acc{};
+		for (std::size_t i = 0; i < size; ++i)
+			acc += static_cast<reduce::sum_type<T>>(cb[i]) * other[i];
+		sink += static_cast<double>(acc);
+	}
+	BENCHMARK("dot, reduce::dot, " + type) {
+		sink += static_cast<double>(reduce::dot(cb, other.data()));
+	}
+
+	REQUIRE(sink != 0.0);
+}
+
+} // namespace
+
+TEST_CASE("Reductions against scalar loops over 64K wrapped elements", "[.][benchmark][reductions]")
+{
+	compare<float>("float");
+	compare<double>("double");
+	compare<std::int32_t>("int32_t");
+}
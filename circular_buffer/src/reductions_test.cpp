@@ -0,0 +1,152 @@
+#include "catch.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#include "reductions.h"
+
+namespace {
+
+// Fills a buffer of the given capacity so that its contents wrap round the end
+// of the storage (after `offset` pops) and returns the expected contents.
+template <typename T>
+std::vector<T> fill_wrapped(circular_buffer<T>& cb, std::size_t count, std::size_t offset)
+{
+	for (std::size_t i = 0; i < offset; ++i)
+		cb.push_back(T{});
+	for (std::size_t i = 0; i < offset; ++i)
+		cb.pop_front();
+
+	std::vector<T> expected;
+	for (std::size_t i = 0; i < count; ++i) {
+		// Small integers keep floating point sums exact in any order.
+		const T value = static_cast<T>(static_cast<int>((i * 7919) % 61) - 30);
+		cb.push_back(value);
+		expected.push_back(value);
+	}
+	return expected;
+}
+
+template <typename T>
+void check_reductions()
+{
+	for (std::size_t capacity : { 1u, 3u, 8u, 17u, 64u, 100u }) {
+		for (std::size_t count = 1; count <= capacity; count += (capacity / 5) + 1) {
+			for (std::size_t offset : { std::size_t{ 0 }, capacity / 2, capacity - 1 }) {
+				circular_buffer<T> cb(capacity);
+				const auto expected = fill_wrapped(cb, count, offset);
+				REQUIRE(cb.array_one().second + cb.array_two().second == count);
+
+				using S = reduce::sum_type<T>;
+				const S expected_sum = std::accumulate(expected.begin(), expected.end(), S{});
+				REQUIRE(reduce::sum(cb) == expected_sum);
+				REQUIRE(reduce::mean(cb) == Approx(static_cast<double>(expected_sum) / count));
+
+				const auto min_it = std::min_element(expected.begin(), expected.end());
+				const auto max_it = std::max_element(expected.begin(), expected.end());
+				REQUIRE(reduce::min(cb) == *min_it);
+				REQUIRE(reduce::max(cb) == *max_it);
+				REQUIRE(reduce::min_index(cb) == static_cast<std::size_t>(min_it - expected.begin()));
+				REQUIRE(reduce::max_index(cb) == static_cast<std::size_t>(max_it - expected.begin()));
+				REQUIRE(reduce::find(cb, T(1000)) == count);
+
+				S expected_dot{};
+				for (std::size_t i = 0; i < count; ++i)
+					expected_dot += static_cast<S>(expected[i]) * static_cast<S>(expected[i]);
+				REQUIRE(reduce::dot(cb, expected.data()) == expected_dot);
+
+				// A second buffer with a different wrap point.
+				circular_buffer<T> other(capacity);
+				fill_wrapped(other, count, (offset + 1) % capacity);
+				REQUIRE(reduce::dot(cb, other) == expected_dot);
+			}
+		}
+	}
+}
+
+} // namespace
+
+TEST_CASE("Contiguous segments", "[reductions]")
+{
+	circular_buffer<int> cb(5);
+	REQUIRE(cb.array_one().second == 0);
+	REQUIRE(cb.array_two().second == 0);
+
+	cb.push_back(1);
+	cb.push_back(2);
+	cb.push_back(3);
+	REQUIRE(cb.array_one().second == 3);
+	REQUIRE(cb.array_one().first[0] == 1);
+	REQUIRE(cb.array_two().second == 0);
+
+	cb.push_back(4);
+	cb.push_back(5);
+	cb.push_back(6);
+	cb.push_back(7);
+	// Storage is now [6 7 3 4 5] with front() == 3.
+	REQUIRE(cb.array_one().second == 3);
+	REQUIRE(cb.array_one().first[0] == 3);
+	REQUIRE(cb.array_two().second == 2);
+	REQUIRE(cb.array_two().first[0] == 6);
+	REQUIRE(cb.array_two().first[1] == 7);
+}
+
+TEST_CASE("Reductions match the scalar definitions", "[reductions]")
+{
+	SECTION("float") { check_reductions<float>(); }
+	SECTION("double") { check_reductions<double>(); }
+	SECTION("int32_t") { check_reductions<std::int32_t>(); }
+	SECTION("int16_t (scalar fallback)") { check_reductions<std::int16_t>(); }
+}
+
+TEST_CASE("Reductions across mismatched buffers", "[reductions]")
+{
+	circular_buffer<int> a(4);
+	circular_buffer<int> b(5);
+	a.push_back(1);
+	b.push_back(1);
+	b.push_back(2);
+	REQUIRE_THROWS_AS(reduce::dot(a, b), std::invalid_argument);
+}
+
+#if CB_REDUCE_X86
+TEST_CASE("Each instruction set tier agrees with scalar", "[reductions]")
+{
+	using namespace reduce::detail;
+	std::vector<float> f(1031);
+	std::vector<double> d(1031);
+	std::vector<std::int32_t> i32(1031);
+	for (std::size_t i = 0; i < f.size(); ++i) {
+		f[i] = static_cast<float>(static_cast<int>((i * 31) % 97) - 48);
+		d[i] = f[i];
+		i32[i] = static_cast<std::int32_t>(f[i]) * 100000;
+	}
+
+	for (std::size_t n : { 1u, 7u, 8u, 33u, 1031u }) {
+		if (current_isa() != isa::scalar) {
+			REQUIRE(sse_sum(f.data(), n) == scalar_sum(f.data(), n));
+			REQUIRE(sse_sum(d.data(), n) == scalar_sum(d.data(), n));
+			REQUIRE(sse_sum(i32.data(), n) == scalar_sum(i32.data(), n));
+			REQUIRE(sse_min(f.data(), n) == scalar_min(f.data(), n));
+			REQUIRE(sse_max(d.data(), n) == scalar_max(d.data(), n));
+			REQUIRE(sse_min(i32.data(), n) == scalar_min(i32.data(), n));
+			REQUIRE(sse_find(i32.data(), n, i32[n - 1]) == scalar_find(i32.data(), n, i32[n - 1]));
+			REQUIRE(sse_dot(f.data(), f.data(), n) == scalar_dot(f.data(), f.data(), n));
+			REQUIRE(sse_dot(i32.data(), i32.data(), n) == scalar_dot(i32.data(), i32.data(), n));
+		}
+		if (current_isa() == isa::avx2) {
+			REQUIRE(avx2_sum(f.data(), n) == scalar_sum(f.data(), n));
+			REQUIRE(avx2_sum(d.data(), n) == scalar_sum(d.data(), n));
+			REQUIRE(avx2_sum(i32.data(), n) == scalar_sum(i32.data(), n));
+			REQUIRE(avx2_min(f.data(), n) == scalar_min(f.data(), n));
+			REQUIRE(avx2_max(d.data(), n) == scalar_max(d.data(), n));
+			REQUIRE(avx2_max(i32.data(), n) == scalar_max(i32.data(), n));
+			REQUIRE(avx2_find(f.data(), n, f[n - 1]) == scalar_find(f.data(), n, f[n - 1]));
+			REQUIRE(avx2_dot(d.data(), d.data(), n) == scalar_dot(d.data(), d.data(), n));
+			REQUIRE(avx2_dot(i32.data(), i32.data(), n) == scalar_dot(i32.data(), i32.data(), n));
+		}
+	}
+}
+#endif
@@ -0,0 +1,342 @@
+// ring_cache.h
+//
+// Fixed-capacity key-value cache that does no allocation of its own after
+// construction. Entries live in a circular_buffer of capacity slots, filled
+// by push_back until it is full and then replaced in place. Nothing is ever
+// popped from the front or pushed while full, and clear() pops from the
+// back, so the front never leaves the start of the storage: slot i is the
+// i-th element there, reached without a wrap on every probe. A hash index
+// (open addressing, linear probing) maps each key to its slot, and an
+// eviction policy picks the slot to reuse when the cache is full.
+//
+// The policies keep their own hand rather than using the buffer's front as
+// one. Moving the front would renumber every slot, and the hash index would
+// have to be rewritten to match. SIEVE also evicts from the middle of its
+// queue, which no single ring position can describe. The policies treat the
+// slots as a ring with a hand:
+//
+//   fifo_eviction   evicts in insertion order. The hand sits on the oldest
+//                   slot, and the new entry takes its place.
+//   clock_eviction  gives every entry hit since the hand last passed a
+//                   second chance: the hand clears its reference bit and
+//                   moves on, evicting the first entry whose bit is clear.
+//   sieve_eviction  is SIEVE (Zhang et al., NSDI '24). Like CLOCK, but new
+//                   entries go to the head of the queue rather than to the
+//                   hand's position, so the hand sweeps from the oldest
+//                   entries towards the newest and evicts new entries that
+//                   were never hit before old ones that were. The queue needs
+//                   removal from the middle, so it is threaded through the
+//                   slots with 32-bit links.
+//
+// A hit costs one probe sequence plus, for CLOCK and SIEVE, setting one
+// bit. Nothing is linked or unlinked on a hit, unlike an LRU list.
+//
+//   ring_cache<std::uint64_t, record> cache(100000);
+//   if (record* r = cache.find(id))
+//       use(*r);
+//   else
+//       cache.insert(id, load(id));
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "circular_buffer.h"
+#include "power_of_two.h"
+
+// A Policy is constructed with the capacity and has on_insert(slot) and
+// on_hit(slot) hooks, reset(), and victim(), which is called only when every
+// slot is full and returns the slot to evict; that slot is then reused by an
+// on_insert().
+class fifo_eviction
+{
+public:
+	explicit fifo_eviction(std::size_t capacity) : m_capacity{ capacity } {}
+
+	void on_insert(std::uint32_t) {}
+	void on_hit(std::uint32_t) {}
+	void reset() { m_hand = 0; }
+
+	std::uint32_t victim()
+	{
+		const std::uint32_t slot = m_hand;
+		m_hand = m_hand + 1 == m_capacity ? 0 : m_hand + 1;
+		return slot;
+	}
+
+private:
+	std::size_t m_capacity;
+	std::uint32_t m_hand = 0;
+};
+
+class clock_eviction
+{
+public:
+	explicit clock_eviction(std::size_t capacity) : m_referenced(capacity) {}
+
+	void on_insert(std::uint32_t slot) { m_referenced[slot] = 0; }
+	void on_hit(std::uint32_t slot) { m_referenced[slot] = 1; }
+
+	void reset()
+	{
+		std::fill(m_referenced.begin(), m_referenced.end(), std::uint8_t{ 0 });
+		m_hand = 0;
+	}
+
+	std::uint32_t victim()
+	{
+		while (m_referenced[m_hand]) {
+			m_referenced[m_hand] = 0;
+			advance();
+		}
+		const std::uint32_t slot = m_hand;
+		advance();
+		return slot;
+	}
+
+private:
+	void advance() { m_hand = m_hand + 1 == m_referenced.size() ? 0 : m_hand + 1; }
+
+	std::vector<std::uint8_t> m_referenced;
+	std::uint32_t m_hand = 0;
+};
+
+class sieve_eviction
+{
+public:
+	explicit sieve_eviction(std::size_t capacity)
+		: m_newer(capacity, none), m_older(capacity, none), m_visited(capacity)
+	{}
+
+	// The new entry goes to the head of the queue.
+	void on_insert(std::uint32_t slot)
+	{
+		m_visited[slot] = 0;
+		m_older[slot] = m_head;
+		m_newer[slot] = none;
+		if (m_head != none)
+			m_newer[m_head] = slot;
+		else
+			m_tail = slot;
+		m_head = slot;
+	}
+
+	void on_hit(std::uint32_t slot) { m_visited[slot] = 1; }
+
+	void reset()
+	{
+		std::fill(m_visited.begin(), m_visited.end(), std::uint8_t{ 0 });
+		m_head = m_tail = m_hand = none;
+	}
+
+	std::uint32_t victim()
+	{
+		std::uint32_t slot = m_hand != none ? m_hand : m_tail;
+		while (m_visited[slot]) {
+			m_visited[slot] = 0;
+			slot = m_newer[slot] != none ? m_newer[slot] : m_tail;
+		}
+		m_hand = m_newer[slot];
+		unlink(slot);
+		return slot;
+	}
+
+private:
+	static constexpr std::uint32_t none = std::numeric_limits<std::uint32_t>::max();
+
+	void unlink(std::uint32_t slot)
+	{
+		const std::uint32_t newer = m_newer[slot];
+		const std::uint32_t older = m_older[slot];
+		if (newer != none)
+			m_older[newer] = older;
+		else
+			m_head = older;
+		if (older != none)
+			m_newer[older] = newer;
+		else
+			m_tail = newer;
+	}
+
+	// Links from each slot towards the head (newest) and the tail (oldest).
+	std::vector<std::uint32_t> m_newer;
+	std::vector<std::uint32_t> m_older;
+	std::vector<std::uint8_t> m_visited;
+	std::uint32_t m_head = none;
+	std::uint32_t m_tail = none;
+	// Sweeps from the tail towards the head; none means start at the tail.
+	std::uint32_t m_hand = none;
+};
+
+template <typename Key, typename Value, typename Policy = sieve_eviction,
+	typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+class ring_cache
+{
+public:
+	using key_type = Key;
+	using mapped_type = Value;
+	using size_type = std::size_t;
+
+	explicit ring_cache(std::size_t capacity, const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual())
+		: m_entries(checked(capacity)),
+		m_slots{ m_entries.array_one().first },
+		m_mask{ power_of_two::round_up(capacity * 2) - 1 },
+		m_buckets(new bucket[m_mask + 1]()),
+		m_policy(capacity),
+		m_hash(hash),
+		m_equal(equal)
+	{}
+
+	ring_cache(const ring_cache&) = delete;
+	ring_cache& operator=(const ring_cache&) = delete;
+
+	size_type capacity() const { return m_entries.capacity(); }
+	size_type size() const { return m_entries.size(); }
+	bool empty() const { return m_entries.empty(); }
+
+	// The cached value for key, or nullptr. A hit counts towards keeping
+	// the entry.
+	Value* find(const Key& key)
+	{
+		const std::size_t b = locate(key, hash_of(key));
+		if (!m_buckets[b].slot)
+			return nullptr;
+		const std::uint32_t slot = m_buckets[b].slot - 1;
+		m_policy.on_hit(slot);
+		return &m_slots[slot].value;
+	}
+
+	// As find(), without counting as a hit.
+	bool contains(const Key& key) const
+	{
+		return m_buckets[locate(key, hash_of(key))].slot != 0;
+	}
+
+	// Caches value under key, evicting an entry chosen by the policy if the
+	// cache is full. If key is already cached its value is replaced, which
+	// counts as a hit. Returns true if key was not cached before. key and
+	// value may refer into the cache, even to the entry that gets evicted:
+	// the new entry is built before the victim is chosen, and move-assigned
+	// over it, so move-assigning Key and Value must not throw.
+	template <typename V>
+	bool insert(const Key& key, V&& value)
+	{
+		const std::uint32_t hash = hash_of(key);
+		std::size_t b = locate(key, hash);
+		if (m_buckets[b].slot) {
+			const std::uint32_t slot = m_buckets[b].slot - 1;
+			m_slots[slot].value = std::forward<V>(value);
+			m_policy.on_hit(slot);
+			return false;
+		}
+
+		std::uint32_t slot;
+		if (m_entries.size() < m_entries.capacity()) {
+			slot = static_cast<std::uint32_t>(m_entries.size());
+			m_entries.push_back(entry{ key, std::forward<V>(value), hash });
+		}
+		else {
+			entry fresh{ key, std::forward<V>(value), hash };
+			slot = m_policy.victim();
+			entry& old = m_slots[slot];
+			erase_bucket(locate(old.key, old.hash));
+			old = std::move(fresh);
+			// Erasing may have shifted the probe sequence.
+			b = locate(old.key, hash);
+		}
+		assert(&m_entries.front() == m_slots);
+		m_buckets[b] = bucket{ slot + 1, hash };
+		m_policy.on_insert(slot);
+		return true;
+	}
+
+	// Drops every entry and resets the policy.
+	void clear()
+	{
+		// From the back, which leaves the next push_back at m_slots.
+		while (!m_entries.empty())
+			m_entries.pop_back();
+		for (std::size_t b = 0; b <= m_mask; ++b)
+			m_buckets[b] = bucket{};
+		m_policy.reset();
+	}
+
+private:
+	struct entry {
+		Key key;
+		Value value;
+		std::uint32_t hash;
+	};
+
+	// slot is one more than the entry's slot, so that zero means empty.
+	// hash is kept so that probing can skip most key comparisons and
+	// erasing can move entries without rehashing their keys.
+	struct bucket {
+		std::uint32_t slot;
+		std::uint32_t hash;
+	};
+
+	static std::size_t checked(std::size_t capacity)
+	{
+		if (capacity == 0 || capacity >= std::numeric_limits<std::uint32_t>::max() / 2)
+			throw std::invalid_argument("Cache capacity must be between 1 and 2^31 - 1");
+		return capacity;
+	}
+
+	// std::hash is often the identity for integers; mix so that the low bits
+	// used to pick a bucket depend on every bit of the key.
+	std::uint32_t hash_of(const Key& key) const
+	{
+		std::uint64_t h = static_cast<std::uint64_t>(m_hash(key));
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdull;
+		h ^= h >> 33;
+		return static_cast<std::uint32_t>(h);
+	}
+
+	// The bucket holding key, or the empty bucket where it would go.
+	std::size_t locate(const Key& key, std::uint32_t hash) const
+	{
+		for (std::size_t b = hash & m_mask;; b = (b + 1) & m_mask) {
+			const bucket& candidate = m_buckets[b];
+			if (!candidate.slot
+				|| (candidate.hash == hash && m_equal(m_slots[candidate.slot - 1].key, key)))
+				return b;
+		}
+	}
+
+	// Backward-shift deletion: pull later members of the probe run into the
+	// hole so that lookups never need tombstones.
+	void erase_bucket(std::size_t hole)
+	{
+		for (std::size_t b = (hole + 1) & m_mask; m_buckets[b].slot; b = (b + 1) & m_mask) {
+			const std::size_t home = m_buckets[b].hash & m_mask;
+			// Move b into the hole unless its home lies cyclically in
+			// (hole, b], where moving it would put it before its home.
+			if (((b - home) & m_mask) >= ((b - hole) & m_mask)) {
+				m_buckets[hole] = m_buckets[b];
+				hole = b;
+			}
+		}
+		m_buckets[hole] = bucket{};
+	}
+
+	circular_buffer<entry> m_entries;
+	// The start of m_entries' storage, where its front always is.
+	entry* const m_slots;
+	const std::size_t m_mask;
+	std::unique_ptr<bucket[]> m_buckets;
+	Policy m_policy;
+	Hash m_hash;
+	KeyEqual m_equal;
+};
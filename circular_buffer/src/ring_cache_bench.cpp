@@ -0,0 +1,106 @@
+#include "catch.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <list>
+#include <random>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ring_cache.h"
+
+namespace {
+
+// The baseline: std::list in recency order plus a std::unordered_map index.
+class lru_cache
+{
+public:
+	explicit lru_cache(std::size_t capacity) : m_capacity{ capacity } { m_index.reserve(capacity); }
+
+	std::uint64_t* find(std::uint64_t key)
+	{
+		const auto it = m_index.find(key);
+		if (it == m_index.end())
+			return nullptr;
+		m_order.splice(m_order.begin(), m_order, it->second);
+		return &it->second->second;
+	}
+
+	void insert(std::uint64_t key, std::uint64_t value)
+	{
+		if (m_index.size() == m_capacity) {
+			m_index.erase(m_order.back().first);
+			m_order.pop_back();
+		}
+		m_order.emplace_front(key, value);
+		m_index.emplace(key, m_order.begin());
+	}
+
+private:
+	using entry = std::pair<std::uint64_t, std::uint64_t>;
+
+	std::size_t m_capacity;
+	std::list<entry> m_order;
+	std::unordered_map<std::uint64_t, std::list<entry>::iterator> m_index;
+};
+
+// Keys drawn from a Zipf distribution over universe ranks, scattered so that
+// popular keys are not numerically adjacent.
+std::vector<std::uint64_t> zipf_trace(std::size_t universe, double alpha, std::size_t length)
+{
+	std::vector<double> cdf(universe);
+	double total = 0;
+	for (std::size_t rank = 0; rank < universe; ++rank)
+		cdf[rank] = total += 1.0 / std::pow(static_cast<double>(rank + 1), alpha);
+	std::mt19937_64 rng(alpha * 1000);
+	std::uniform_real_distribution<double> uniform(0, total);
+	std::vector<std::uint64_t> trace(length);
+	for (auto& key : trace) {
+		const std::size_t rank = std::lower_bound(cdf.begin(), cdf.end(), uniform(rng)) - cdf.begin();
+		key = rank * 0x9e3779b97f4a7c15ull;
+	}
+	return trace;
+}
+
+template <typename Cache>
+void replay(const char* name, Cache& cache, const std::vector<std::uint64_t>& trace)
+{
+	std::size_t hits = 0;
+	const auto start = std::chrono::steady_clock::now();
+	for (std::uint64_t key : trace) {
+		if (std::uint64_t* value = cache.find(key)) {
+			hits += *value == key;
+		}
+		else {
+			cache.insert(key, key);
+		}
+	}
+	const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / trace.size();
+	std::printf("  %-7s hit ratio %6.2f%%  %6.1f ns/request\n", name, 100.0 * hits / trace.size(), ns);
+}
+
+} // namespace
+
+TEST_CASE("Zipfian traces through LRU, FIFO, CLOCK and SIEVE caches", "[.][benchmark][ring_cache]")
+{
+	const std::size_t universe = 1 << 20;
+	for (double alpha : { 0.8, 1.0 }) {
+		const std::vector<std::uint64_t> trace = zipf_trace(universe, alpha, 10000000);
+		for (std::size_t capacity : { universe / 100, universe / 10 }) {
+			std::printf("alpha %.1f, %zu keys, cache of %zu\n", alpha, universe, capacity);
+			lru_cache lru(capacity);
+			replay("LRU", lru, trace);
+			ring_cache<std::uint64_t, std::uint64_t, fifo_eviction> fifo(capacity);
+			replay("FIFO", fifo, trace);
+			ring_cache<std::uint64_t, std::uint64_t, clock_eviction> clock(capacity);
+			replay("CLOCK", clock, trace);
+			ring_cache<std::uint64_t, std::uint64_t, sieve_eviction> sieve(capacity);
+			replay("SIEVE", sieve, trace);
+		}
+	}
+	SUCCEED();
+}
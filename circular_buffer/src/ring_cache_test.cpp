@@ -0,0 +1,253 @@
+#include "catch.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ring_cache.h"
+
+namespace {
+
+// Straightforward models of each policy, for comparing hit sequences.
+class fifo_model
+{
+public:
+	explicit fifo_model(std::size_t capacity) : m_capacity{ capacity } {}
+
+	bool access(int key)
+	{
+		if (std::find(m_keys.begin(), m_keys.end(), key) != m_keys.end())
+			return true;
+		if (m_keys.size() == m_capacity)
+			m_keys.pop_front();
+		m_keys.push_back(key);
+		return false;
+	}
+
+private:
+	std::size_t m_capacity;
+	std::deque<int> m_keys;
+};
+
+class clock_model
+{
+public:
+	explicit clock_model(std::size_t capacity) : m_capacity{ capacity } {}
+
+	bool access(int key)
+	{
+		for (auto& e : m_entries) {
+			if (e.first == key) {
+				e.second = true;
+				return true;
+			}
+		}
+		if (m_entries.size() < m_capacity) {
+			m_entries.emplace_back(key, false);
+			return false;
+		}
+		while (m_entries[m_hand].second) {
+			m_entries[m_hand].second = false;
+			m_hand = (m_hand + 1) % m_capacity;
+		}
+		m_entries[m_hand] = { key, false };
+		m_hand = (m_hand + 1) % m_capacity;
+		return false;
+	}
+
+private:
+	std::size_t m_capacity;
+	std::vector<std::pair<int, bool>> m_entries;
+	std::size_t m_hand = 0;
+};
+
+// The SIEVE paper's pseudo-code: the list runs from head (newest, front)
+// to tail (oldest, back) and the hand moves from the tail towards the head.
+class sieve_model
+{
+public:
+	explicit sieve_model(std::size_t capacity) : m_capacity{ capacity } {}
+
+	bool access(int key)
+	{
+		for (auto& e : m_entries) {
+			if (e.first == key) {
+				e.second = true;
+				return true;
+			}
+		}
+		if (m_entries.size() == m_capacity) {
+			auto hand = m_hand_valid ? m_hand : std::prev(m_entries.end());
+			while (hand->second) {
+				hand->second = false;
+				hand = hand == m_entries.begin() ? std::prev(m_entries.end()) : std::prev(hand);
+			}
+			m_hand_valid = hand != m_entries.begin();
+			if (m_hand_valid)
+				m_hand = std::prev(hand);
+			m_entries.erase(hand);
+		}
+		m_entries.emplace_front(key, false);
+		return false;
+	}
+
+private:
+	std::size_t m_capacity;
+	std::list<std::pair<int, bool>> m_entries;
+	std::list<std::pair<int, bool>>::iterator m_hand;
+	bool m_hand_valid = false;
+};
+
+// Hashes everything into a handful of buckets, to exercise long probe runs
+// and backward-shift deletion.
+struct clumping_hash {
+	std::size_t operator()(int key) const { return static_cast<std::size_t>(key % 5); }
+};
+
+template <typename Policy, typename Model, typename Hash = std::hash<int>>
+void check_against_model(std::size_t capacity, int keys)
+{
+	ring_cache<int, int, Policy, Hash> cache(capacity);
+	Model model(capacity);
+	std::mt19937 rng(static_cast<unsigned>(capacity * 31 + keys));
+	// Skewed towards small keys, so that some entries are hit repeatedly.
+	std::geometric_distribution<int> skewed(4.0 / keys);
+	for (int step = 0; step < 20000; ++step) {
+		const int key = skewed(rng) % keys;
+		int* value = cache.find(key);
+		REQUIRE((value != nullptr) == model.access(key));
+		if (value)
+			REQUIRE(*value == key * 3);
+		else
+			REQUIRE(cache.insert(key, key * 3));
+		REQUIRE(cache.size() <= capacity);
+	}
+}
+
+} // namespace
+
+TEST_CASE("ring_cache basics", "[ring_cache]")
+{
+	ring_cache<std::string, int, fifo_eviction> cache(2);
+	CHECK(cache.capacity() == 2);
+	CHECK(cache.empty());
+	CHECK(cache.find("a") == nullptr);
+
+	CHECK(cache.insert("a", 1));
+	CHECK(cache.insert("b", 2));
+	CHECK_FALSE(cache.insert("a", 10));
+	REQUIRE(cache.find("a"));
+	CHECK(*cache.find("a") == 10);
+
+	// FIFO ignores hits: "a" is the oldest, so it goes first.
+	CHECK(cache.insert("c", 3));
+	CHECK(cache.size() == 2);
+	CHECK_FALSE(cache.contains("a"));
+	CHECK(cache.contains("b"));
+	CHECK(cache.contains("c"));
+
+	cache.clear();
+	CHECK(cache.empty());
+	CHECK_FALSE(cache.contains("b"));
+	CHECK(cache.insert("d", 4));
+	CHECK(*cache.find("d") == 4);
+
+	CHECK_THROWS_AS((ring_cache<int, int>(0)), std::invalid_argument);
+}
+
+TEST_CASE("ring_cache refills its slots after clear", "[ring_cache]")
+{
+	// The use count shows that every evicted or cleared entry was destroyed.
+	const auto tracked = std::make_shared<int>(0);
+	{
+		ring_cache<int, std::shared_ptr<int>, fifo_eviction> cache(4);
+		for (int i = 0; i < 3; ++i)
+			cache.insert(i, tracked);
+		cache.clear();
+		CHECK(tracked.use_count() == 1);
+
+		// Filling a partly used buffer again, and then evicting, must still
+		// find each key's entry in its slot.
+		for (int i = 10; i < 16; ++i)
+			CHECK(cache.insert(i, tracked));
+		CHECK(cache.size() == 4);
+		CHECK(tracked.use_count() == 5);
+		CHECK_FALSE(cache.contains(11));
+		for (int i = 12; i < 16; ++i)
+			CHECK(cache.find(i));
+		CHECK(cache.insert(16, std::make_shared<int>(16)));
+		CHECK(**cache.find(16) == 16);
+		CHECK_FALSE(cache.contains(12));
+		CHECK(tracked.use_count() == 4);
+	}
+	CHECK(tracked.use_count() == 1);
+}
+
+TEST_CASE("Inserting a value that refers to the entry being evicted", "[ring_cache]")
+{
+	// Long enough that the strings own heap memory.
+	ring_cache<std::string, std::string, fifo_eviction> cache(2);
+	cache.insert("a", std::string(64, 'a'));
+	cache.insert("b", std::string(64, 'b'));
+	// "a" is the victim, and also where the new value comes from.
+	CHECK(cache.insert("c", *cache.find("a")));
+	CHECK_FALSE(cache.contains("a"));
+	REQUIRE(cache.find("c"));
+	CHECK(*cache.find("c") == std::string(64, 'a'));
+
+	// Moving from it works too.
+	CHECK(cache.insert("d", std::move(*cache.find("b"))));
+	CHECK_FALSE(cache.contains("b"));
+	CHECK(*cache.find("d") == std::string(64, 'b'));
+}
+
+TEST_CASE("CLOCK and SIEVE keep entries that were hit", "[ring_cache]")
+{
+	ring_cache<int, int, clock_eviction> clock(3);
+	ring_cache<int, int, sieve_eviction> sieve(3);
+	for (int key = 1; key <= 3; ++key) {
+		clock.insert(key, key);
+		sieve.insert(key, key);
+	}
+	clock.find(1);
+	sieve.find(1);
+	clock.insert(4, 4);
+	sieve.insert(4, 4);
+	// 1 had a second chance, so 2 went instead.
+	CHECK(clock.contains(1));
+	CHECK_FALSE(clock.contains(2));
+	CHECK(sieve.contains(1));
+	CHECK_FALSE(sieve.contains(2));
+
+	// CLOCK puts 5 where the hand is, in 2's old place, and evicts 3 next.
+	// SIEVE puts new entries at the head, and its hand goes on to 3.
+	clock.insert(5, 5);
+	sieve.insert(5, 5);
+	CHECK_FALSE(clock.contains(3));
+	CHECK_FALSE(sieve.contains(3));
+
+	// SIEVE's hand carries on towards the head, to 4, rather than wrapping
+	// round to 1 (whose mark it cleared on the way past).
+	sieve.insert(6, 6);
+	CHECK_FALSE(sieve.contains(4));
+	CHECK(sieve.contains(1));
+	CHECK(sieve.contains(5));
+}
+
+TEST_CASE("ring_cache policies match reference models", "[ring_cache]")
+{
+	for (std::size_t capacity : { std::size_t{ 1 }, std::size_t{ 2 }, std::size_t{ 7 }, std::size_t{ 64 } }) {
+		check_against_model<fifo_eviction, fifo_model>(capacity, 200);
+		check_against_model<clock_eviction, clock_model>(capacity, 200);
+		check_against_model<sieve_eviction, sieve_model>(capacity, 200);
+		check_against_model<sieve_eviction, sieve_model, clumping_hash>(capacity, 100);
+		check_against_model<clock_eviction, clock_model, clumping_hash>(capacity, 100);
+	}
+}
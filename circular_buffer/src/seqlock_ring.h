@@ -0,0 +1,132 @@
+// seqlock_ring.h
+//
+// Single writer, many reader ring for "latest N" data where the writer must
+// never wait and losing old elements is fine. It has circular_buffer's
+// overwrite semantics: push_back always succeeds and, once the ring is full,
+// replaces the oldest element.
+//
+// Each slot carries a sequence number in the style of a seqlock. Writing
+// element n marks its slot odd (2n + 1), copies the value, then marks it
+// 2n + 2 with a release store. A reader checks the number before and after
+// copying and discards the copy if it changed, so readers never block the
+// writer and the writer uses plain stores only, no read-modify-write. A read
+// may race with the write that overwrites it; that copy is thrown away. The
+// values are kept in atomic_cells so that such a race is only a torn copy,
+// not a data race, which is why elements must be trivially copyable.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+#include "atomic_cell.h"
+#include "power_of_two.h"
+
+template <typename T>
+class seqlock_ring
+{
+	static_assert(std::is_trivially_copyable<T>::value, "seqlock_ring elements must be trivially copyable");
+
+public:
+	using value_type = T;
+	using size_type = std::size_t;
+	using sequence_type = std::uint64_t;
+
+	// capacity is rounded up to a power of two.
+	explicit seqlock_ring(std::size_t capacity)
+		: m_capacity{ power_of_two::round_up(capacity) },
+		m_mask{ m_capacity - 1 },
+		m_slots(new slot[m_capacity])
+	{}
+
+	seqlock_ring(const seqlock_ring&) = delete;
+	seqlock_ring& operator=(const seqlock_ring&) = delete;
+
+	size_type capacity() const { return m_capacity; }
+
+	// Writer side; only one thread may push.
+	void push_back(const value_type& value)
+	{
+		const sequence_type n = m_next;
+		slot& s = m_slots[n & m_mask];
+		s.seq.store(2 * n + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		s.value.store(value);
+		s.seq.store(2 * n + 2, std::memory_order_release);
+		m_next = n + 1;
+		m_written.store(m_next, std::memory_order_release);
+	}
+
+	// Number of elements pushed so far; element n (counting from 0) is
+	// available while n + capacity() >= written().
+	sequence_type written() const { return m_written.load(std::memory_order_acquire); }
+
+	// Copies element n into out. Returns false if it has not been written yet,
+	// has been overwritten, or was overwritten while being copied.
+	bool try_read(sequence_type n, value_type& out) const
+	{
+		const slot& s = m_slots[n & m_mask];
+		const sequence_type before = s.seq.load(std::memory_order_acquire);
+		if (before != 2 * n + 2)
+			return false;
+		s.value.load(out);
+		std::atomic_thread_fence(std::memory_order_acquire);
+		return s.seq.load(std::memory_order_relaxed) == before;
+	}
+
+	// Copies the newest element; false if nothing has been written. Retries
+	// if the writer laps the reader mid-copy.
+	bool latest(value_type& out) const
+	{
+		for (;;) {
+			const sequence_type written = this->written();
+			if (written == 0)
+				return false;
+			if (try_read(written - 1, out))
+				return true;
+		}
+	}
+
+	// Copies up to k of the newest elements into out, oldest first, and
+	// returns how many were copied. Every element is individually validated;
+	// if the writer overwrote the oldest ones during the copy, the snapshot is
+	// trimmed to the newest run that was read intact.
+	size_type snapshot(value_type* out, size_type k) const
+	{
+		const sequence_type written = this->written();
+		if (k > m_capacity)
+			k = m_capacity;
+		if (k > written)
+			k = static_cast<size_type>(written);
+
+		// Copy newest first, stopping at the first element lost to the writer:
+		// the writer overwrites oldest first, so everything older is gone too.
+		size_type copied = 0;
+		while (copied < k && try_read(written - 1 - copied, out[k - 1 - copied]))
+			++copied;
+		if (copied < k) {
+			for (size_type i = 0; i < copied; ++i)
+				out[i] = out[k - copied + i];
+		}
+		return copied;
+	}
+
+private:
+	struct slot {
+		std::atomic<sequence_type> seq{ 0 };
+		atomic_cell<value_type> value;
+	};
+
+	const std::size_t m_capacity;
+	const std::size_t m_mask;
+	std::unique_ptr<slot[]> m_slots;
+
+	// Writer-only copy of the element count, so the writer never reads back
+	// its own atomic.
+	sequence_type m_next = 0;
+	alignas(64) std::atomic<sequence_type> m_written{ 0 };
+};
@@ -0,0 +1,102 @@
+#include "catch.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "seqlock_ring.h"
+
+TEST_CASE("Reading back what was written", "[seqlock_ring]")
+{
+	seqlock_ring<int> ring(3);
+	REQUIRE(ring.capacity() == 4);
+	REQUIRE(ring.written() == 0);
+
+	int value = 0;
+	REQUIRE(!ring.latest(value));
+	REQUIRE(!ring.try_read(0, value));
+
+	ring.push_back(10);
+	ring.push_back(11);
+	REQUIRE(ring.written() == 2);
+	REQUIRE(ring.latest(value));
+	REQUIRE(value == 11);
+	REQUIRE(ring.try_read(0, value));
+	REQUIRE(value == 10);
+	REQUIRE(!ring.try_read(2, value));
+
+	for (int i = 12; i < 20; ++i)
+		ring.push_back(i);
+	// Elements 0..5 have been overwritten.
+	REQUIRE(!ring.try_read(0, value));
+	REQUIRE(!ring.try_read(5, value));
+	REQUIRE(ring.try_read(6, value));
+	REQUIRE(value == 16);
+}
+
+TEST_CASE("Snapshots of the newest elements", "[seqlock_ring]")
+{
+	seqlock_ring<int> ring(8);
+	int out[16] = {};
+	REQUIRE(ring.snapshot(out, 4) == 0);
+
+	ring.push_back(1);
+	ring.push_back(2);
+	REQUIRE(ring.snapshot(out, 4) == 2);
+	REQUIRE(out[0] == 1);
+	REQUIRE(out[1] == 2);
+
+	for (int i = 3; i <= 20; ++i)
+		ring.push_back(i);
+	REQUIRE(ring.snapshot(out, 3) == 3);
+	REQUIRE(out[0] == 18);
+	REQUIRE(out[2] == 20);
+
+	// Never more than the ring holds.
+	REQUIRE(ring.snapshot(out, 16) == 8);
+	REQUIRE(out[0] == 13);
+	REQUIRE(out[7] == 20);
+}
+
+TEST_CASE("Readers never see torn or stale data", "[seqlock_ring]")
+{
+	struct quote {
+		std::uint64_t seq;
+		std::uint64_t bid;
+		std::uint64_t ask;
+	};
+	constexpr std::uint64_t count = 300000;
+	seqlock_ring<quote> ring(8);
+	std::atomic<bool> done{ false };
+	std::atomic<bool> consistent{ true };
+
+	auto check = [](const quote& q) { return q.bid == q.seq * 3 && q.ask == q.seq * 3 + 1; };
+
+	std::vector<std::thread> readers;
+	for (int r = 0; r < 2; ++r) {
+		readers.emplace_back([&] {
+			quote snap[8];
+			std::uint64_t last_latest = 0;
+			while (!done.load(std::memory_order_acquire)) {
+				quote q{};
+				if (ring.latest(q)) {
+					if (!check(q) || q.seq < last_latest)
+						consistent = false;
+					last_latest = q.seq;
+				}
+				const std::size_t n = ring.snapshot(snap, 8);
+				for (std::size_t i = 0; i < n; ++i) {
+					if (!check(snap[i]) || (i > 0 && snap[i].seq != snap[i - 1].seq + 1))
+						consistent = false;
+				}
+			}
+		});
+	}
+	for (std::uint64_t i = 0; i < count; ++i)
+		ring.push_back(quote{ i, i * 3, i * 3 + 1 });
+	done = true;
+	for (auto& t : readers)
+		t.join();
+	REQUIRE(consistent);
+}
@@ -0,0 +1,173 @@
+// sharded_ring.h
+//
+// Many producer, one consumer collection of per-thread rings for high fan-in
+// streams such as diagnostics. Each producer thread attaches once and gets its
+// own spsc_ring shard, so pushing touches only cache lines that thread owns
+// plus the consumer's head index, and producers never contend with each other.
+//
+// Every element is stamped when pushed, by default with the steady clock.
+// drain() takes what each shard holds at that moment and hands it over merged
+// in stamp order (ties broken by shard), so a consumer sees one interleaved
+// stream. The order is exact within a shard; across shards it is exact among
+// the elements taken by one drain() call, but an element stamped just before
+// a drain and published just after it comes out in the next one.
+//
+// Shards are per thread rather than per CPU: a thread can be preempted or
+// migrated halfway through a push, so a per-CPU ring would need an atomic
+// read-modify-write (or restartable sequences) to stay single-producer.
+//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "spsc_ring.h"
+#include "wait_strategy.h"
+
+struct steady_clock_stamp {
+	std::uint64_t operator()() const
+	{
+		return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+	}
+};
+
+// Stamp is called concurrently from every producer thread. T must be default
+// constructible (the consumer stages drained elements in arrays of T).
+template <typename T, typename Stamp = steady_clock_stamp, typename Wait = spin_yield_wait>
+class sharded_ring
+{
+public:
+	using value_type = T;
+	using size_type = std::size_t;
+	using stamp_type = std::uint64_t;
+
+	struct entry {
+		stamp_type stamp;
+		value_type value;
+	};
+
+	class producer;
+
+	// Room for up to shards producers, each with a ring of capacity entries
+	// (rounded up to a power of two).
+	sharded_ring(std::size_t shards, std::size_t capacity, Stamp stamp = Stamp())
+		: m_stamp(std::move(stamp))
+	{
+		m_shards.reserve(shards);
+		for (std::size_t i = 0; i < shards; ++i)
+			m_shards.emplace_back(new shard(capacity));
+	}
+
+	sharded_ring(const sharded_ring&) = delete;
+	sharded_ring& operator=(const sharded_ring&) = delete;
+
+	size_type shard_count() const { return m_shards.size(); }
+
+	// Claims a free shard for the calling thread. Throws std::length_error
+	// when all shards are taken. A shard is released, with anything still in
+	// it, when its producer is destroyed.
+	producer attach()
+	{
+		for (auto& s : m_shards) {
+			bool expected = false;
+			if (s->attached.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+				return producer(this, s.get());
+		}
+		throw std::length_error("No free shard");
+	}
+
+	// Consumer side; one thread at a time. Calls f(const entry&) for every
+	// element available in any shard, in stamp order, and returns how many.
+	template <typename F>
+	size_type drain(F&& f)
+	{
+		using head = std::pair<stamp_type, std::size_t>;
+		std::priority_queue<head, std::vector<head>, std::greater<head>> heads;
+		for (std::size_t i = 0; i < m_shards.size(); ++i) {
+			shard& s = *m_shards[i];
+			s.first = 0;
+			s.last = s.ring.try_pop_n(s.staging.get(), s.ring.capacity());
+			if (s.last)
+				heads.emplace(s.staging[0].stamp, i);
+		}
+
+		size_type drained = 0;
+		while (!heads.empty()) {
+			const std::size_t i = heads.top().second;
+			heads.pop();
+			shard& s = *m_shards[i];
+			f(static_cast<const entry&>(s.staging[s.first]));
+			++drained;
+			if (++s.first < s.last)
+				heads.emplace(s.staging[s.first].stamp, i);
+		}
+		return drained;
+	}
+
+private:
+	struct shard {
+		explicit shard(std::size_t capacity)
+			: ring(capacity),
+			staging(new entry[ring.capacity()])
+		{}
+
+		spsc_ring<entry, Wait> ring;
+		alignas(64) std::atomic<bool> attached{ false };
+		// Consumer-only: elements taken by the current drain().
+		std::unique_ptr<entry[]> staging;
+		std::size_t first = 0;
+		std::size_t last = 0;
+	};
+
+	Stamp m_stamp;
+	std::vector<std::unique_ptr<shard>> m_shards;
+};
+
+// Used from the one thread that attached it.
+template <typename T, typename Stamp, typename Wait>
+class sharded_ring<T, Stamp, Wait>::producer
+{
+public:
+	producer(producer&& other) noexcept
+		: m_ring{ other.m_ring }, m_shard{ other.m_shard }
+	{
+		other.m_shard = nullptr;
+	}
+
+	producer& operator=(producer&&) = delete;
+	producer(const producer&) = delete;
+	producer& operator=(const producer&) = delete;
+
+	~producer()
+	{
+		if (m_shard)
+			m_shard->attached.store(false, std::memory_order_release);
+	}
+
+	// Returns false, dropping value, if this thread's shard is full.
+	bool try_push(const value_type& value) { return m_shard->ring.try_emplace(entry{ m_ring->m_stamp(), value }); }
+	bool try_push(value_type&& value) { return m_shard->ring.try_emplace(entry{ m_ring->m_stamp(), std::move(value) }); }
+
+	// Waits while this thread's shard is full. The stamp is taken before
+	// waiting.
+	void push(const value_type& value) { m_shard->ring.push(entry{ m_ring->m_stamp(), value }); }
+
+private:
+	friend class sharded_ring<T, Stamp, Wait>;
+
+	producer(sharded_ring* ring, shard* s)
+		: m_ring{ ring }, m_shard{ s }
+	{}
+
+	sharded_ring* m_ring;
+	shard* m_shard;
+};
@@ -0,0 +1,93 @@
+#include "catch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "circular_buffer.h"
+#include "sharded_ring.h"
+
+namespace {
+
+struct record {
+	std::uint32_t thread;
+	std::uint32_t seq;
+	std::uint64_t payload[3];
+};
+
+constexpr std::uint32_t per_producer = 1 << 18;
+
+// Runs `producers` threads through push(thread, seq) while the calling
+// thread drains, and reports the producer-side cost per record.
+template <typename Push, typename Drain>
+void measure(const char* name, unsigned producers, Push push, Drain drain)
+{
+	std::atomic<unsigned> finished{ 0 };
+	std::atomic<std::int64_t> producer_ns{ 0 };
+	std::vector<std::thread> threads;
+	for (unsigned t = 0; t < producers; ++t) {
+		threads.emplace_back([&, t] {
+			const auto start = std::chrono::steady_clock::now();
+			push(t);
+			producer_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+			finished.fetch_add(1, std::memory_order_release);
+		});
+	}
+	std::uint64_t received = 0;
+	while (finished.load(std::memory_order_acquire) < producers)
+		received += drain();
+	received += drain();
+	for (auto& t : threads)
+		t.join();
+
+	std::printf("%-32s %2u producers  %7.1f ns/push  (kept %llu of %llu)\n", name, producers,
+		static_cast<double>(producer_ns.load()) / (static_cast<double>(producers) * per_producer),
+		static_cast<unsigned long long>(received), static_cast<unsigned long long>(producers) * per_producer);
+}
+
+} // namespace
+
+TEST_CASE("sharded_ring against a shared circular_buffer behind a mutex", "[.][benchmark][sharded_ring]")
+{
+	const unsigned cores = std::max(2u, std::thread::hardware_concurrency());
+	for (unsigned producers = 1;; producers = std::min(producers * 2, cores)) {
+		{
+			// What we had: every thread pushes into one lossy circular_buffer
+			// and the consumer takes them under the same lock.
+			std::mutex mutex;
+			circular_buffer<record> shared(4096);
+			measure("mutex + circular_buffer", producers,
+				[&](unsigned t) {
+					for (std::uint32_t i = 0; i < per_producer; ++i) {
+						std::lock_guard<std::mutex> lock(mutex);
+						shared.push_back(record{ t, i, {} });
+					}
+				},
+				[&] {
+					std::uint64_t n = 0;
+					std::lock_guard<std::mutex> lock(mutex);
+					for (; !shared.empty(); ++n)
+						shared.pop_front();
+					return n;
+				});
+		}
+		{
+			sharded_ring<record> ring(producers, 4096);
+			measure("sharded_ring", producers,
+				[&](unsigned t) {
+					auto p = ring.attach();
+					for (std::uint32_t i = 0; i < per_producer; ++i)
+						p.try_push(record{ t, i, {} });
+				},
+				[&] { return ring.drain([](const sharded_ring<record>::entry&) {}); });
+		}
+		if (producers == cores)
+			break;
+	}
+	SUCCEED();
+}
@@ -0,0 +1,113 @@
+#include "catch.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sharded_ring.h"
+
+namespace {
+
+// A global sequence number instead of a clock, so that the merge order is
+// deterministic.
+struct counter_stamp {
+	std::atomic<std::uint64_t>* next;
+	std::uint64_t operator()() const { return next->fetch_add(1, std::memory_order_relaxed); }
+};
+
+} // namespace
+
+TEST_CASE("Drain merges shards in stamp order", "[sharded_ring]")
+{
+	std::atomic<std::uint64_t> next{ 0 };
+	sharded_ring<std::string, counter_stamp> ring(2, 4, counter_stamp{ &next });
+	REQUIRE(ring.shard_count() == 2);
+
+	auto a = ring.attach();
+	auto b = ring.attach();
+	REQUIRE_THROWS_AS(ring.attach(), std::length_error);
+
+	REQUIRE(a.try_push("a0"));
+	REQUIRE(b.try_push("b1"));
+	REQUIRE(b.try_push("b2"));
+	REQUIRE(a.try_push("a3"));
+
+	std::vector<std::string> seen;
+	std::vector<std::uint64_t> stamps;
+	auto collect = [&](const sharded_ring<std::string, counter_stamp>::entry& e) {
+		seen.push_back(e.value);
+		stamps.push_back(e.stamp);
+	};
+	REQUIRE(ring.drain(collect) == 4);
+	REQUIRE(seen == std::vector<std::string>{ "a0", "b1", "b2", "a3" });
+	REQUIRE(stamps == std::vector<std::uint64_t>{ 0, 1, 2, 3 });
+	REQUIRE(ring.drain(collect) == 0);
+
+	// A full shard drops without affecting the other.
+	for (int i = 0; i < 4; ++i)
+		REQUIRE(a.try_push("a"));
+	REQUIRE(!a.try_push("dropped"));
+	REQUIRE(b.try_push("b"));
+	REQUIRE(ring.drain(collect) == 5);
+}
+
+TEST_CASE("Shards are released by their producers", "[sharded_ring]")
+{
+	sharded_ring<int> ring(1, 8);
+	{
+		auto p = ring.attach();
+		REQUIRE(p.try_push(1));
+	}
+	auto q = ring.attach();
+	REQUIRE(q.try_push(2));
+
+	std::vector<int> seen;
+	ring.drain([&](const sharded_ring<int>::entry& e) { seen.push_back(e.value); });
+	REQUIRE(seen == std::vector<int>{ 1, 2 });
+}
+
+TEST_CASE("Concurrent producers with a draining consumer", "[sharded_ring]")
+{
+	constexpr int producers = 4;
+	constexpr std::uint32_t per_producer = 20000;
+	struct message {
+		std::uint32_t thread;
+		std::uint32_t seq;
+	};
+	std::atomic<std::uint64_t> next{ 0 };
+	sharded_ring<message, counter_stamp> ring(producers, 256, counter_stamp{ &next });
+
+	std::vector<std::thread> threads;
+	for (int t = 0; t < producers; ++t) {
+		threads.emplace_back([&, t] {
+			auto p = ring.attach();
+			for (std::uint32_t i = 0; i < per_producer; ++i)
+				p.push(message{ static_cast<std::uint32_t>(t), i });
+		});
+	}
+
+	std::vector<std::uint32_t> expected(producers, 0);
+	bool ordered = true;
+	std::uint64_t total = 0;
+	while (total < producers * per_producer) {
+		std::uint64_t last_stamp = 0;
+		bool first = true;
+		const std::size_t drained = ring.drain([&](const sharded_ring<message, counter_stamp>::entry& e) {
+			ordered = ordered && e.value.seq == expected[e.value.thread]++;
+			ordered = ordered && (first || e.stamp > last_stamp);
+			last_stamp = e.stamp;
+			first = false;
+		});
+		if (drained == 0)
+			std::this_thread::yield();
+		total += drained;
+	}
+	for (auto& t : threads)
+		t.join();
+
+	REQUIRE(ordered);
+	for (auto e : expected)
+		REQUIRE(e == per_producer);
+}
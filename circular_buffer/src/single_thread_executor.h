@@ -0,0 +1,103 @@
+// single_thread_executor.h
+//
+// Minimal C++20 coroutine runtime for driving async_channel: a FIFO run queue
+// of coroutine handles drained on the calling thread, and a fire-and-forget
+// task type to start coroutines on it.
+//
+//   single_thread_executor ex;
+//   ex.spawn(producer(channel));
+//   ex.spawn(consumer(channel));
+//   ex.run();
+//
+// Nothing here is thread-safe; everything runs on the thread calling run().
+//
+
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <utility>
+
+// Return type of a coroutine to be handed to single_thread_executor::spawn().
+// It starts suspended, and its frame frees itself when the body finishes.
+class task
+{
+public:
+	struct promise_type {
+		task get_return_object() { return task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+		std::suspend_always initial_suspend() noexcept { return {}; }
+		std::suspend_never final_suspend() noexcept { return {}; }
+		void return_void() {}
+		void unhandled_exception() { std::terminate(); }
+	};
+
+	task(task&& other) noexcept
+		: m_handle{ std::exchange(other.m_handle, nullptr) }
+	{}
+
+	task(const task&) = delete;
+	task& operator=(const task&) = delete;
+	task& operator=(task&&) = delete;
+
+	// A task that was never spawned has not started, so it is safe to free.
+	~task()
+	{
+		if (m_handle)
+			m_handle.destroy();
+	}
+
+private:
+	friend class single_thread_executor;
+
+	explicit task(std::coroutine_handle<promise_type> handle)
+		: m_handle{ handle }
+	{}
+
+	std::coroutine_handle<promise_type> m_handle;
+};
+
+class single_thread_executor
+{
+public:
+	single_thread_executor() = default;
+	single_thread_executor(const single_thread_executor&) = delete;
+	single_thread_executor& operator=(const single_thread_executor&) = delete;
+
+	// Queues a suspended coroutine to be resumed by run().
+	void schedule(std::coroutine_handle<> handle) { m_ready.push_back(handle); }
+
+	void spawn(task&& t) { schedule(std::exchange(t.m_handle, nullptr)); }
+
+	// Resumes queued coroutines, including any they schedule, until the queue
+	// is empty. Returns the number of resumptions. Coroutines still suspended
+	// on something that nobody will schedule are left as they are.
+	std::size_t run()
+	{
+		std::size_t resumed = 0;
+		while (!m_ready.empty()) {
+			const std::coroutine_handle<> next = m_ready.front();
+			m_ready.pop_front();
+			next.resume();
+			++resumed;
+		}
+		return resumed;
+	}
+
+	// Awaiting this reschedules the current coroutine behind everything
+	// already queued.
+	auto yield()
+	{
+		struct awaiter {
+			single_thread_executor& ex;
+			bool await_ready() const noexcept { return false; }
+			void await_suspend(std::coroutine_handle<> handle) { ex.schedule(handle); }
+			void await_resume() const noexcept {}
+		};
+		return awaiter{ *this };
+	}
+
+private:
+	std::deque<std::coroutine_handle<>> m_ready;
+};
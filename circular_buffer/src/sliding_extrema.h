@@ -0,0 +1,117 @@
+// sliding_extrema.h
+//
+// Rolling minimum and maximum over the last N values. Alongside the data ring
+// sit two monotonic rings of sequence numbers: the min ring holds the
+// candidates for min() in increasing order and the max ring the candidates for
+// max() in decreasing order. Each value is appended to and removed from each
+// ring at most once, so push_back is amortized O(1) and both queries are O(1).
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#include "circular_buffer.h"
+
+template <typename T, typename Compare = std::less<T>, typename A = std::allocator<T>>
+class sliding_extrema
+{
+public:
+	using window_type = circular_buffer<T, A>;
+	using value_type = T;
+	using size_type = typename window_type::size_type;
+	using value_compare = Compare;
+
+	explicit sliding_extrema(std::size_t window, const Compare& compare = Compare(), const A& allocator = A())
+		: m_window(window, allocator),
+		m_min(window),
+		m_max(window),
+		m_compare(compare)
+	{}
+
+	// Same overwrite semantics as circular_buffer::push_back: when the window
+	// is full the oldest value is evicted and false is returned.
+	bool push_back(const value_type& value)
+	{
+		if (full())
+			retire_front();
+
+		// Candidates that can never again be the extreme are dropped: anything
+		// not smaller than value for the min ring, not larger for the max ring.
+		while (!m_min.empty() && !m_compare(at_sequence(m_min.back()), value))
+			m_min.pop_back();
+		while (!m_max.empty() && !m_compare(value, at_sequence(m_max.back())))
+			m_max.pop_back();
+
+		const bool kept_all = m_window.push_back(value);
+		const std::uint64_t seq = m_next++;
+		m_min.push_back(seq);
+		m_max.push_back(seq);
+		return kept_all;
+	}
+
+	void pop_front()
+	{
+		assert(!empty());
+		retire_front();
+		m_window.pop_front();
+	}
+
+	void clear()
+	{
+		m_window.clear();
+		m_min.clear();
+		m_max.clear();
+	}
+
+	size_type size() const { return m_window.size(); }
+	size_type capacity() const { return m_window.capacity(); }
+	bool empty() const { return m_window.empty(); }
+	bool full() const { return m_window.size() == m_window.capacity(); }
+
+	// The values themselves, oldest first.
+	const window_type& window() const { return m_window; }
+
+	// Smallest and largest value in the window according to Compare. Like
+	// front(), these require a non-empty window.
+	const value_type& min() const
+	{
+		assert(!empty());
+		return at_sequence(m_min.front());
+	}
+
+	const value_type& max() const
+	{
+		assert(!empty());
+		return at_sequence(m_max.front());
+	}
+
+private:
+	// Sequence number of the oldest value in the window.
+	std::uint64_t first_sequence() const { return m_next - m_window.size(); }
+
+	const value_type& at_sequence(std::uint64_t seq) const
+	{
+		return m_window[static_cast<std::size_t>(seq - first_sequence())];
+	}
+
+	// Drops the oldest value from the candidate rings; the caller removes it
+	// from m_window.
+	void retire_front()
+	{
+		const std::uint64_t oldest = first_sequence();
+		if (m_min.front() == oldest)
+			m_min.pop_front();
+		if (m_max.front() == oldest)
+			m_max.pop_front();
+	}
+
+	window_type m_window;
+	circular_buffer<std::uint64_t> m_min;
+	circular_buffer<std::uint64_t> m_max;
+	Compare m_compare;
+	// Sequence number the next pushed value will get.
+	std::uint64_t m_next = 0;
+};
@@ -0,0 +1,67 @@
+#include "catch.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "sliding_extrema.h"
+
+namespace {
+
+std::vector<double> random_prices(std::size_t n)
+{
+	std::mt19937_64 rng(7);
+	std::normal_distribution<double> step(0.0, 1.0);
+	std::vector<double> prices(n);
+	double price = 100.0;
+	for (auto& p : prices) {
+		price += step(rng);
+		p = price;
+	}
+	return prices;
+}
+
+} // namespace
+
+TEST_CASE("Sliding extrema against rescanning", "[.][benchmark][sliding_extrema]")
+{
+	const auto prices = random_prices(1 << 16);
+
+	for (std::size_t window : { 64u, 1024u, 16384u, 262144u, 1048576u }) {
+		// Fill the window first so every measured push evicts.
+		sliding_extrema<double> se(window);
+		circular_buffer<double> cb(window);
+		for (std::size_t i = 0; i < window; ++i) {
+			se.push_back(prices[i % prices.size()]);
+			cb.push_back(prices[i % prices.size()]);
+		}
+
+		// Rescanning is O(window) per push, so it gets fewer pushes.
+		const std::size_t fast_pushes = prices.size();
+		const std::size_t slow_pushes = std::max<std::size_t>(16, (1 << 24) / window);
+		double sink = 0.0;
+
+		BENCHMARK("sliding_extrema, window " + std::to_string(window) + ", " + std::to_string(fast_pushes) + " pushes") {
+			for (std::size_t i = 0; i < fast_pushes; ++i) {
+				se.push_back(prices[i]);
+				sink += se.max() - se.min();
+			}
+		}
+
+		BENCHMARK("rescan, window " + std::to_string(window) + ", " + std::to_string(slow_pushes) + " pushes") {
+			for (std::size_t i = 0; i < slow_pushes; ++i) {
+				cb.push_back(prices[i % prices.size()]);
+				double lo = cb.front(), hi = cb.front();
+				for (double p : cb) {
+					lo = std::min(lo, p);
+					hi = std::max(hi, p);
+				}
+				sink += hi - lo;
+			}
+		}
+
+		REQUIRE(sink != 0.0);
+	}
+}
@@ -0,0 +1,79 @@
+#include "catch.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <random>
+
+#include "sliding_extrema.h"
+
+TEST_CASE("Extrema of a small window", "[sliding_extrema]")
+{
+	sliding_extrema<int> se(3);
+	REQUIRE(se.empty());
+
+	se.push_back(5);
+	REQUIRE(se.min() == 5);
+	REQUIRE(se.max() == 5);
+
+	se.push_back(1);
+	se.push_back(3);
+	REQUIRE(se.full());
+	REQUIRE(se.min() == 1);
+	REQUIRE(se.max() == 5);
+
+	REQUIRE(!se.push_back(2));
+	REQUIRE(se.window().front() == 1);
+	REQUIRE(se.min() == 1);
+	REQUIRE(se.max() == 3);
+
+	se.push_back(2);
+	REQUIRE(se.min() == 2);
+	REQUIRE(se.max() == 3);
+
+	se.pop_front();
+	REQUIRE(se.size() == 2);
+	REQUIRE(se.min() == 2);
+	REQUIRE(se.max() == 2);
+
+	se.clear();
+	REQUIRE(se.empty());
+	se.push_back(9);
+	REQUIRE(se.min() == 9);
+	REQUIRE(se.max() == 9);
+}
+
+TEST_CASE("Custom comparison reverses the extrema", "[sliding_extrema]")
+{
+	sliding_extrema<int, std::greater<int>> se(4);
+	for (int v : { 4, 8, 2, 6 })
+		se.push_back(v);
+	REQUIRE(se.min() == 8);
+	REQUIRE(se.max() == 2);
+}
+
+TEST_CASE("Extrema agree with rescanning the window", "[sliding_extrema]")
+{
+	std::mt19937 rng(42);
+	for (std::size_t window : { 1u, 2u, 7u, 64u }) {
+		sliding_extrema<int> se(window);
+		std::deque<int> reference;
+		std::uniform_int_distribution<int> values(-20, 20);
+		for (int i = 0; i < 5000; ++i) {
+			const int v = values(rng);
+			se.push_back(v);
+			reference.push_back(v);
+			if (reference.size() > window)
+				reference.pop_front();
+			if (i % 11 == 0 && !reference.empty()) {
+				se.pop_front();
+				reference.pop_front();
+			}
+			REQUIRE(se.size() == reference.size());
+			if (!reference.empty()) {
+				REQUIRE(se.min() == *std::min_element(reference.begin(), reference.end()));
+				REQUIRE(se.max() == *std::max_element(reference.begin(), reference.end()));
+			}
+		}
+	}
+}
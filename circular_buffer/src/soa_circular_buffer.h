@@ -0,0 +1,316 @@
+// soa_circular_buffer.h
+//
+// circular_buffer for multi-field records stored as a structure of arrays:
+// one contiguous ring per field, all sharing the same front and size. A scan
+// over one field then streams through just that field's memory instead of
+// dragging every whole record through the cache.
+//
+// Like circular_buffer, push_back overwrites the oldest record when full and
+// returns false when it does. Each field's contents are exposed as at most
+// two contiguous runs, array_one<I>() and array_two<I>(), for column scans.
+// Whole records are accessed through proxy references, tuples of references
+// to the fields:
+//
+//   soa_circular_buffer<std::int64_t, double, std::uint32_t> ticks(1024);
+//   ticks.push_back(time, price, volume);
+//   double p = ticks.get<1>(0);
+//   std::get<1>(ticks[0]) = 2.5;
+//   auto [t, p, v] = ticks.back();
+//
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+template <typename... Fields>
+class soa_circular_buffer
+{
+	static_assert(sizeof...(Fields) > 0, "soa_circular_buffer needs at least one field");
+
+public:
+	using value_type = std::tuple<Fields...>;
+	using reference = std::tuple<Fields&...>;
+	using const_reference = std::tuple<const Fields&...>;
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
+
+	template <std::size_t I>
+	using field_type = typename std::tuple_element<I, value_type>::type;
+
+	// A contiguous run of one field: (first element, count).
+	template <std::size_t I>
+	using array_range = std::pair<field_type<I>*, size_type>;
+	template <std::size_t I>
+	using const_array_range = std::pair<const field_type<I>*, size_type>;
+
+	template <bool Const>
+	class basic_iterator;
+	using iterator = basic_iterator<false>;
+	using const_iterator = basic_iterator<true>;
+
+	explicit soa_circular_buffer(std::size_t capacity)
+		: m_capacity{ capacity }
+	{
+		allocate(indices());
+	}
+
+	~soa_circular_buffer()
+	{
+		clear();
+		deallocate(indices());
+	}
+
+	soa_circular_buffer(const soa_circular_buffer&) = delete;
+	soa_circular_buffer& operator=(const soa_circular_buffer&) = delete;
+
+	size_type capacity() const { return m_capacity; }
+	size_type size() const { return m_size; }
+	bool empty() const { return m_size == 0; }
+	bool full() const { return m_size == m_capacity; }
+
+	// Returns false if the buffer was full and the oldest record was
+	// overwritten. If copying a field throws, the fields already copied are
+	// destroyed again and the buffer is left without the new record (and,
+	// when it was full, without the oldest one).
+	bool push_back(const Fields&... fields)
+	{
+		assert(m_capacity > 0);
+		const bool overwrite = m_size == m_capacity;
+		if (overwrite)
+			pop_front();
+		construct(physical(m_size), indices(), fields...);
+		++m_size;
+		return !overwrite;
+	}
+
+	bool push_back(const value_type& record)
+	{
+		return std::apply([this](const Fields&... fields) { return push_back(fields...); }, record);
+	}
+
+	void pop_front()
+	{
+		assert(m_size);
+		destroy(m_first, indices());
+		m_first = next(m_first);
+		--m_size;
+	}
+
+	void pop_back()
+	{
+		assert(m_size);
+		destroy(physical(m_size - 1), indices());
+		--m_size;
+	}
+
+	void clear()
+	{
+		while (m_size)
+			pop_back();
+		m_first = 0;
+	}
+
+	// One field of the record at index.
+	template <std::size_t I>
+	field_type<I>& get(std::size_t index)
+	{
+		return column<I>()[physical(index)];
+	}
+
+	template <std::size_t I>
+	const field_type<I>& get(std::size_t index) const
+	{
+		return column<I>()[physical(index)];
+	}
+
+	reference operator[](std::size_t index) { return row(physical(index), indices()); }
+	const_reference operator[](std::size_t index) const { return row(physical(index), indices()); }
+
+	reference at(std::size_t index)
+	{
+		if (index >= m_size)
+			throw std::out_of_range("Index out of range");
+		return (*this)[index];
+	}
+
+	const_reference at(std::size_t index) const
+	{
+		if (index >= m_size)
+			throw std::out_of_range("Index out of range");
+		return (*this)[index];
+	}
+
+	reference front() { assert(m_size); return (*this)[0]; }
+	const_reference front() const { assert(m_size); return (*this)[0]; }
+	reference back() { assert(m_size); return (*this)[m_size - 1]; }
+	const_reference back() const { assert(m_size); return (*this)[m_size - 1]; }
+
+	iterator begin() { return iterator(this, 0); }
+	iterator end() { return iterator(this, m_size); }
+	const_iterator begin() const { return const_iterator(this, 0); }
+	const_iterator end() const { return const_iterator(this, m_size); }
+
+	// Field I of the records from front() on, as in circular_buffer: the
+	// contents of each field occupy at most two contiguous runs, and
+	// array_two<I>() is empty when the contents do not wrap.
+	template <std::size_t I>
+	array_range<I> array_one()
+	{
+		return array_range<I>(column<I>() + (m_size ? m_first : 0), first_run());
+	}
+
+	template <std::size_t I>
+	const_array_range<I> array_one() const
+	{
+		return const_array_range<I>(column<I>() + (m_size ? m_first : 0), first_run());
+	}
+
+	template <std::size_t I>
+	array_range<I> array_two()
+	{
+		return array_range<I>(column<I>(), m_size - first_run());
+	}
+
+	template <std::size_t I>
+	const_array_range<I> array_two() const
+	{
+		return const_array_range<I>(column<I>(), m_size - first_run());
+	}
+
+private:
+	using indices = std::index_sequence_for<Fields...>;
+
+	template <std::size_t I>
+	field_type<I>* column() const { return std::get<I>(m_columns); }
+
+	std::size_t physical(std::size_t index) const
+	{
+		assert(index < m_capacity);
+		const std::size_t slot = m_first + index;
+		return slot >= m_capacity ? slot - m_capacity : slot;
+	}
+
+	std::size_t next(std::size_t slot) const
+	{
+		return slot + 1 == m_capacity ? 0 : slot + 1;
+	}
+
+	size_type first_run() const
+	{
+		const size_type to_end = m_capacity - m_first;
+		return m_size < to_end ? m_size : to_end;
+	}
+
+	template <std::size_t... I>
+	void allocate(std::index_sequence<I...>)
+	{
+		std::size_t allocated = 0;
+		try {
+			((std::get<I>(m_columns) = std::allocator<field_type<I>>().allocate(m_capacity), ++allocated), ...);
+		}
+		catch (...) {
+			((I < allocated ? std::allocator<field_type<I>>().deallocate(std::get<I>(m_columns), m_capacity) : void()), ...);
+			throw;
+		}
+	}
+
+	template <std::size_t... I>
+	void deallocate(std::index_sequence<I...>)
+	{
+		(std::allocator<field_type<I>>().deallocate(std::get<I>(m_columns), m_capacity), ...);
+	}
+
+	// Either every field of slot is constructed, or none is.
+	template <std::size_t... I>
+	void construct(std::size_t slot, std::index_sequence<I...>, const Fields&... fields)
+	{
+		std::size_t constructed = 0;
+		try {
+			((::new (static_cast<void*>(column<I>() + slot)) field_type<I>(fields), ++constructed), ...);
+		}
+		catch (...) {
+			destroy(slot, constructed, indices());
+			throw;
+		}
+	}
+
+	// Destroys the first n fields of slot.
+	template <std::size_t... I>
+	void destroy(std::size_t slot, std::size_t n, std::index_sequence<I...>)
+	{
+		((I < n ? std::destroy_at(column<I>() + slot) : void()), ...);
+	}
+
+	template <std::size_t... I>
+	void destroy(std::size_t slot, std::index_sequence<I...>)
+	{
+		(std::destroy_at(column<I>() + slot), ...);
+	}
+
+	template <std::size_t... I>
+	reference row(std::size_t slot, std::index_sequence<I...>)
+	{
+		return reference(column<I>()[slot]...);
+	}
+
+	template <std::size_t... I>
+	const_reference row(std::size_t slot, std::index_sequence<I...>) const
+	{
+		return const_reference(column<I>()[slot]...);
+	}
+
+	const size_type m_capacity;
+	std::tuple<Fields*...> m_columns;
+	// Slot of front() in every column, and the number of records.
+	size_type m_first = 0;
+	size_type m_size = 0;
+};
+
+// Dereferences to a proxy (reference or const_reference) by value, so it is
+// an input iterator in standard terms; use auto&& or structured bindings in
+// range-for loops.
+template <typename... Fields>
+template <bool Const>
+class soa_circular_buffer<Fields...>::basic_iterator
+{
+public:
+	using owner_type = typename std::conditional<Const, const soa_circular_buffer, soa_circular_buffer>::type;
+	using iterator_category = std::input_iterator_tag;
+	using value_type = typename soa_circular_buffer::value_type;
+	using difference_type = std::ptrdiff_t;
+	using reference = typename std::conditional<Const, const_reference, typename soa_circular_buffer::reference>::type;
+	using pointer = void;
+
+	basic_iterator(owner_type* owner, std::size_t index)
+		: m_owner{ owner }, m_index{ index }
+	{}
+
+	reference operator*() const { return (*m_owner)[m_index]; }
+
+	basic_iterator& operator++()
+	{
+		++m_index;
+		return *this;
+	}
+
+	basic_iterator operator++(int)
+	{
+		basic_iterator old = *this;
+		++m_index;
+		return old;
+	}
+
+	bool operator==(const basic_iterator& other) const { return m_index == other.m_index && m_owner == other.m_owner; }
+	bool operator!=(const basic_iterator& other) const { return !(*this == other); }
+
+private:
+	owner_type* m_owner;
+	std::size_t m_index;
+};
@@ -0,0 +1,71 @@
+#include "catch.hpp"
+
+#include <cstdint>
+#include <vector>
+
+#include "circular_buffer.h"
+#include "soa_circular_buffer.h"
+
+namespace {
+
+// About eight fields, as in a market data tick.
+struct tick {
+	std::int64_t time;
+	double bid;
+	double ask;
+	double price;
+	std::uint32_t volume;
+	std::uint32_t flags;
+	std::int64_t sequence;
+	std::int64_t venue;
+};
+
+} // namespace
+
+TEST_CASE("Column scan over a structure of arrays against an array of structures", "[.][benchmark][soa_circular_buffer]")
+{
+	const std::size_t n = 1 << 20;
+	circular_buffer<tick> aos(n);
+	soa_circular_buffer<std::int64_t, double, double, double, std::uint32_t, std::uint32_t, std::int64_t, std::int64_t> soa(n);
+	// Overfill by a third so that both wrap.
+	for (std::size_t i = 0; i < n + n / 3; ++i) {
+		const double p = 100.0 + static_cast<double>(i % 1000) * 0.01;
+		const auto t = static_cast<std::int64_t>(i);
+		aos.push_back(tick{ t, p - 0.01, p + 0.01, p, 100, 0, t, 1 });
+		soa.push_back(t, p - 0.01, p + 0.01, p, 100u, 0u, t, std::int64_t{ 1 });
+	}
+
+	// The bound to aim for: the same prices in a single plain array.
+	std::vector<double> prices(n);
+	for (std::size_t i = 0; i < n; ++i)
+		prices[i] = soa.get<3>(i);
+
+	double sink = 0;
+	BENCHMARK("std::vector<double>, sum") {
+		double sum = 0;
+		for (double p : prices)
+			sum += p;
+		sink += sum;
+	}
+	BENCHMARK("circular_buffer<tick>, sum of prices") {
+		double sum = 0;
+		for (auto range : { aos.array_one(), aos.array_two() })
+			for (std::size_t i = 0; i < range.second; ++i)
+				sum += range.first[i].price;
+		sink += sum;
+	}
+	BENCHMARK("soa_circular_buffer, sum of prices") {
+		double sum = 0;
+		for (auto range : { soa.array_one<3>(), soa.array_two<3>() })
+			for (std::size_t i = 0; i < range.second; ++i)
+				sum += range.first[i];
+		sink += sum;
+	}
+	BENCHMARK("soa_circular_buffer, sum of prices by index") {
+		double sum = 0;
+		for (std::size_t i = 0; i < soa.size(); ++i)
+			sum += soa.get<3>(i);
+		sink += sum;
+	}
+	CHECK(sink != 0);
+}
@@ -0,0 +1,178 @@
+#include "catch.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+
+#include "soa_circular_buffer.h"
+
+namespace {
+
+template <std::size_t I, typename Buffer>
+double column_sum(const Buffer& b)
+{
+	double sum = 0;
+	for (auto range : { b.template array_one<I>(), b.template array_two<I>() })
+		sum = std::accumulate(range.first, range.first + range.second, sum);
+	return sum;
+}
+
+} // namespace
+
+TEST_CASE("Pushing, overwriting and popping records", "[soa_circular_buffer]")
+{
+	soa_circular_buffer<int, double, char> cb(3);
+	REQUIRE(cb.empty());
+	REQUIRE(cb.capacity() == 3);
+
+	REQUIRE(cb.push_back(1, 1.5, 'a'));
+	REQUIRE(cb.push_back(std::make_tuple(2, 2.5, 'b')));
+	REQUIRE(cb.push_back(3, 3.5, 'c'));
+	REQUIRE(cb.full());
+	REQUIRE(!cb.push_back(4, 4.5, 'd'));
+	REQUIRE(cb.size() == 3);
+
+	REQUIRE(cb.get<0>(0) == 2);
+	REQUIRE(cb.get<1>(2) == 4.5);
+	REQUIRE(cb.front() == std::make_tuple(2, 2.5, 'b'));
+	REQUIRE(std::get<2>(cb.back()) == 'd');
+	REQUIRE_THROWS_AS(cb.at(3), std::out_of_range);
+
+	cb.pop_front();
+	REQUIRE(cb.get<0>(0) == 3);
+	cb.pop_back();
+	REQUIRE(cb.size() == 1);
+	REQUIRE(cb.back() == std::make_tuple(3, 3.5, 'c'));
+	cb.clear();
+	REQUIRE(cb.empty());
+}
+
+TEST_CASE("Proxy references write through to the columns", "[soa_circular_buffer]")
+{
+	soa_circular_buffer<int, double> cb(4);
+	cb.push_back(1, 1.0);
+	cb.push_back(2, 2.0);
+
+	std::get<1>(cb[0]) = 10.0;
+	cb[1] = std::make_tuple(20, 20.0);
+	REQUIRE(cb.get<1>(0) == 10.0);
+	REQUIRE(cb.get<0>(1) == 20);
+
+	auto [i, d] = cb.back();
+	d = 30.0;
+	REQUIRE(i == 20);
+	REQUIRE(cb.get<1>(1) == 30.0);
+
+	int count = 0;
+	for (auto&& row : cb) {
+		std::get<0>(row) += 100;
+		++count;
+	}
+	REQUIRE(count == 2);
+	REQUIRE(cb.get<0>(0) == 101);
+
+	const auto& ccb = cb;
+	double total = 0;
+	for (auto&& row : ccb)
+		total += std::get<1>(row);
+	REQUIRE(total == 40.0);
+	// The copy made by value_type is independent.
+	soa_circular_buffer<int, double>::value_type copy = ccb[0];
+	std::get<0>(copy) = 0;
+	REQUIRE(cb.get<0>(0) == 101);
+}
+
+TEST_CASE("Column segments cover the wrap", "[soa_circular_buffer]")
+{
+	soa_circular_buffer<std::int64_t, double> cb(5);
+	REQUIRE(cb.array_one<1>().second == 0);
+	REQUIRE(cb.array_two<1>().second == 0);
+
+	for (int i = 1; i <= 8; ++i)
+		cb.push_back(i, i * 0.5);
+	// Holds 4..8, starting at slot 3.
+	auto one = cb.array_one<0>();
+	auto two = cb.array_two<0>();
+	REQUIRE(one.second == 2);
+	REQUIRE(two.second == 3);
+	REQUIRE(one.first[0] == 4);
+	REQUIRE(two.first[0] == 6);
+	REQUIRE(column_sum<1>(cb) == (4 + 5 + 6 + 7 + 8) * 0.5);
+
+	cb.pop_back();
+	cb.pop_back();
+	cb.pop_back();
+	REQUIRE(cb.array_one<0>().second == 2);
+	REQUIRE(cb.array_two<0>().second == 0);
+}
+
+TEST_CASE("Non-trivial fields are constructed and destroyed", "[soa_circular_buffer]")
+{
+	auto tracker = std::make_shared<int>(0);
+	{
+		soa_circular_buffer<std::string, std::shared_ptr<int>> cb(2);
+		cb.push_back("one", tracker);
+		cb.push_back("two", tracker);
+		cb.push_back("three", tracker);
+		REQUIRE(tracker.use_count() == 3);
+		REQUIRE(cb.get<0>(0) == "two");
+		cb.pop_front();
+		REQUIRE(tracker.use_count() == 2);
+	}
+	REQUIRE(tracker.use_count() == 1);
+}
+
+namespace {
+
+// Counts live instances; copying throws once armed.
+struct fragile {
+	static int live;
+	static bool armed;
+
+	fragile() { ++live; }
+	fragile(const fragile&)
+	{
+		if (armed)
+			throw std::runtime_error("copy failed");
+		++live;
+	}
+	~fragile() { --live; }
+};
+
+int fragile::live = 0;
+bool fragile::armed = false;
+
+} // namespace
+
+TEST_CASE("A field that throws while copying leaves no partial record", "[soa_circular_buffer]")
+{
+	auto tracker = std::make_shared<int>(0);
+	{
+		soa_circular_buffer<std::shared_ptr<int>, fragile, int> cb(2);
+		const fragile f;
+		cb.push_back(tracker, f, 1);
+		cb.push_back(tracker, f, 2);
+		REQUIRE(fragile::live == 3);
+
+		fragile::armed = true;
+		// Full: the oldest record goes, and the new one never arrives.
+		REQUIRE_THROWS_AS(cb.push_back(tracker, f, 3), std::runtime_error);
+		REQUIRE(cb.size() == 1);
+		REQUIRE(std::get<2>(cb.front()) == 2);
+		REQUIRE(tracker.use_count() == 2);
+		REQUIRE(fragile::live == 2);
+
+		REQUIRE_THROWS_AS(cb.push_back(tracker, f, 4), std::runtime_error);
+		REQUIRE(cb.size() == 1);
+		REQUIRE(tracker.use_count() == 2);
+
+		fragile::armed = false;
+		REQUIRE(cb.push_back(tracker, f, 5));
+		REQUIRE(std::get<2>(cb.back()) == 5);
+	}
+	REQUIRE(tracker.use_count() == 1);
+	REQUIRE(fragile::live == 0);
+}
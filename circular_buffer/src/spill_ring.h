@@ -0,0 +1,245 @@
+// spill_ring.h
+//
+// Lossless FIFO for trivially copyable elements. It is a bounded in-memory
+// ring, plus a file it spills to when the ring fills up. circular_buffer
+// overwrites its oldest element when a consumer falls behind. spill_ring
+// instead keeps accepting elements and moves the overflow to disk, so it can
+// buffer bursts far larger than its memory budget.
+//
+// There are three tiers, oldest first:
+//   - the hot ring, which the pops read from;
+//   - whole segments in the file;
+//   - a tail segment collecting the newest elements.
+// Once anything has spilled, new elements go to the tail so that order is
+// kept even if the hot ring has room. A full tail is appended to the file,
+// with one write, when the next element arrives. As pops free up a segment's
+// worth of room, segments are read back into the hot ring, again one read
+// each. Segments are appended to the file and read back from its front.
+// The file is rewound whenever it has been read to the end. If a consumer
+// never quite catches up, the space already read is reused instead: once the
+// read-back prefix is at least as large as the unread data, the unread
+// segments are copied down to the start of the file, through the hot ring's
+// free space. That costs at most one extra read and write per element read
+// back, and keeps the file within about twice the most data ever on disk at
+// once, plus a segment.
+//
+// Not thread-safe: use it from one thread, or behind a lock. Disk errors
+// throw std::runtime_error.
+//
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+template <typename T>
+class spill_ring
+{
+	static_assert(std::is_trivially_copyable<T>::value, "spill_ring writes elements to disk as bytes");
+
+public:
+	using value_type = T;
+	using size_type = std::size_t;
+
+	// Keeps up to hot_capacity elements in memory, and spills in segments
+	// of segment_size elements (at most hot_capacity). With an empty path
+	// the spill file is an anonymous temporary file. Otherwise the file at
+	// path is created or truncated, and it is removed again on destruction.
+	spill_ring(std::size_t hot_capacity, std::size_t segment_size, const std::string& path = std::string())
+		: m_capacity{ hot_capacity },
+		m_segment_size{ segment_size },
+		m_hot(new T[hot_capacity]),
+		m_tail(new T[segment_size]),
+		m_path{ path }
+	{
+		if (segment_size == 0 || segment_size > hot_capacity)
+			throw std::invalid_argument("Segment size must be between 1 and the hot capacity");
+		m_file.reset(path.empty() ? std::tmpfile() : std::fopen(path.c_str(), "w+b"));
+		if (!m_file)
+			throw std::runtime_error("Cannot open spill file");
+		// Segment writes and reads go straight to the file, unbuffered.
+		std::setvbuf(m_file.get(), nullptr, _IONBF, 0);
+	}
+
+	~spill_ring()
+	{
+		m_file.reset();
+		if (!m_path.empty())
+			std::remove(m_path.c_str());
+	}
+
+	spill_ring(const spill_ring&) = delete;
+	spill_ring& operator=(const spill_ring&) = delete;
+
+	size_type hot_capacity() const { return m_capacity; }
+	size_type segment_size() const { return m_segment_size; }
+
+	size_type size() const { return m_size + spilled(); }
+	bool empty() const { return size() == 0; }
+
+	// Elements held in memory (hot ring and tail) and in the file.
+	size_type in_memory() const { return m_size + m_tail_size; }
+	size_type on_disk() const { return m_disk_size; }
+
+	// Never drops: spills instead once the hot ring is full.
+	void push(const T& value)
+	{
+		if (spilled() == 0 && m_size < m_capacity) {
+			m_hot[physical(m_size)] = value;
+			++m_size;
+			return;
+		}
+		// A full tail is only written out when the next element needs its
+		// room, so a consumer close behind can take it without disk I/O.
+		if (m_tail_size == m_segment_size)
+			write_tail();
+		m_tail[m_tail_size++] = value;
+	}
+
+	// Returns false if empty.
+	bool try_pop(T& out)
+	{
+		if (m_size == 0 && !refill())
+			return false;
+		out = m_hot[m_first];
+		m_first = physical(1);
+		--m_size;
+		refill();
+		return true;
+	}
+
+	// Pops up to n elements into out, oldest first, and returns how many.
+	size_type try_pop_n(T* out, std::size_t n)
+	{
+		size_type popped = 0;
+		while (popped < n && (m_size || refill())) {
+			size_type run = n - popped;
+			if (run > m_size)
+				run = m_size;
+			if (run > m_capacity - m_first)
+				run = m_capacity - m_first;
+			std::memcpy(out + popped, m_hot.get() + m_first, run * sizeof(T));
+			m_first = physical(run);
+			m_size -= run;
+			popped += run;
+			refill();
+		}
+		return popped;
+	}
+
+private:
+	struct file_closer {
+		void operator()(std::FILE* f) const { std::fclose(f); }
+	};
+
+	size_type spilled() const { return m_disk_size + m_tail_size; }
+
+	std::size_t physical(std::size_t index) const
+	{
+		const std::size_t slot = m_first + index;
+		return slot >= m_capacity ? slot - m_capacity : slot;
+	}
+
+	// Seeks to element index in the file. fseek() takes a long, which is
+	// 32 bits on Windows, so 64-bit offsets need the platform's own call.
+	// 32-bit POSIX builds need _FILE_OFFSET_BITS=64 for a 64-bit off_t.
+	void seek(std::uint64_t index, const char* error)
+	{
+		const std::uint64_t offset = index * sizeof(T);
+#if defined(_WIN32)
+		const int result = _fseeki64(m_file.get(), static_cast<__int64>(offset), SEEK_SET);
+#else
+		const int result = fseeko(m_file.get(), static_cast<off_t>(offset), SEEK_SET);
+#endif
+		if (result != 0)
+			throw std::runtime_error(error);
+	}
+
+	void write_tail()
+	{
+		seek(m_disk_first + m_disk_size, "Cannot write to spill file");
+		if (std::fwrite(m_tail.get(), sizeof(T), m_tail_size, m_file.get()) != m_tail_size)
+			throw std::runtime_error("Cannot write to spill file");
+		m_disk_size += m_tail_size;
+		m_tail_size = 0;
+	}
+
+	// Reads the segment at element index of the file into the hot ring's
+	// free space, in two parts if that wraps, or writes it from there.
+	// Does not change m_size.
+	void transfer_segment(std::uint64_t index, bool write)
+	{
+		const char* const error = write ? "Cannot write to spill file" : "Cannot read from spill file";
+		seek(index, error);
+		size_type done = 0;
+		while (done < m_segment_size) {
+			const std::size_t slot = physical(m_size + done);
+			size_type run = m_segment_size - done;
+			if (run > m_capacity - slot)
+				run = m_capacity - slot;
+			const std::size_t moved = write ? std::fwrite(m_hot.get() + slot, sizeof(T), run, m_file.get())
+				: std::fread(m_hot.get() + slot, sizeof(T), run, m_file.get());
+			if (moved != run)
+				throw std::runtime_error(error);
+			done += run;
+		}
+	}
+
+	// Moves the unread segments down to the start of the file. The free
+	// space in the hot ring must hold a segment.
+	void compact()
+	{
+		for (size_type done = 0; done < m_disk_size; done += m_segment_size) {
+			transfer_segment(m_disk_first + done, false);
+			transfer_segment(done, true);
+		}
+		m_disk_first = 0;
+	}
+
+	// Moves the oldest spilled segment into the hot ring if it fits there.
+	// Returns whether it did.
+	bool refill()
+	{
+		if (m_disk_size) {
+			if (m_capacity - m_size < m_segment_size)
+				return false;
+			if (m_disk_first >= m_disk_size)
+				compact();
+			// Reads straight into the free space.
+			transfer_segment(m_disk_first, false);
+			m_size += m_segment_size;
+			m_disk_first += m_segment_size;
+			m_disk_size -= m_segment_size;
+			if (m_disk_size == 0)
+				m_disk_first = 0;
+			return true;
+		}
+		if (m_tail_size == 0 || m_capacity - m_size < m_tail_size)
+			return false;
+		for (size_type i = 0; i < m_tail_size; ++i)
+			m_hot[physical(m_size + i)] = m_tail[i];
+		m_size += m_tail_size;
+		m_tail_size = 0;
+		return true;
+	}
+
+	const size_type m_capacity;
+	const size_type m_segment_size;
+	std::unique_ptr<T[]> m_hot;
+	std::size_t m_first = 0;
+	size_type m_size = 0;
+	std::unique_ptr<T[]> m_tail;
+	size_type m_tail_size = 0;
+	std::unique_ptr<std::FILE, file_closer> m_file;
+	std::string m_path;
+	// Unread elements in the file: [m_disk_first, m_disk_first + m_disk_size).
+	std::uint64_t m_disk_first = 0;
+	size_type m_disk_size = 0;
+};
@@ -0,0 +1,50 @@
+#include "catch.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "circular_buffer.h"
+#include "spill_ring.h"
+
+TEST_CASE("A 256 MiB burst into an 8 MiB budget", "[.][benchmark][spill_ring]")
+{
+	const std::size_t hot = 1 << 20;
+	const std::size_t burst = 32 << 20;
+
+	// The consumer is stalled for the whole burst.
+	circular_buffer<std::uint64_t> lossy(hot);
+	std::size_t lost = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (std::uint64_t i = 0; i < burst; ++i)
+		lost += !lossy.push_back(i);
+	double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::printf("circular_buffer push   %7.1f ms  %6.0f MB/s  %zu of %zu lost\n", s * 1e3,
+		burst * sizeof(std::uint64_t) / s / 1e6, lost, burst);
+
+	for (std::size_t segment : { std::size_t{ 4096 }, std::size_t{ 65536 } }) {
+		spill_ring<std::uint64_t> ring(hot, segment);
+		start = std::chrono::steady_clock::now();
+		for (std::uint64_t i = 0; i < burst; ++i)
+			ring.push(i);
+		s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::printf("spill_ring push        %7.1f ms  %6.0f MB/s  %zu on disk, segments of %zu KiB\n", s * 1e3,
+			burst * sizeof(std::uint64_t) / s / 1e6, ring.on_disk(), segment * sizeof(std::uint64_t) / 1024);
+
+		std::vector<std::uint64_t> out(4096);
+		std::uint64_t expected = 0;
+		bool in_order = true;
+		start = std::chrono::steady_clock::now();
+		std::size_t n = 0;
+		while ((n = ring.try_pop_n(out.data(), out.size())) != 0) {
+			for (std::size_t i = 0; i < n; ++i)
+				in_order = in_order && out[i] == expected++;
+		}
+		s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::printf("spill_ring drain       %7.1f ms  %6.0f MB/s  %llu in order: %s\n", s * 1e3,
+			burst * sizeof(std::uint64_t) / s / 1e6, static_cast<unsigned long long>(expected), in_order ? "yes" : "no");
+		CHECK(in_order);
+		CHECK(expected == burst);
+	}
+}
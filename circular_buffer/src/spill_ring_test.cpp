@@ -0,0 +1,143 @@
+#include "catch.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "spill_ring.h"
+
+namespace {
+
+struct sample {
+	std::uint64_t sequence;
+	double value;
+};
+
+} // namespace
+
+TEST_CASE("spill_ring spills and reads back in order", "[spill_ring]")
+{
+	spill_ring<std::uint32_t> ring(8, 4);
+	CHECK(ring.empty());
+	std::uint32_t out = 0;
+	CHECK_FALSE(ring.try_pop(out));
+
+	for (std::uint32_t i = 0; i < 30; ++i)
+		ring.push(i);
+	CHECK(ring.size() == 30);
+	// 8 hot, 20 written out in segments of 4, and a tail of 2.
+	CHECK(ring.in_memory() == 10);
+	CHECK(ring.on_disk() == 20);
+
+	for (std::uint32_t i = 0; i < 30; ++i) {
+		REQUIRE(ring.try_pop(out));
+		REQUIRE(out == i);
+	}
+	CHECK(ring.empty());
+	CHECK(ring.on_disk() == 0);
+	CHECK_FALSE(ring.try_pop(out));
+
+	// The file is reused from the start.
+	for (std::uint32_t i = 0; i < 20; ++i)
+		ring.push(100 + i);
+	std::vector<std::uint32_t> all(32);
+	CHECK(ring.try_pop_n(all.data(), all.size()) == 20);
+	for (std::uint32_t i = 0; i < 20; ++i)
+		CHECK(all[i] == 100 + i);
+}
+
+TEST_CASE("spill_ring with interleaved pushes and pops matches a std::deque", "[spill_ring]")
+{
+	const std::string path = "spill_ring_test.bin";
+	{
+		spill_ring<sample> ring(64, 16, path);
+		std::deque<sample> model;
+		std::mt19937 rng(3);
+		std::uint64_t next = 0;
+		std::vector<sample> out(50);
+
+		for (int step = 0; step < 20000; ++step) {
+			// Bursts of pushes, so that the ring spills often and far.
+			const unsigned op = rng() % 100;
+			if (op < 55) {
+				const sample s{ next, next * 0.5 };
+				++next;
+				ring.push(s);
+				model.push_back(s);
+			}
+			else if (op < 90) {
+				sample s{};
+				REQUIRE(ring.try_pop(s) == !model.empty());
+				if (!model.empty()) {
+					REQUIRE(s.sequence == model.front().sequence);
+					REQUIRE(s.value == model.front().value);
+					model.pop_front();
+				}
+			}
+			else {
+				const std::size_t n = ring.try_pop_n(out.data(), rng() % out.size());
+				for (std::size_t i = 0; i < n; ++i) {
+					REQUIRE(out[i].sequence == model.front().sequence);
+					model.pop_front();
+				}
+			}
+			REQUIRE(ring.size() == model.size());
+			REQUIRE(ring.in_memory() + ring.on_disk() == model.size());
+			REQUIRE(ring.in_memory() <= 64 + 16);
+		}
+
+		std::size_t n = 0;
+		while ((n = ring.try_pop_n(out.data(), out.size())) != 0) {
+			for (std::size_t i = 0; i < n; ++i) {
+				REQUIRE(out[i].sequence == model.front().sequence);
+				model.pop_front();
+			}
+		}
+		CHECK(model.empty());
+	}
+	// Removed along with the ring.
+	CHECK(std::fopen(path.c_str(), "rb") == nullptr);
+}
+
+TEST_CASE("spill_ring reuses the file under a steady backlog", "[spill_ring]")
+{
+	const std::string path = "spill_ring_backlog.bin";
+	const auto file_bytes = [&] {
+		std::FILE* f = std::fopen(path.c_str(), "rb");
+		REQUIRE(f);
+		std::fseek(f, 0, SEEK_END);
+		const long bytes = std::ftell(f);
+		std::fclose(f);
+		return static_cast<std::size_t>(bytes);
+	};
+	{
+		spill_ring<std::uint32_t> ring(32, 8, path);
+		std::uint32_t pushed = 0;
+		std::uint32_t popped = 0;
+		// The consumer never drains the file: about 200 elements stay on disk.
+		for (; pushed < 232; ++pushed)
+			ring.push(pushed);
+		std::size_t most_on_disk = 0;
+		for (int step = 0; step < 100000; ++step) {
+			ring.push(pushed++);
+			std::uint32_t out = 0;
+			REQUIRE(ring.try_pop(out));
+			REQUIRE(out == popped++);
+			REQUIRE(ring.on_disk() > 0);
+			if (ring.on_disk() > most_on_disk)
+				most_on_disk = ring.on_disk();
+		}
+		CHECK(file_bytes() <= (2 * most_on_disk + 8) * sizeof(std::uint32_t));
+	}
+	CHECK(std::fopen(path.c_str(), "rb") == nullptr);
+}
+
+TEST_CASE("spill_ring rejects bad arguments", "[spill_ring]")
+{
+	CHECK_THROWS_AS(spill_ring<int>(4, 8), std::invalid_argument);
+	CHECK_THROWS_AS(spill_ring<int>(4, 0), std::invalid_argument);
+	CHECK_THROWS_AS(spill_ring<int>(4, 2, "no/such/directory/spill.bin"), std::runtime_error);
+}
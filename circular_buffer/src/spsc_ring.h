@@ -0,0 +1,234 @@
+// spsc_ring.h
+//
+// Bounded lock-free ring for exactly one producer thread and one consumer
+// thread. Unlike circular_buffer it never overwrites: try_push fails when the
+// ring is full.
+//
+// Each side owns one index and publishes it with a release store; neither
+// side ever does an atomic read-modify-write. Each side also caches the last
+// value it saw of the other side's index and only reloads it (one acquire
+// load, and a likely cache miss) when the cached value says the ring is full
+// or empty. try_push_n/try_pop_n move a whole batch for that same single
+// load and single store, and copy trivially copyable elements with one
+// memcpy per contiguous segment.
+//
+// Wait is one of the strategies from wait_strategy.h, used by the blocking
+// push() and pop().
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "power_of_two.h"
+#include "wait_strategy.h"
+
+template <typename T, typename Wait = spin_yield_wait>
+class spsc_ring
+{
+public:
+	using value_type = T;
+	using size_type = std::size_t;
+
+	// capacity is rounded up to a power of two.
+	explicit spsc_ring(std::size_t capacity)
+		: m_capacity{ power_of_two::round_up(capacity) },
+		m_mask{ m_capacity - 1 },
+		m_slots(new slot[m_capacity])
+	{
+		// Touch the storage now so that the first lap does not take page
+		// faults on the producer's path.
+		std::memset(static_cast<void*>(m_slots.get()), 0, m_capacity * sizeof(slot));
+	}
+
+	spsc_ring(const spsc_ring&) = delete;
+	spsc_ring& operator=(const spsc_ring&) = delete;
+
+	~spsc_ring()
+	{
+		const std::uint64_t head = m_head.value.load(std::memory_order_relaxed);
+		const std::uint64_t tail = m_tail.value.load(std::memory_order_relaxed);
+		for (std::uint64_t i = head; i != tail; ++i)
+			element(i)->~value_type();
+	}
+
+	size_type capacity() const { return m_capacity; }
+
+	// Approximate when called while the other side is active.
+	size_type size() const
+	{
+		return static_cast<size_type>(m_tail.value.load(std::memory_order_acquire)
+			- m_head.value.load(std::memory_order_acquire));
+	}
+
+	bool empty() const { return size() == 0; }
+
+	// --- producer side ---------------------------------------------------
+
+	template <typename... Args>
+	bool try_emplace(Args&&... args)
+	{
+		const std::uint64_t tail = m_tail.value.load(std::memory_order_relaxed);
+		if (free_slots(tail, 1) == 0)
+			return false;
+		new (element(tail)) value_type(std::forward<Args>(args)...);
+		publish_tail(tail + 1);
+		return true;
+	}
+
+	bool try_push(const value_type& value) { return try_emplace(value); }
+	bool try_push(value_type&& value) { return try_emplace(std::move(value)); }
+
+	// Copies up to n elements from items and returns how many fitted.
+	size_type try_push_n(const value_type* items, size_type n)
+	{
+		const std::uint64_t tail = m_tail.value.load(std::memory_order_relaxed);
+		const size_type count = free_slots(tail, n);
+		if (count == 0)
+			return 0;
+		copy_in(tail, items, count);
+		publish_tail(tail + count);
+		return count;
+	}
+
+	// Waits while the ring is full.
+	void push(const value_type& value)
+	{
+		if (!try_push(value))
+			m_space_wait.wait_until([&] { return try_push(value); });
+	}
+
+	// --- consumer side ---------------------------------------------------
+
+	bool try_pop(value_type& out)
+	{
+		const std::uint64_t head = m_head.value.load(std::memory_order_relaxed);
+		if (used_slots(head, 1) == 0)
+			return false;
+		value_type* const p = element(head);
+		out = std::move(*p);
+		p->~value_type();
+		publish_head(head + 1);
+		return true;
+	}
+
+	// Moves up to n elements into out and returns how many there were.
+	size_type try_pop_n(value_type* out, size_type n)
+	{
+		const std::uint64_t head = m_head.value.load(std::memory_order_relaxed);
+		const size_type count = used_slots(head, n);
+		if (count == 0)
+			return 0;
+		move_out(head, out, count);
+		publish_head(head + count);
+		return count;
+	}
+
+	// Waits while the ring is empty.
+	void pop(value_type& out)
+	{
+		if (!try_pop(out))
+			m_data_wait.wait_until([&] { return try_pop(out); });
+	}
+
+private:
+	using slot = typename std::aligned_storage<sizeof(value_type), alignof(value_type)>::type;
+
+	struct alignas(64) padded_index {
+		std::atomic<std::uint64_t> value{ 0 };
+		// The owning side's cached copy of the other side's index.
+		std::uint64_t cached = 0;
+	};
+
+	value_type* element(std::uint64_t i) const
+	{
+		return std::launder(reinterpret_cast<value_type*>(&m_slots[i & m_mask]));
+	}
+
+	// Producer: how many of the wanted slots are free, reloading the
+	// consumer's index only if the cached one is not enough.
+	size_type free_slots(std::uint64_t tail, size_type wanted)
+	{
+		size_type room = static_cast<size_type>(m_capacity - (tail - m_tail.cached));
+		if (room < wanted) {
+			m_tail.cached = m_head.value.load(std::memory_order_acquire);
+			room = static_cast<size_type>(m_capacity - (tail - m_tail.cached));
+		}
+		return room < wanted ? room : wanted;
+	}
+
+	// Consumer: how many of the wanted elements are available.
+	size_type used_slots(std::uint64_t head, size_type wanted)
+	{
+		size_type ready = static_cast<size_type>(m_head.cached - head);
+		if (ready < wanted) {
+			m_head.cached = m_tail.value.load(std::memory_order_acquire);
+			ready = static_cast<size_type>(m_head.cached - head);
+		}
+		return ready < wanted ? ready : wanted;
+	}
+
+	void publish_tail(std::uint64_t tail)
+	{
+		m_tail.value.store(tail, std::memory_order_release);
+		m_data_wait.notify();
+	}
+
+	void publish_head(std::uint64_t head)
+	{
+		m_head.value.store(head, std::memory_order_release);
+		m_space_wait.notify();
+	}
+
+	// The count slots from index first form at most two contiguous runs.
+	void copy_in(std::uint64_t first, const value_type* items, size_type count)
+	{
+		const size_type start = static_cast<size_type>(first & m_mask);
+		const size_type run = count < m_capacity - start ? count : m_capacity - start;
+		if constexpr (std::is_trivially_copyable<value_type>::value) {
+			std::memcpy(static_cast<void*>(&m_slots[start]), items, run * sizeof(value_type));
+			std::memcpy(static_cast<void*>(&m_slots[0]), items + run, (count - run) * sizeof(value_type));
+		}
+		else {
+			for (size_type i = 0; i < count; ++i)
+				new (element(first + i)) value_type(items[i]);
+		}
+	}
+
+	void move_out(std::uint64_t first, value_type* out, size_type count)
+	{
+		const size_type start = static_cast<size_type>(first & m_mask);
+		const size_type run = count < m_capacity - start ? count : m_capacity - start;
+		if constexpr (std::is_trivially_copyable<value_type>::value) {
+			std::memcpy(static_cast<void*>(out), &m_slots[start], run * sizeof(value_type));
+			std::memcpy(static_cast<void*>(out + run), &m_slots[0], (count - run) * sizeof(value_type));
+		}
+		else {
+			for (size_type i = 0; i < count; ++i) {
+				value_type* const p = element(first + i);
+				out[i] = std::move(*p);
+				p->~value_type();
+			}
+		}
+	}
+
+	const std::size_t m_capacity;
+	const std::size_t m_mask;
+	std::unique_ptr<slot[]> m_slots;
+
+	// m_head is written by the consumer (next element to pop), m_tail by the
+	// producer (next slot to fill).
+	padded_index m_head;
+	padded_index m_tail;
+
+	// The consumer waits on m_data_wait, the producer on m_space_wait.
+	Wait m_data_wait;
+	Wait m_space_wait;
+};
@@ -0,0 +1,112 @@
+#include "catch.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+
+#include "broadcast_ring.h"
+#include "spsc_ring.h"
+
+namespace {
+
+struct record {
+	std::uint64_t seq;
+	std::uint64_t payload[7];
+};
+static_assert(sizeof(record) == 64, "records should fill a cache line");
+
+constexpr std::uint64_t messages = 1 << 22;
+constexpr std::size_t batch = 32;
+
+void report(const char* name, std::chrono::steady_clock::time_point start, std::uint64_t check)
+{
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::printf("%-32s %8.1f M records/s  (check %llu)\n",
+		name, messages / seconds * 1e-6, static_cast<unsigned long long>(check));
+}
+
+// Producer and consumer each move `per_call` records per ring operation.
+void spsc(const char* name, std::size_t per_call)
+{
+	spsc_ring<record> ring(1024);
+	std::uint64_t check = 0;
+	const auto start = std::chrono::steady_clock::now();
+	std::thread reader([&] {
+		record out[batch];
+		for (std::uint64_t received = 0; received < messages;) {
+			const std::size_t n = ring.try_pop_n(out, per_call);
+			if (n == 0) {
+				std::this_thread::yield();
+				continue;
+			}
+			for (std::size_t i = 0; i < n; ++i)
+				check += out[i].seq;
+			received += n;
+		}
+	});
+
+	record in[batch] = {};
+	for (std::uint64_t sent = 0; sent < messages;) {
+		for (std::size_t i = 0; i < per_call; ++i)
+			in[i].seq = sent + i;
+		std::size_t done = 0;
+		while (done < per_call) {
+			const std::size_t n = ring.try_push_n(in + done, per_call - done);
+			if (n == 0)
+				std::this_thread::yield();
+			done += n;
+		}
+		sent += per_call;
+	}
+	reader.join();
+	report(name, start, check);
+}
+
+void broadcast(const char* name, std::size_t per_call)
+{
+	broadcast_ring<record> ring(1024);
+	auto consumer = ring.subscribe();
+	std::uint64_t check = 0;
+	const auto start = std::chrono::steady_clock::now();
+	std::thread reader([&] {
+		record out[batch];
+		for (std::uint64_t received = 0; received < messages;) {
+			const std::size_t n = consumer.try_pop_n(out, per_call);
+			if (n == 0) {
+				std::this_thread::yield();
+				continue;
+			}
+			for (std::size_t i = 0; i < n; ++i)
+				check += out[i].seq;
+			received += n;
+		}
+	});
+
+	record in[batch] = {};
+	for (std::uint64_t sent = 0; sent < messages;) {
+		for (std::size_t i = 0; i < per_call; ++i)
+			in[i].seq = sent + i;
+		std::size_t done = 0;
+		while (done < per_call) {
+			const std::size_t n = ring.try_publish_n(in + done, per_call - done);
+			if (n == 0)
+				std::this_thread::yield();
+			done += n;
+		}
+		sent += per_call;
+	}
+	reader.join();
+	report(name, start, check);
+}
+
+} // namespace
+
+TEST_CASE("Batched against single-element transfer of 64-byte records", "[.][benchmark][spsc_ring]")
+{
+	spsc("spsc_ring, 1 per call", 1);
+	spsc("spsc_ring, 32 per call", batch);
+	broadcast("broadcast_ring, 1 per call", 1);
+	broadcast("broadcast_ring, 32 per call", batch);
+	SUCCEED();
+}
@@ -0,0 +1,144 @@
+#include "catch.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "spsc_ring.h"
+
+TEST_CASE("Single-threaded push and pop", "[spsc_ring]")
+{
+	spsc_ring<int> ring(3);
+	REQUIRE(ring.capacity() == 4);
+	REQUIRE(ring.empty());
+
+	int value = 0;
+	REQUIRE(!ring.try_pop(value));
+	for (int i = 1; i <= 4; ++i)
+		REQUIRE(ring.try_push(i));
+	REQUIRE(!ring.try_push(5));
+	REQUIRE(ring.size() == 4);
+
+	REQUIRE(ring.try_pop(value));
+	REQUIRE(value == 1);
+	REQUIRE(ring.try_push(5));
+	for (int expected = 2; expected <= 5; ++expected) {
+		REQUIRE(ring.try_pop(value));
+		REQUIRE(value == expected);
+	}
+	REQUIRE(ring.empty());
+}
+
+TEST_CASE("Batches split across the wrap", "[spsc_ring]")
+{
+	spsc_ring<int> ring(8);
+	const int in[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+	int out[10] = {};
+
+	// Move the indices so that the next batch straddles the end of the slots.
+	REQUIRE(ring.try_push_n(in, 5) == 5);
+	REQUIRE(ring.try_pop_n(out, 5) == 5);
+
+	REQUIRE(ring.try_push_n(in, 10) == 8);
+	REQUIRE(ring.try_push_n(in, 1) == 0);
+	REQUIRE(ring.try_pop_n(out, 3) == 3);
+	REQUIRE(out[0] == 0);
+	REQUIRE(out[2] == 2);
+	REQUIRE(ring.try_push_n(in + 8, 2) == 2);
+
+	REQUIRE(ring.try_pop_n(out, 10) == 7);
+	for (int i = 0; i < 7; ++i)
+		REQUIRE(out[i] == i + 3);
+	REQUIRE(ring.try_pop_n(out, 10) == 0);
+}
+
+TEST_CASE("Non-trivial elements are constructed and destroyed", "[spsc_ring]")
+{
+	auto tracker = std::make_shared<int>(0);
+	{
+		spsc_ring<std::shared_ptr<int>> ring(4);
+		REQUIRE(ring.try_push(tracker));
+		REQUIRE(ring.try_emplace(tracker));
+		REQUIRE(tracker.use_count() == 3);
+
+		std::shared_ptr<int> out;
+		REQUIRE(ring.try_pop(out));
+		REQUIRE(out == tracker);
+		out.reset();
+		REQUIRE(tracker.use_count() == 2);
+
+		const std::vector<std::shared_ptr<int>> batch(3, tracker);
+		REQUIRE(ring.try_push_n(batch.data(), batch.size()) == 3);
+		REQUIRE(tracker.use_count() == 8);
+
+		std::vector<std::shared_ptr<int>> drained(2);
+		REQUIRE(ring.try_pop_n(drained.data(), drained.size()) == 2);
+		drained.clear();
+		REQUIRE(tracker.use_count() == 6);
+	}
+	// The ring destroyed the two it still held.
+	REQUIRE(tracker.use_count() == 1);
+
+	spsc_ring<std::string> strings(2);
+	REQUIRE(strings.try_push(std::string(100, 'x')));
+	std::string s;
+	REQUIRE(strings.try_pop(s));
+	REQUIRE(s == std::string(100, 'x'));
+}
+
+TEST_CASE("Concurrent batched transfer keeps every element in order", "[spsc_ring]")
+{
+	constexpr std::uint64_t count = 500000;
+	spsc_ring<std::uint64_t> ring(256);
+
+	bool ordered = true;
+	std::thread reader([&] {
+		std::uint64_t expected = 0;
+		std::uint64_t batch[48];
+		while (expected < count) {
+			const std::size_t n = ring.try_pop_n(batch, expected % 2 ? 48 : 7);
+			if (n == 0) {
+				std::this_thread::yield();
+				continue;
+			}
+			for (std::size_t i = 0; i < n; ++i)
+				ordered = ordered && batch[i] == expected + i;
+			expected += n;
+		}
+	});
+
+	std::uint64_t batch[32];
+	for (std::uint64_t next = 0; next < count;) {
+		const std::size_t want = next + 32 <= count ? 32 : static_cast<std::size_t>(count - next);
+		for (std::size_t i = 0; i < want; ++i)
+			batch[i] = next + i;
+		const std::size_t pushed = ring.try_push_n(batch, want);
+		if (pushed == 0)
+			std::this_thread::yield();
+		next += pushed;
+	}
+	reader.join();
+
+	REQUIRE(ordered);
+	REQUIRE(ring.empty());
+}
+
+TEST_CASE("Blocking push and pop", "[spsc_ring]")
+{
+	constexpr int count = 100000;
+	spsc_ring<int> ring(16);
+	long long sum = 0;
+	std::thread reader([&] {
+		int value = 0;
+		for (int i = 0; i < count; ++i) {
+			ring.pop(value);
+			sum += value;
+		}
+	});
+	for (int i = 0; i < count; ++i)
+		ring.push(i);
+	reader.join();
+	REQUIRE(sum == static_cast<long long>(count) * (count - 1) / 2);
+}
@@ -0,0 +1,137 @@
+// time_window_buffer.h
+//
+// A window defined by age ("the last 5 seconds") rather than by count.
+// Timestamps and values are kept structure-of-arrays style in two
+// circular_buffers that are always pushed and popped together, so they share
+// the same wrap point: timestamp scans touch only timestamps, and an index
+// found in one ring addresses the matching element of the other.
+//
+// Expired entries are evicted lazily, by push_back and by the queries that
+// take the current time. The capacity still bounds memory: pushing into a full
+// buffer overwrites the oldest entry, as circular_buffer::push_back does.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+
+#include "circular_buffer.h"
+
+template <typename T, typename Clock = std::chrono::steady_clock>
+class time_window_buffer
+{
+public:
+	using value_type = T;
+	using clock_type = Clock;
+	using time_point = typename Clock::time_point;
+	using duration = typename Clock::duration;
+	using size_type = typename circular_buffer<T>::size_type;
+
+	time_window_buffer(std::size_t capacity, duration window)
+		: m_times(capacity),
+		m_values(capacity),
+		m_window(window)
+	{}
+
+	duration window() const { return m_window; }
+
+	// Timestamps must not decrease from one push to the next.
+	bool push_back(time_point when, const value_type& value)
+	{
+		assert(m_times.empty() || !(when < m_times.back()));
+		evict_expired(when);
+		m_times.push_back(when);
+		return m_values.push_back(value);
+	}
+
+	// Drops every entry that is at least window() old at now.
+	void evict_expired(time_point now)
+	{
+		const time_point horizon = now - m_window;
+		// Usually only a few entries expire per call; a linear pop is cheaper
+		// than a search for those, and a search handles the long gaps.
+		size_type expired = 0;
+		while (expired < 8 && expired < m_times.size() && !(horizon < m_times[expired]))
+			++expired;
+		if (expired == 8)
+			expired = upper_bound(horizon);
+		for (; expired; --expired) {
+			m_times.pop_front();
+			m_values.pop_front();
+		}
+	}
+
+	void pop_front()
+	{
+		m_times.pop_front();
+		m_values.pop_front();
+	}
+
+	void clear()
+	{
+		m_times.clear();
+		m_values.clear();
+	}
+
+	// Entry counts as stored; call evict_expired() (or count()) first for a
+	// view that is current.
+	size_type size() const { return m_times.size(); }
+	size_type capacity() const { return m_times.capacity(); }
+	bool empty() const { return m_times.empty(); }
+
+	// Number of entries younger than window() at now.
+	size_type count(time_point now)
+	{
+		evict_expired(now);
+		return size();
+	}
+
+	// Index (0 = oldest) of the first entry stamped at or after t, or size().
+	size_type lower_bound(time_point t) const
+	{
+		return search(t, [](const time_point& a, const time_point& b) { return a < b; });
+	}
+
+	// Index of the first entry stamped strictly after t, or size().
+	size_type upper_bound(time_point t) const
+	{
+		return search(t, [](const time_point& a, const time_point& b) { return !(b < a); });
+	}
+
+	// Number of entries stamped in [from, to).
+	size_type count_between(time_point from, time_point to) const
+	{
+		return to < from ? 0 : lower_bound(to) - lower_bound(from);
+	}
+
+	// Direct access to the two rings; index i of one matches index i of the
+	// other, and so do their array_one()/array_two() segments.
+	const circular_buffer<time_point>& timestamps() const { return m_times; }
+	const circular_buffer<value_type>& values() const { return m_values; }
+
+	time_point timestamp(size_type index) const { return m_times[index]; }
+	const value_type& value(size_type index) const { return m_values[index]; }
+
+private:
+	// First index whose timestamp does not satisfy below(timestamp, t). The
+	// timestamps are sorted, so it is a binary search of the wrapped segment
+	// only if the unwrapped one is exhausted.
+	template <typename Below>
+	size_type search(time_point t, Below below) const
+	{
+		const auto one = m_times.array_one();
+		const auto pred = [&](const time_point& x) { return below(x, t); };
+		const time_point* hit = std::partition_point(one.first, one.first + one.second, pred);
+		if (hit != one.first + one.second)
+			return static_cast<size_type>(hit - one.first);
+		const auto two = m_times.array_two();
+		return one.second + static_cast<size_type>(
+			std::partition_point(two.first, two.first + two.second, pred) - two.first);
+	}
+
+	circular_buffer<time_point> m_times;
+	circular_buffer<value_type> m_values;
+	duration m_window;
+};
@@ -0,0 +1,95 @@
+#include "catch.hpp"
+
+#include <chrono>
+
+#include "time_window_buffer.h"
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+using ms = std::chrono::milliseconds;
+
+clock_type::time_point at(int milliseconds)
+{
+	return clock_type::time_point(ms(milliseconds));
+}
+
+} // namespace
+
+TEST_CASE("Entries expire by age", "[time_window_buffer]")
+{
+	time_window_buffer<int> tw(16, ms(100));
+	REQUIRE(tw.empty());
+	REQUIRE(tw.window() == ms(100));
+
+	tw.push_back(at(0), 1);
+	tw.push_back(at(50), 2);
+	tw.push_back(at(99), 3);
+	REQUIRE(tw.size() == 3);
+
+	// The entry at 0 is exactly 100ms old at 100.
+	tw.push_back(at(100), 4);
+	REQUIRE(tw.size() == 3);
+	REQUIRE(tw.value(0) == 2);
+	REQUIRE(tw.timestamp(0) == at(50));
+
+	REQUIRE(tw.count(at(149)) == 3);
+	REQUIRE(tw.count(at(150)) == 2);
+	REQUIRE(tw.count(at(1000)) == 0);
+	REQUIRE(tw.empty());
+}
+
+TEST_CASE("Capacity still bounds the buffer", "[time_window_buffer]")
+{
+	time_window_buffer<int> tw(3, ms(1000));
+	REQUIRE(tw.push_back(at(1), 1));
+	REQUIRE(tw.push_back(at(2), 2));
+	REQUIRE(tw.push_back(at(3), 3));
+	REQUIRE(!tw.push_back(at(4), 4));
+	REQUIRE(tw.size() == 3);
+	REQUIRE(tw.value(0) == 2);
+	REQUIRE(tw.timestamps().front() == at(2));
+	REQUIRE(tw.values().back() == 4);
+
+	tw.pop_front();
+	REQUIRE(tw.size() == 2);
+	tw.clear();
+	REQUIRE(tw.empty());
+}
+
+TEST_CASE("Searching by timestamp across the wrap point", "[time_window_buffer]")
+{
+	time_window_buffer<int> tw(10, ms(1000));
+	// 15 pushes into 10 slots leaves the timestamps wrapped: 50, 60, ... 140.
+	for (int i = 0; i < 15; ++i)
+		tw.push_back(at(i * 10), i);
+	REQUIRE(tw.timestamps().array_two().second > 0);
+
+	REQUIRE(tw.lower_bound(at(0)) == 0);
+	REQUIRE(tw.lower_bound(at(50)) == 0);
+	REQUIRE(tw.lower_bound(at(51)) == 1);
+	REQUIRE(tw.upper_bound(at(50)) == 1);
+	for (int i = 5; i < 15; ++i) {
+		REQUIRE(tw.lower_bound(at(i * 10)) == static_cast<std::size_t>(i - 5));
+		REQUIRE(tw.value(tw.lower_bound(at(i * 10))) == i);
+	}
+	REQUIRE(tw.lower_bound(at(141)) == 10);
+	REQUIRE(tw.count_between(at(60), at(100)) == 4);
+	REQUIRE(tw.count_between(at(100), at(60)) == 0);
+}
+
+TEST_CASE("Long gaps evict many entries at once", "[time_window_buffer]")
+{
+	time_window_buffer<int> tw(1000, ms(500));
+	for (int i = 0; i < 1000; ++i)
+		tw.push_back(at(i), i);
+	REQUIRE(tw.size() == 500);
+
+	tw.evict_expired(at(1200));
+	REQUIRE(tw.size() == 299);
+	REQUIRE(tw.value(0) == 701);
+
+	tw.push_back(at(5000), -1);
+	REQUIRE(tw.size() == 1);
+	REQUIRE(tw.value(0) == -1);
+}
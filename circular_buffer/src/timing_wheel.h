@@ -0,0 +1,220 @@
+// timing_wheel.h
+//
+// Hierarchical timing wheel. Level l is a ring of 2^Bits slots, each slot
+// covering 2^(Bits * l) ticks, and the slot cursor of each level is the
+// current tick shifted and masked -- the same power-of-two wrap a ring buffer
+// uses for its indices. Every slot is an intrusive doubly linked list of
+// wheel_timer, so schedule() and cancel() are O(1) and allocation free, and
+// tick() is amortized O(1): a timer is moved down a level (cascaded) at most
+// Levels - 1 times before it fires.
+//
+// Deadlines further out than the top level can represent are parked in the
+// top level's furthest slot and re-placed each time that slot cascades.
+//
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+template <unsigned Bits, unsigned Levels>
+class timing_wheel;
+
+// Embed one of these in whatever should be timed. A timer is owned by at most
+// one wheel at a time and cancels itself when destroyed.
+class wheel_timer
+{
+public:
+	using tick_type = std::uint64_t;
+
+	wheel_timer() = default;
+	wheel_timer(const wheel_timer&) = delete;
+	wheel_timer& operator=(const wheel_timer&) = delete;
+	~wheel_timer() { unlink(); }
+
+	bool scheduled() const { return m_pprev != nullptr; }
+	tick_type deadline() const { return m_deadline; }
+
+private:
+	template <unsigned Bits, unsigned Levels>
+	friend class timing_wheel;
+
+	void link(wheel_timer*& head, std::size_t& count)
+	{
+		m_count = &count;
+		++count;
+		m_next = head;
+		if (m_next)
+			m_next->m_pprev = &m_next;
+		head = this;
+		m_pprev = &head;
+	}
+
+	bool unlink()
+	{
+		if (!m_pprev)
+			return false;
+		*m_pprev = m_next;
+		if (m_next)
+			m_next->m_pprev = m_pprev;
+		m_next = nullptr;
+		m_pprev = nullptr;
+		--*m_count;
+		return true;
+	}
+
+	wheel_timer* m_next = nullptr;
+	// The pointer that points at this timer: the slot head or the previous
+	// timer's m_next. Null when not scheduled.
+	wheel_timer** m_pprev = nullptr;
+	// The owning wheel's timer count, kept right when a timer is destroyed
+	// while scheduled.
+	std::size_t* m_count = nullptr;
+	tick_type m_deadline = 0;
+};
+
+template <unsigned Bits = 6, unsigned Levels = 4>
+class timing_wheel
+{
+	static_assert(Bits > 0 && Levels > 0 && Bits * Levels < 64, "Wheel must fit a 64-bit tick");
+
+public:
+	using tick_type = wheel_timer::tick_type;
+
+	static constexpr std::size_t slots_per_level = std::size_t{ 1 } << Bits;
+	// Largest delay that is placed exactly rather than parked.
+	static constexpr tick_type max_delay = (tick_type{ 1 } << (Bits * Levels)) - 1;
+
+	explicit timing_wheel(tick_type start = 0)
+		: m_now{ start }
+	{
+		for (auto& level : m_slots)
+			for (auto& slot : level)
+				slot = nullptr;
+	}
+
+	timing_wheel(const timing_wheel&) = delete;
+	timing_wheel& operator=(const timing_wheel&) = delete;
+
+	~timing_wheel()
+	{
+		for (auto& level : m_slots)
+			for (auto& slot : level)
+				while (slot)
+					slot->unlink();
+	}
+
+	// The last tick that has been processed.
+	tick_type now() const { return m_now; }
+
+	// Number of scheduled timers.
+	std::size_t size() const { return m_size; }
+	bool empty() const { return m_size == 0; }
+
+	// Fires timer on the tick now() + delay (a delay of 0 means the next
+	// tick). A timer that is already scheduled is moved.
+	void schedule(wheel_timer& timer, tick_type delay)
+	{
+		schedule_at(timer, m_now + (delay ? delay : 1));
+	}
+
+	// Fires timer on the given tick, or on the next tick if that has passed.
+	void schedule_at(wheel_timer& timer, tick_type deadline)
+	{
+		timer.unlink();
+		timer.m_deadline = deadline > m_now ? deadline : m_now + 1;
+		place(timer);
+	}
+
+	// Returns false if the timer was not scheduled.
+	bool cancel(wheel_timer& timer)
+	{
+		return timer.unlink();
+	}
+
+	// Processes the next tick, calling on_expire(wheel_timer&) for every timer
+	// due on it. The timer is unscheduled before the call, so the callback may
+	// reschedule it, schedule or cancel others, or destroy it.
+	template <typename F>
+	void tick(F&& on_expire)
+	{
+		m_now += 1;
+		const std::size_t index = slot_index(m_now, 0);
+		if (index == 0) {
+			// Level 0 has wrapped: pull the current slot of each higher level
+			// down, stopping at the first level that has not wrapped too. The
+			// timers are re-placed relative to the new now(), so those due on
+			// this very tick land in the level 0 slot processed below.
+			for (unsigned level = 1; level < Levels; ++level) {
+				const std::size_t upper = slot_index(m_now, level);
+				cascade(level, upper);
+				if (upper != 0)
+					break;
+			}
+		}
+
+		// Detach the slot so that callbacks can safely cancel timers in it.
+		wheel_timer* pending = m_slots[0][index];
+		m_slots[0][index] = nullptr;
+		if (pending)
+			pending->m_pprev = &pending;
+		while (pending) {
+			wheel_timer& timer = *pending;
+			timer.unlink();
+			if (timer.m_deadline <= m_now)
+				on_expire(timer);
+			else
+				place(timer);
+		}
+	}
+
+	// Processes ticks up to and including now() + ticks.
+	template <typename F>
+	void advance(tick_type ticks, F&& on_expire)
+	{
+		for (; ticks; --ticks)
+			tick(on_expire);
+	}
+
+private:
+	static constexpr tick_type mask = slots_per_level - 1;
+
+	static std::size_t slot_index(tick_type t, unsigned level)
+	{
+		return static_cast<std::size_t>((t >> (Bits * level)) & mask);
+	}
+
+	void place(wheel_timer& timer)
+	{
+		const tick_type delta = timer.m_deadline - m_now;
+		tick_type when = timer.m_deadline;
+		unsigned level = 0;
+		if (delta > max_delay) {
+			when = m_now + max_delay;
+			level = Levels - 1;
+		}
+		else {
+			while (level + 1 < Levels && delta >> (Bits * (level + 1)))
+				++level;
+		}
+		timer.link(m_slots[level][slot_index(when, level)], m_size);
+	}
+
+	void cascade(unsigned level, std::size_t index)
+	{
+		wheel_timer* pending = m_slots[level][index];
+		m_slots[level][index] = nullptr;
+		if (pending)
+			pending->m_pprev = &pending;
+		while (pending) {
+			wheel_timer& timer = *pending;
+			timer.unlink();
+			place(timer);
+		}
+	}
+
+	wheel_timer* m_slots[Levels][slots_per_level];
+	tick_type m_now;
+	std::size_t m_size = 0;
+};
@@ -0,0 +1,151 @@
+#include "catch.hpp"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "timing_wheel.h"
+
+namespace {
+
+struct test_timer : wheel_timer {
+	int id = 0;
+	wheel_timer::tick_type fired_at = 0;
+};
+
+} // namespace
+
+TEST_CASE("Timers fire on their deadline", "[timing_wheel]")
+{
+	timing_wheel<> wheel;
+	test_timer a, b, c;
+	a.id = 1;
+	b.id = 2;
+	c.id = 3;
+	wheel.schedule(a, 5);
+	wheel.schedule(b, 0);
+	wheel.schedule(c, 5);
+	REQUIRE(wheel.size() == 3);
+	REQUIRE(a.scheduled());
+	REQUIRE(a.deadline() == 5);
+	REQUIRE(b.deadline() == 1);
+
+	std::vector<int> fired;
+	auto record = [&](wheel_timer& t) {
+		auto& tt = static_cast<test_timer&>(t);
+		tt.fired_at = wheel.now();
+		fired.push_back(tt.id);
+	};
+
+	wheel.tick(record);
+	REQUIRE(fired == std::vector<int>{ 2 });
+	REQUIRE(!b.scheduled());
+
+	wheel.advance(3, record);
+	REQUIRE(fired.size() == 1);
+	wheel.tick(record);
+	REQUIRE(fired.size() == 3);
+	REQUIRE(a.fired_at == 5);
+	REQUIRE(c.fired_at == 5);
+	REQUIRE(wheel.empty());
+}
+
+TEST_CASE("Cancelling and rescheduling", "[timing_wheel]")
+{
+	timing_wheel<> wheel;
+	test_timer a, b;
+	wheel.schedule(a, 10);
+	wheel.schedule(b, 10);
+	REQUIRE(wheel.cancel(a));
+	REQUIRE(!wheel.cancel(a));
+	REQUIRE(!a.scheduled());
+	REQUIRE(wheel.size() == 1);
+
+	// Moving a scheduled timer.
+	wheel.schedule(b, 20);
+	REQUIRE(wheel.size() == 1);
+
+	int count = 0;
+	wheel.advance(15, [&](wheel_timer&) { ++count; });
+	REQUIRE(count == 0);
+	wheel.advance(5, [&](wheel_timer&) { ++count; });
+	REQUIRE(count == 1);
+
+	{
+		test_timer scoped;
+		wheel.schedule(scoped, 3);
+		REQUIRE(wheel.size() == 1);
+	}
+	// The destroyed timer unlinked itself.
+	REQUIRE(wheel.empty());
+	wheel.advance(10, [&](wheel_timer&) { ++count; });
+	REQUIRE(count == 1);
+}
+
+TEST_CASE("Callbacks may reschedule and cancel", "[timing_wheel]")
+{
+	timing_wheel<2, 3> wheel;
+	test_timer periodic, victim, other;
+	// Slots are LIFO, so periodic runs first on tick 3 and cancels victim.
+	wheel.schedule(victim, 3);
+	wheel.schedule(other, 3);
+	wheel.schedule(periodic, 3);
+
+	int periodic_fires = 0;
+	int other_fires = 0;
+	wheel.advance(30, [&](wheel_timer& t) {
+		if (&t == &periodic) {
+			++periodic_fires;
+			wheel.cancel(victim);
+			wheel.schedule(periodic, 3);
+		}
+		else if (&t == &other) {
+			++other_fires;
+		}
+		else {
+			FAIL("cancelled timer fired");
+		}
+	});
+	REQUIRE(periodic_fires == 10);
+	REQUIRE(other_fires == 1);
+}
+
+TEST_CASE("Cascading matches an ordered reference", "[timing_wheel]")
+{
+	// A small wheel (4 slots, 3 levels, 63 ticks) exercises cascading and
+	// parking beyond the top level.
+	timing_wheel<2, 3> wheel(1000);
+	std::mt19937 rng(5);
+	std::uniform_int_distribution<int> delays(0, 300);
+
+	std::vector<std::unique_ptr<test_timer>> timers;
+	std::multimap<wheel_timer::tick_type, test_timer*> expected;
+	for (int i = 0; i < 500; ++i) {
+		timers.push_back(std::make_unique<test_timer>());
+		test_timer* t = timers.back().get();
+		t->id = i;
+		const wheel_timer::tick_type delay = delays(rng);
+		wheel.schedule(*t, delay);
+		expected.emplace(t->deadline(), t);
+		// Interleave with time passing.
+		if (i % 10 == 0)
+			wheel.advance(1, [](wheel_timer& w) { static_cast<test_timer&>(w).fired_at = 1; });
+	}
+	for (auto& t : timers)
+		if (t->fired_at)
+			expected.erase(std::find_if(expected.begin(), expected.end(),
+				[&](const auto& e) { return e.second == t.get(); }));
+
+	REQUIRE(wheel.size() == expected.size());
+	while (!wheel.empty()) {
+		wheel.tick([&](wheel_timer& w) {
+			auto& t = static_cast<test_timer&>(w);
+			REQUIRE(t.deadline() == wheel.now());
+			t.fired_at = wheel.now();
+		});
+	}
+	for (const auto& e : expected)
+		REQUIRE(e.second->fired_at == e.first);
+}
@@ -0,0 +1,175 @@
+// wait_strategy.h
+//
+// Pluggable ways for a thread to wait on a concurrent ring, trading latency
+// for CPU. Each strategy has the same two members:
+//
+//   wait_until(ready)  returns once ready() is true;
+//   notify()           called by the other side after every state change
+//                      that might make a waiter's ready() true.
+//
+// busy_spin_wait      spins with a pause hint. Lowest latency; burns a core.
+// spin_yield_wait     spins a bounded number of times, then sched_yields.
+// futex_wait          spins briefly, then parks in the kernel (a futex on
+//                     Linux, a condition variable elsewhere). notify() only
+//                     makes a wake system call if someone is actually parked,
+//                     so the uncontended fast path is a fence and a load.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#if defined(__linux__)
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+// Tells the CPU this is a spin loop (saves power, frees the sibling
+// hyperthread and avoids a memory-order pipeline flush on exit).
+inline void cpu_relax()
+{
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+	_mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+	__asm__ __volatile__("yield");
+#endif
+}
+
+struct busy_spin_wait
+{
+	template <typename Ready>
+	void wait_until(Ready&& ready)
+	{
+		while (!ready())
+			cpu_relax();
+	}
+
+	void notify() {}
+};
+
+class spin_yield_wait
+{
+public:
+	explicit spin_yield_wait(unsigned spins = 100)
+		: m_spins{ spins }
+	{}
+
+	template <typename Ready>
+	void wait_until(Ready&& ready)
+	{
+		for (unsigned i = 0; i < m_spins; ++i) {
+			if (ready())
+				return;
+			cpu_relax();
+		}
+		while (!ready())
+			std::this_thread::yield();
+	}
+
+	void notify() {}
+
+private:
+	unsigned m_spins;
+};
+
+class futex_wait
+{
+public:
+	explicit futex_wait(unsigned spins = 100)
+		: m_spins{ spins }
+	{}
+
+	futex_wait(const futex_wait&) = delete;
+	futex_wait& operator=(const futex_wait&) = delete;
+
+	template <typename Ready>
+	void wait_until(Ready&& ready)
+	{
+		for (unsigned i = 0; i < m_spins; ++i) {
+			if (ready())
+				return;
+			cpu_relax();
+		}
+		for (;;) {
+			// Read the epoch before announcing ourselves: a notify() that
+			// comes after the ready() check below bumps it, and the kernel
+			// then refuses to park us on the stale value.
+			const std::uint32_t epoch = m_epoch.load(std::memory_order_acquire);
+			m_waiters.fetch_add(1, std::memory_order_seq_cst);
+			if (ready()) {
+				m_waiters.fetch_sub(1, std::memory_order_relaxed);
+				return;
+			}
+			park(epoch);
+			m_waiters.fetch_sub(1, std::memory_order_relaxed);
+			if (ready())
+				return;
+		}
+	}
+
+	void notify()
+	{
+		// Orders the caller's state change before the waiter count load;
+		// pairs with the seq_cst increment in wait_until().
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (m_waiters.load(std::memory_order_relaxed) == 0)
+			return;
+		m_epoch.fetch_add(1, std::memory_order_release);
+		wake();
+	}
+
+	// Wake system calls made so far; for tests and benchmarks.
+	std::uint64_t wakes() const { return m_wakes.load(std::memory_order_relaxed); }
+
+private:
+#if defined(__linux__)
+	void park(std::uint32_t epoch)
+	{
+		syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&m_epoch), FUTEX_WAIT_PRIVATE, epoch, nullptr, nullptr, 0);
+	}
+
+	void wake()
+	{
+		m_wakes.fetch_add(1, std::memory_order_relaxed);
+		syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&m_epoch), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+	}
+#else
+	void park(std::uint32_t epoch)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_cv.wait(lock, [&] { return m_epoch.load(std::memory_order_acquire) != epoch; });
+	}
+
+	void wake()
+	{
+		m_wakes.fetch_add(1, std::memory_order_relaxed);
+		{
+			// Taking the lock closes the gap between a waiter's predicate
+			// check and its wait.
+			std::lock_guard<std::mutex> lock(m_mutex);
+		}
+		m_cv.notify_all();
+	}
+
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+#endif
+
+	static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t), "futex word must be a plain 32-bit integer");
+
+	unsigned m_spins;
+	std::atomic<std::uint32_t> m_epoch{ 0 };
+	std::atomic<std::uint32_t> m_waiters{ 0 };
+	std::atomic<std::uint64_t> m_wakes{ 0 };
+};
@@ -0,0 +1,87 @@
+#include "catch.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/resource.h>
+#endif
+
+#include "broadcast_ring.h"
+#include "wait_strategy.h"
+
+namespace {
+
+using bench_clock = std::chrono::steady_clock;
+
+// CPU time consumed by the calling thread, in seconds (0 where unsupported).
+double thread_cpu_seconds()
+{
+#if defined(__linux__)
+	rusage usage{};
+	getrusage(RUSAGE_THREAD, &usage);
+	return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec
+		+ (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e-6;
+#else
+	return 0.0;
+#endif
+}
+
+// One producer publishes timestamps at a fixed pace, so the consumer spends
+// most of its time waiting; the consumer records publish-to-receive latency
+// and its own CPU time.
+template <typename Wait>
+void measure(const char* name)
+{
+	constexpr std::size_t messages = 20000;
+	const auto pace = std::chrono::microseconds(20);
+	broadcast_ring<std::int64_t, Wait> ring(1024);
+	auto consumer = ring.subscribe();
+
+	std::vector<std::int64_t> latencies;
+	latencies.reserve(messages);
+	double cpu = 0.0;
+	const auto start = bench_clock::now();
+	std::thread reader([&] {
+		const double cpu_start = thread_cpu_seconds();
+		std::int64_t sent = 0;
+		for (std::size_t i = 0; i < messages; ++i) {
+			consumer.pop(sent);
+			latencies.push_back(bench_clock::now().time_since_epoch().count() - sent);
+		}
+		cpu = thread_cpu_seconds() - cpu_start;
+	});
+
+	auto next = bench_clock::now();
+	for (std::size_t i = 0; i < messages; ++i) {
+		next += pace;
+		while (bench_clock::now() < next)
+			std::this_thread::yield();
+		ring.publish(bench_clock::now().time_since_epoch().count());
+	}
+	reader.join();
+	const double wall = std::chrono::duration<double>(bench_clock::now() - start).count();
+
+	std::sort(latencies.begin(), latencies.end());
+	auto percentile = [&](double p) {
+		const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+			bench_clock::duration(latencies[static_cast<std::size_t>(p * (latencies.size() - 1))]));
+		return static_cast<long long>(ns.count());
+	};
+	std::printf("%-16s p50 %8lld ns  p99 %8lld ns  p99.9 %8lld ns  consumer cpu %5.1f%%\n",
+		name, percentile(0.5), percentile(0.99), percentile(0.999), 100.0 * cpu / wall);
+}
+
+} // namespace
+
+TEST_CASE("Wait strategy latency and CPU usage", "[.][benchmark][wait_strategy]")
+{
+	measure<busy_spin_wait>("busy spin");
+	measure<spin_yield_wait>("spin then yield");
+	measure<futex_wait>("futex");
+	SUCCEED();
+}
@@ -0,0 +1,77 @@
+#include "catch.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include "broadcast_ring.h"
+#include "wait_strategy.h"
+
+namespace {
+
+template <typename Wait>
+void fan_out_with()
+{
+	constexpr std::uint64_t count = 20000;
+	broadcast_ring<std::uint64_t, Wait> ring(8);
+	auto a = ring.subscribe();
+	auto b = ring.subscribe();
+
+	auto drain = [count](typename broadcast_ring<std::uint64_t, Wait>::consumer& c, std::uint64_t& sum) {
+		std::uint64_t value = 0;
+		for (std::uint64_t i = 0; i < count; ++i) {
+			if (c.pop(value) != pop_result::ok)
+				return;
+			sum += value;
+		}
+	};
+	std::uint64_t sum_a = 0, sum_b = 0;
+	std::thread ta([&] { drain(a, sum_a); });
+	std::thread tb([&] { drain(b, sum_b); });
+	for (std::uint64_t i = 0; i < count; ++i)
+		ring.publish(i);
+	ta.join();
+	tb.join();
+
+	REQUIRE(sum_a == count * (count - 1) / 2);
+	REQUIRE(sum_b == count * (count - 1) / 2);
+}
+
+} // namespace
+
+TEST_CASE("Blocking pop and publish with each wait strategy", "[wait_strategy]")
+{
+	SECTION("busy spin") { fan_out_with<busy_spin_wait>(); }
+	SECTION("spin then yield") { fan_out_with<spin_yield_wait>(); }
+	SECTION("futex") { fan_out_with<futex_wait>(); }
+}
+
+TEST_CASE("Futex notify skips the system call with nobody parked", "[wait_strategy]")
+{
+	futex_wait w;
+	w.notify();
+	w.notify();
+	REQUIRE(w.wakes() == 0);
+
+	bool ready = true;
+	w.wait_until([&] { return ready; });
+	REQUIRE(w.wakes() == 0);
+}
+
+TEST_CASE("Futex waiters are woken by notify", "[wait_strategy]")
+{
+	futex_wait w(0);
+	std::atomic<int> flag{ 0 };
+	std::atomic<bool> woke{ false };
+	std::thread waiter([&] {
+		w.wait_until([&] { return flag.load(std::memory_order_acquire) != 0; });
+		woke = true;
+	});
+	// Give the waiter a chance to park; correctness does not depend on it.
+	for (int i = 0; i < 100; ++i)
+		std::this_thread::yield();
+	flag.store(1, std::memory_order_release);
+	w.notify();
+	waiter.join();
+	REQUIRE(woke);
+}
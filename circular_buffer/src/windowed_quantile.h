@@ -0,0 +1,358 @@
+// windowed_quantile.h
+//
+// Median and arbitrary quantiles over the last N values.
+//
+// windowed_quantile is exact. The values live in a circular_buffer and an
+// order-statistic treap indexes them: node i describes the value with sequence
+// number s where s % N == i, so the node pool is itself a ring and never
+// allocates after construction. Nodes hold no copy of the value; they find it
+// through the window by sequence number. push_back, pop_front and every query
+// are O(log N) expected.
+//
+// approximate_windowed_quantile trades exactness for speed and memory on very
+// large windows: values are bucketed over a fixed [lo, hi] range, the window
+// stores 32-bit bucket numbers and a Fenwick tree counts them, so a query
+// costs O(log buckets) regardless of N and is accurate to half a bucket.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "circular_buffer.h"
+
+template <typename T, typename Compare = std::less<T>, typename A = std::allocator<T>>
+class windowed_quantile
+{
+public:
+	using window_type = circular_buffer<T, A>;
+	using value_type = T;
+	using size_type = typename window_type::size_type;
+	using value_compare = Compare;
+
+	// Nodes are numbered with 32 bits, so the window holds less than 2^32 - 1
+	// values; a larger one throws std::length_error.
+	explicit windowed_quantile(std::size_t window, const Compare& compare = Compare(), const A& allocator = A())
+		: m_window(checked(window), allocator),
+		m_nodes(window),
+		m_compare(compare)
+	{}
+
+	// Same overwrite semantics as circular_buffer::push_back.
+	bool push_back(const value_type& value)
+	{
+		if (full())
+			m_root = erase(m_root, node_for(first_sequence()));
+
+		const bool kept_all = m_window.push_back(value);
+		const std::uint64_t seq = m_next++;
+		const std::uint32_t n = node_for(seq);
+		m_nodes[n] = node{ seq, next_priority(), nil, nil, 1 };
+		m_root = insert(m_root, n);
+		return kept_all;
+	}
+
+	void pop_front()
+	{
+		assert(!empty());
+		m_root = erase(m_root, node_for(first_sequence()));
+		m_window.pop_front();
+	}
+
+	void clear()
+	{
+		m_window.clear();
+		m_root = nil;
+	}
+
+	size_type size() const { return m_window.size(); }
+	size_type capacity() const { return m_window.capacity(); }
+	bool empty() const { return m_window.empty(); }
+	bool full() const { return m_window.size() == m_window.capacity(); }
+
+	// The values themselves, oldest first.
+	const window_type& window() const { return m_window; }
+
+	// The k-th smallest value (k counts from 0).
+	const value_type& kth(size_type k) const
+	{
+		if (k >= size())
+			throw std::out_of_range("Rank out of range");
+		std::uint32_t n = m_root;
+		for (;;) {
+			const size_type left = count(m_nodes[n].left);
+			if (k < left) {
+				n = m_nodes[n].left;
+			}
+			else if (k == left) {
+				return value_of(n);
+			}
+			else {
+				k -= left + 1;
+				n = m_nodes[n].right;
+			}
+		}
+	}
+
+	// Nearest-rank quantile for q in [0, 1]: the smallest value with at least
+	// q * size() values less than or equal to it.
+	const value_type& quantile(double q) const
+	{
+		if (empty())
+			throw std::out_of_range("Quantile of an empty window");
+		const double rank = std::ceil(std::min(std::max(q, 0.0), 1.0) * static_cast<double>(size()));
+		return kth(rank < 1.0 ? 0 : static_cast<size_type>(rank) - 1);
+	}
+
+	// Lower median for even sizes.
+	const value_type& median() const { return quantile(0.5); }
+
+private:
+	static constexpr std::uint32_t nil = std::numeric_limits<std::uint32_t>::max();
+
+	struct node {
+		std::uint64_t seq;
+		std::uint32_t priority;
+		std::uint32_t left;
+		std::uint32_t right;
+		std::uint32_t count;
+	};
+
+	static std::size_t checked(std::size_t window)
+	{
+		if (window == 0)
+			throw std::invalid_argument("Window must not be empty");
+		if (window >= nil)
+			throw std::length_error("Window is too large for 32-bit node numbers");
+		return window;
+	}
+
+	std::uint64_t first_sequence() const { return m_next - m_window.size(); }
+
+	std::uint32_t node_for(std::uint64_t seq) const
+	{
+		return static_cast<std::uint32_t>(seq % m_nodes.size());
+	}
+
+	const value_type& value_of(std::uint32_t n) const
+	{
+		return m_window[static_cast<std::size_t>(m_nodes[n].seq - first_sequence())];
+	}
+
+	size_type count(std::uint32_t n) const { return n == nil ? 0 : m_nodes[n].count; }
+
+	void update(std::uint32_t n)
+	{
+		m_nodes[n].count = static_cast<std::uint32_t>(1 + count(m_nodes[n].left) + count(m_nodes[n].right));
+	}
+
+	// Orders by value, then by age, so that every node has a distinct key.
+	bool before(std::uint32_t a, std::uint32_t b) const
+	{
+		const value_type& va = value_of(a);
+		const value_type& vb = value_of(b);
+		if (m_compare(va, vb))
+			return true;
+		if (m_compare(vb, va))
+			return false;
+		return m_nodes[a].seq < m_nodes[b].seq;
+	}
+
+	// Splits the tree at t into nodes ordered before key and the rest.
+	void split(std::uint32_t t, std::uint32_t key, std::uint32_t& lo, std::uint32_t& hi)
+	{
+		if (t == nil) {
+			lo = hi = nil;
+		}
+		else if (before(t, key)) {
+			split(m_nodes[t].right, key, m_nodes[t].right, hi);
+			lo = t;
+			update(t);
+		}
+		else {
+			split(m_nodes[t].left, key, lo, m_nodes[t].left);
+			hi = t;
+			update(t);
+		}
+	}
+
+	std::uint32_t merge(std::uint32_t lo, std::uint32_t hi)
+	{
+		if (lo == nil)
+			return hi;
+		if (hi == nil)
+			return lo;
+		if (m_nodes[lo].priority > m_nodes[hi].priority) {
+			m_nodes[lo].right = merge(m_nodes[lo].right, hi);
+			update(lo);
+			return lo;
+		}
+		m_nodes[hi].left = merge(lo, m_nodes[hi].left);
+		update(hi);
+		return hi;
+	}
+
+	std::uint32_t insert(std::uint32_t t, std::uint32_t n)
+	{
+		if (t == nil)
+			return n;
+		if (m_nodes[n].priority > m_nodes[t].priority) {
+			split(t, n, m_nodes[n].left, m_nodes[n].right);
+			update(n);
+			return n;
+		}
+		if (before(n, t))
+			m_nodes[t].left = insert(m_nodes[t].left, n);
+		else
+			m_nodes[t].right = insert(m_nodes[t].right, n);
+		update(t);
+		return t;
+	}
+
+	std::uint32_t erase(std::uint32_t t, std::uint32_t n)
+	{
+		assert(t != nil);
+		if (t == n)
+			return merge(m_nodes[t].left, m_nodes[t].right);
+		if (before(n, t))
+			m_nodes[t].left = erase(m_nodes[t].left, n);
+		else
+			m_nodes[t].right = erase(m_nodes[t].right, n);
+		update(t);
+		return t;
+	}
+
+	// xorshift32; treap priorities only need to be well spread.
+	std::uint32_t next_priority()
+	{
+		m_seed ^= m_seed << 13;
+		m_seed ^= m_seed >> 17;
+		m_seed ^= m_seed << 5;
+		return m_seed;
+	}
+
+	window_type m_window;
+	std::vector<node> m_nodes;
+	Compare m_compare;
+	std::uint32_t m_root = nil;
+	std::uint32_t m_seed = 2463534242u;
+	// Sequence number the next pushed value will get.
+	std::uint64_t m_next = 0;
+};
+
+template <typename T>
+class approximate_windowed_quantile
+{
+public:
+	using value_type = T;
+	using size_type = typename circular_buffer<std::uint32_t>::size_type;
+
+	// Values outside [lo, hi] are counted in the first or last bucket. lo and
+	// hi must be finite, and there can be at most 2^32 buckets.
+	approximate_windowed_quantile(std::size_t window, value_type lo, value_type hi, std::size_t buckets = 4096)
+		: m_window(window),
+		m_tree(checked(buckets) + 1),
+		m_lo(static_cast<double>(lo)),
+		m_width((static_cast<double>(hi) - static_cast<double>(lo)) / static_cast<double>(buckets))
+	{
+		if (window == 0 || !(m_width > 0.0) || !std::isfinite(m_lo) || !std::isfinite(m_width))
+			throw std::invalid_argument("Window and bucket range must not be empty");
+		while (m_top_bit * 2 <= buckets)
+			m_top_bit *= 2;
+	}
+
+	// A NaN has no bucket: it throws std::invalid_argument and the window is
+	// left as it was.
+	bool push_back(const value_type& value)
+	{
+		const std::uint32_t b = bucket_of(value);
+		if (full())
+			add(m_window.front(), -1);
+		add(b, 1);
+		return m_window.push_back(b);
+	}
+
+	void pop_front()
+	{
+		assert(!empty());
+		add(m_window.front(), -1);
+		m_window.pop_front();
+	}
+
+	void clear()
+	{
+		m_window.clear();
+		std::fill(m_tree.begin(), m_tree.end(), 0);
+	}
+
+	size_type size() const { return m_window.size(); }
+	size_type capacity() const { return m_window.capacity(); }
+	bool empty() const { return m_window.empty(); }
+	bool full() const { return m_window.size() == m_window.capacity(); }
+
+	// Nearest-rank quantile, reported as the midpoint of the bucket holding it.
+	double quantile(double q) const
+	{
+		if (empty())
+			throw std::out_of_range("Quantile of an empty window");
+		const double rank = std::ceil(std::min(std::max(q, 0.0), 1.0) * static_cast<double>(size()));
+		const std::int64_t k = rank < 1.0 ? 1 : static_cast<std::int64_t>(rank);
+
+		// Fenwick descent for the first bucket whose cumulative count reaches k.
+		std::size_t pos = 0;
+		std::int64_t remaining = k;
+		for (std::size_t step = m_top_bit; step; step /= 2) {
+			const std::size_t next = pos + step;
+			if (next < m_tree.size() && m_tree[next] < remaining) {
+				pos = next;
+				remaining -= m_tree[next];
+			}
+		}
+		// pos is the number of buckets wholly below the quantile.
+		return m_lo + (static_cast<double>(pos) + 0.5) * m_width;
+	}
+
+	double median() const { return quantile(0.5); }
+
+private:
+	static std::size_t checked(std::size_t buckets)
+	{
+		if (buckets == 0)
+			throw std::invalid_argument("Window and bucket range must not be empty");
+		if (buckets - 1 > std::numeric_limits<std::uint32_t>::max())
+			throw std::length_error("Bucket numbers must fit in 32 bits");
+		return buckets;
+	}
+
+	std::uint32_t bucket_of(const value_type& value) const
+	{
+		const double b = std::floor((static_cast<double>(value) - m_lo) / m_width);
+		// Casting NaN to an integer is undefined, and min/max pass it through.
+		if (std::isnan(b))
+			throw std::invalid_argument("NaN cannot be bucketed");
+		const double last = static_cast<double>(m_tree.size() - 2);
+		return static_cast<std::uint32_t>(std::min(std::max(b, 0.0), last));
+	}
+
+	void add(std::uint32_t bucket, std::int64_t delta)
+	{
+		for (std::size_t i = bucket + 1; i < m_tree.size(); i += i & (~i + 1))
+			m_tree[i] += delta;
+	}
+
+	// Bucket number of every value in the window, oldest first.
+	circular_buffer<std::uint32_t> m_window;
+	// One-based Fenwick tree of bucket counts.
+	std::vector<std::int64_t> m_tree;
+	// Largest power of two not above the bucket count.
+	std::size_t m_top_bit = 1;
+	double m_lo;
+	double m_width;
+};
@@ -0,0 +1,140 @@
+#include "catch.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "windowed_quantile.h"
+
+namespace {
+
+template <typename T>
+T nearest_rank(std::deque<T> values, double q)
+{
+	std::sort(values.begin(), values.end());
+	const double rank = std::ceil(q * values.size());
+	return values[rank < 1.0 ? 0 : static_cast<std::size_t>(rank) - 1];
+}
+
+} // namespace
+
+TEST_CASE("Median of a small window", "[windowed_quantile]")
+{
+	windowed_quantile<int> wq(5);
+	REQUIRE(wq.empty());
+	REQUIRE_THROWS_AS(wq.median(), std::out_of_range);
+
+	for (int v : { 5, 1, 4, 2, 3 })
+		wq.push_back(v);
+	REQUIRE(wq.full());
+	REQUIRE(wq.median() == 3);
+	REQUIRE(wq.kth(0) == 1);
+	REQUIRE(wq.kth(4) == 5);
+	REQUIRE(wq.quantile(0.0) == 1);
+	REQUIRE(wq.quantile(1.0) == 5);
+	REQUIRE_THROWS_AS(wq.kth(5), std::out_of_range);
+
+	// Evicts the 5.
+	REQUIRE(!wq.push_back(10));
+	REQUIRE(wq.kth(4) == 10);
+	REQUIRE(wq.median() == 3);
+
+	wq.pop_front();
+	REQUIRE(wq.size() == 4);
+	REQUIRE(wq.median() == 3);
+	REQUIRE(wq.kth(0) == 2);
+
+	wq.clear();
+	REQUIRE(wq.empty());
+	wq.push_back(7);
+	REQUIRE(wq.median() == 7);
+}
+
+TEST_CASE("Exact quantiles agree with sorting the window", "[windowed_quantile]")
+{
+	std::mt19937 rng(1234);
+	std::uniform_int_distribution<int> values(0, 50);
+	for (std::size_t window : { 1u, 2u, 9u, 100u }) {
+		windowed_quantile<int> wq(window);
+		std::deque<int> reference;
+		for (int i = 0; i < 3000; ++i) {
+			const int v = values(rng);
+			wq.push_back(v);
+			reference.push_back(v);
+			if (reference.size() > window)
+				reference.pop_front();
+			if (i % 13 == 0) {
+				wq.pop_front();
+				reference.pop_front();
+			}
+			REQUIRE(wq.size() == reference.size());
+			if (reference.empty())
+				continue;
+			for (double q : { 0.0, 0.1, 0.5, 0.99, 1.0 })
+				REQUIRE(wq.quantile(q) == nearest_rank(reference, q));
+		}
+	}
+}
+
+TEST_CASE("Approximate quantiles stay within a bucket", "[windowed_quantile]")
+{
+	REQUIRE_THROWS_AS(approximate_windowed_quantile<double>(10, 1.0, 1.0), std::invalid_argument);
+
+	std::mt19937 rng(99);
+	std::exponential_distribution<double> latency(1.0 / 20.0);
+	approximate_windowed_quantile<double> awq(1000, 0.0, 200.0, 2000);
+	std::deque<double> reference;
+	const double bucket = 200.0 / 2000;
+	for (int i = 0; i < 5000; ++i) {
+		const double v = std::min(latency(rng), 199.0);
+		awq.push_back(v);
+		reference.push_back(v);
+		if (reference.size() > 1000)
+			reference.pop_front();
+		if (i % 97 == 0) {
+			for (double q : { 0.5, 0.9, 0.99 })
+				REQUIRE(std::abs(awq.quantile(q) - nearest_rank(reference, q)) <= bucket / 2 + 1e-9);
+		}
+	}
+
+	awq.pop_front();
+	REQUIRE(awq.size() == 999);
+	awq.clear();
+	REQUIRE(awq.empty());
+	awq.push_back(-5.0);
+	REQUIRE(awq.median() == Approx(bucket / 2));
+}
+
+TEST_CASE("Approximate quantiles reject NaN", "[windowed_quantile]")
+{
+	const double nan = std::numeric_limits<double>::quiet_NaN();
+	const double inf = std::numeric_limits<double>::infinity();
+	REQUIRE_THROWS_AS(approximate_windowed_quantile<double>(10, 0.0, inf), std::invalid_argument);
+	REQUIRE_THROWS_AS(approximate_windowed_quantile<double>(10, nan, 1.0), std::invalid_argument);
+
+	approximate_windowed_quantile<double> awq(3, 0.0, 10.0, 10);
+	awq.push_back(1.5);
+	awq.push_back(2.5);
+	awq.push_back(3.5);
+	REQUIRE_THROWS_AS(awq.push_back(nan), std::invalid_argument);
+	// The full window kept its oldest value.
+	REQUIRE(awq.size() == 3);
+	REQUIRE(awq.quantile(0.0) == Approx(1.5));
+	// Infinities still land in the end buckets.
+	awq.push_back(inf);
+	awq.push_back(-inf);
+	REQUIRE(awq.quantile(0.0) == Approx(0.5));
+	REQUIRE(awq.quantile(1.0) == Approx(9.5));
+}
+
+TEST_CASE("Window sizes that 32-bit node numbers cannot index", "[windowed_quantile]")
+{
+	REQUIRE_THROWS_AS(windowed_quantile<int>(0), std::invalid_argument);
+	REQUIRE_THROWS_AS(windowed_quantile<int>(std::numeric_limits<std::uint32_t>::max()), std::length_error);
+	REQUIRE_THROWS_AS(windowed_quantile<int>(std::numeric_limits<std::size_t>::max()), std::length_error);
+}
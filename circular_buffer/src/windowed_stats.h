@@ -0,0 +1,189 @@
+// windowed_stats.h
+//
+// Running mean/variance over the last N samples. The samples live in a
+// circular_buffer; every push_back updates the statistics with Welford's
+// recurrence, including the step that retires the sample being overwritten,
+// so each update and each query is O(1) instead of a rescan of the window.
+//
+// Sliding updates round a little each time, and the error left by a spell of
+// large samples stays in m_m2 after they leave: subtracting their big
+// contributions back out cancels most of the significant bits. So the
+// statistics are recomputed from the stored window (two passes) after every
+// capacity() replacements, and early when m_m2 falls far enough below its
+// peak since the last recompute that cancellation may have eaten its
+// precision. Early recomputes are at most one per capacity() updates, so
+// with the periodic ones the amortized cost stays O(1) however the input
+// shrinks; input that keeps shrinking faster than that can leave the
+// variance imprecise until the next recompute. Between recomputes the
+// samples are shifted by the last recomputed mean, so a large common offset
+// does not swamp the updates either.
+//
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "circular_buffer.h"
+
+template <typename T = double, typename A = std::allocator<T>>
+class windowed_stats
+{
+public:
+	using window_type = circular_buffer<T, A>;
+	using value_type = T;
+	using size_type = typename window_type::size_type;
+
+	explicit windowed_stats(std::size_t window, const A& allocator = A())
+		: m_window(window, allocator)
+	{}
+
+	// Same contract as circular_buffer::push_back: returns false when the
+	// oldest sample was evicted to make room.
+	bool push_back(const value_type& value)
+	{
+		if (empty())
+			m_shift = static_cast<double>(value);
+		const double x = static_cast<double>(value) - m_shift;
+		if (full()) {
+			// Replace the oldest sample with x, keeping n fixed.
+			const double y = static_cast<double>(m_window.front()) - m_shift;
+			const double n = static_cast<double>(m_window.size());
+			const double old_mean = m_mean;
+			m_mean += (x - y) / n;
+			m_m2 += (x - y) * (x - m_mean + y - old_mean);
+			m_window.push_back(value);
+			after_sliding_update();
+			return false;
+		}
+		const double n = static_cast<double>(m_window.size() + 1);
+		const double delta = x - m_mean;
+		m_mean += delta / n;
+		m_m2 += delta * (x - m_mean);
+		if (m_m2 > m_m2_peak)
+			m_m2_peak = m_m2;
+		return m_window.push_back(value);
+	}
+
+	void pop_front()
+	{
+		assert(!empty());
+		const double y = static_cast<double>(m_window.front()) - m_shift;
+		m_window.pop_front();
+		if (m_window.empty()) {
+			clear();
+			return;
+		}
+		const double n = static_cast<double>(m_window.size());
+		const double delta = y - m_mean;
+		m_mean -= delta / n;
+		m_m2 -= delta * (y - m_mean);
+		after_sliding_update();
+	}
+
+	void clear()
+	{
+		m_window.clear();
+		m_shift = 0.0;
+		m_mean = 0.0;
+		m_m2 = 0.0;
+		m_m2_peak = 0.0;
+		m_updates = 0;
+		m_sliding_updates = 0;
+		m_next_early_resync = 0;
+	}
+
+	size_type size() const { return m_window.size(); }
+	size_type capacity() const { return m_window.capacity(); }
+	bool empty() const { return m_window.empty(); }
+	bool full() const { return m_window.size() == m_window.capacity(); }
+
+	// The samples themselves, oldest first.
+	const window_type& window() const { return m_window; }
+
+	double sum() const { return mean() * static_cast<double>(size()); }
+
+	// All of the statistics are 0 for an empty window.
+	double mean() const { return m_shift + m_mean; }
+
+	// Population variance (divides by n).
+	double variance() const
+	{
+		return empty() ? 0.0 : m_m2 / static_cast<double>(size());
+	}
+
+	// Sample variance (divides by n - 1).
+	double sample_variance() const
+	{
+		return size() < 2 ? 0.0 : m_m2 / static_cast<double>(size() - 1);
+	}
+
+	double stddev() const { return std::sqrt(variance()); }
+	double sample_stddev() const { return std::sqrt(sample_variance()); }
+
+	// Number of times the statistics have been recomputed from the window
+	// since construction.
+	std::uint64_t recomputes() const { return m_recomputes; }
+
+private:
+	// m_m2 may have lost this many bits to cancellation.
+	static constexpr int cancellation_bits = 20;
+
+	void after_sliding_update()
+	{
+		++m_sliding_updates;
+		if (++m_updates >= capacity())
+			resync();
+		else if (m_m2 > m_m2_peak)
+			m_m2_peak = m_m2;
+		else if (m_m2 < std::ldexp(m_m2_peak, -cancellation_bits) && m_sliding_updates >= m_next_early_resync) {
+			resync();
+			m_next_early_resync = m_sliding_updates + capacity();
+		}
+	}
+
+	// Recomputes the statistics from the window: the mean, then the squared
+	// deviations from it, with the mean corrected by the deviations' sum.
+	void resync()
+	{
+		const auto n = static_cast<double>(m_window.size());
+		double sum = 0.0;
+		for (const value_type& v : m_window)
+			sum += static_cast<double>(v);
+		const double mean = sum / n;
+		double deviations = 0.0;
+		double squares = 0.0;
+		for (const value_type& v : m_window) {
+			const double d = static_cast<double>(v) - mean;
+			deviations += d;
+			squares += d * d;
+		}
+		m_shift = mean;
+		m_mean = deviations / n;
+		m_m2 = squares - deviations * deviations / n;
+		if (m_m2 < 0.0)
+			m_m2 = 0.0;
+		m_m2_peak = m_m2;
+		m_updates = 0;
+		++m_recomputes;
+	}
+
+	window_type m_window;
+	// Samples are taken relative to m_shift, roughly their mean, so the
+	// sliding updates work on small differences rather than large offsets.
+	double m_shift = 0.0;
+	// Mean of the shifted samples.
+	double m_mean = 0.0;
+	// Sum of squared deviations from m_mean.
+	double m_m2 = 0.0;
+	// The largest m_m2 since the last resync().
+	double m_m2_peak = 0.0;
+	// Sliding updates since the last resync().
+	size_type m_updates = 0;
+	// Sliding updates since construction or clear(), and the count at which
+	// the next early resync() is allowed.
+	std::uint64_t m_sliding_updates = 0;
+	std::uint64_t m_next_early_resync = 0;
+	std::uint64_t m_recomputes = 0;
+};
@@ -0,0 +1,169 @@
+#include "catch.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <random>
+
+#include "windowed_stats.h"
+
+namespace {
+
+struct naive_stats {
+	double mean = 0.0;
+	double variance = 0.0;
+};
+
+naive_stats compute(const std::deque<double>& samples)
+{
+	naive_stats s;
+	if (samples.empty())
+		return s;
+	for (double x : samples)
+		s.mean += x;
+	s.mean /= samples.size();
+	for (double x : samples)
+		s.variance += (x - s.mean) * (x - s.mean);
+	s.variance /= samples.size();
+	return s;
+}
+
+} // namespace
+
+TEST_CASE("Empty and single sample windows", "[windowed_stats]")
+{
+	windowed_stats<> ws(4);
+	REQUIRE(ws.empty());
+	REQUIRE(ws.capacity() == 4);
+	REQUIRE(ws.mean() == 0.0);
+	REQUIRE(ws.variance() == 0.0);
+	REQUIRE(ws.sample_variance() == 0.0);
+
+	REQUIRE(ws.push_back(3.0));
+	REQUIRE(ws.size() == 1);
+	REQUIRE(ws.mean() == 3.0);
+	REQUIRE(ws.variance() == 0.0);
+	REQUIRE(ws.sample_variance() == 0.0);
+
+	ws.pop_front();
+	REQUIRE(ws.empty());
+	REQUIRE(ws.mean() == 0.0);
+}
+
+TEST_CASE("Statistics follow the window as samples are evicted", "[windowed_stats]")
+{
+	windowed_stats<int> ws(3);
+	ws.push_back(1);
+	ws.push_back(2);
+	ws.push_back(3);
+	REQUIRE(ws.full());
+	REQUIRE(ws.mean() == Approx(2.0));
+	REQUIRE(ws.variance() == Approx(2.0 / 3.0));
+	REQUIRE(ws.sample_variance() == Approx(1.0));
+	REQUIRE(ws.sum() == Approx(6.0));
+
+	REQUIRE(!ws.push_back(10));
+	REQUIRE(ws.size() == 3);
+	REQUIRE(ws.window().front() == 2);
+	REQUIRE(ws.mean() == Approx(5.0));
+	REQUIRE(ws.variance() == Approx(38.0 / 3.0));
+	REQUIRE(ws.stddev() == Approx(std::sqrt(38.0 / 3.0)));
+
+	ws.pop_front();
+	REQUIRE(ws.mean() == Approx(6.5));
+	REQUIRE(ws.variance() == Approx(12.25));
+
+	ws.clear();
+	REQUIRE(ws.empty());
+	REQUIRE(ws.mean() == 0.0);
+	REQUIRE(ws.variance() == 0.0);
+}
+
+TEST_CASE("Long runs agree with recomputing from scratch", "[windowed_stats]")
+{
+	windowed_stats<> ws(50);
+	std::deque<double> reference;
+	double x = 0.5;
+	for (int i = 0; i < 10000; ++i) {
+		// Large offset with small spread: the case that defeats sum-of-squares.
+		x = std::fmod(x * 3.7 + 0.11, 1.0);
+		const double sample = 1.0e6 + x;
+		ws.push_back(sample);
+		reference.push_back(sample);
+		if (reference.size() > 50)
+			reference.pop_front();
+		if (i % 7 == 0) {
+			ws.pop_front();
+			reference.pop_front();
+		}
+
+		const auto expected = compute(reference);
+		REQUIRE(ws.size() == reference.size());
+		REQUIRE(ws.mean() == Approx(expected.mean));
+		REQUIRE(ws.variance() == Approx(expected.variance).epsilon(1e-6).margin(1e-9));
+	}
+}
+
+TEST_CASE("Long runs that switch between high and low variance", "[windowed_stats]")
+{
+	// Spells of samples spread over +-1000 leave rounding error behind that is
+	// far larger than the variance of the spells spread over +-0.001.
+	for (double offset : { 0.0, 1.0e6, 1.0e9 }) {
+		windowed_stats<> ws(64);
+		std::deque<double> reference;
+		std::mt19937_64 rng(static_cast<std::uint64_t>(offset) + 1);
+		std::uniform_real_distribution<double> unit(-1.0, 1.0);
+		for (int i = 0; i < 100000; ++i) {
+			const double spread = (i / 1000) % 2 ? 0.001 : 1000.0;
+			const double sample = offset + spread * unit(rng);
+			ws.push_back(sample);
+			reference.push_back(sample);
+			if (reference.size() > 64)
+				reference.pop_front();
+			if (i % 701 == 0) {
+				ws.pop_front();
+				reference.pop_front();
+			}
+
+			const auto expected = compute(reference);
+			REQUIRE(ws.mean() == Approx(expected.mean).epsilon(1e-12).margin(1e-9));
+			REQUIRE(ws.variance() == Approx(expected.variance).epsilon(1e-5));
+		}
+	}
+}
+
+TEST_CASE("Shrinking input does not recompute on every update", "[windowed_stats]")
+{
+	// Each sample is 0.8 times the last, so the window's m2 falls below its
+	// peak by the cancellation threshold every 31 updates or so. Recomputing
+	// each time would cost O(window) per 31 updates.
+	const std::size_t window = 200;
+	const int updates = 1000;
+	windowed_stats<> ws(window);
+	std::deque<double> reference;
+	double sample = 1.0e100;
+	for (int i = 0; i < updates; ++i) {
+		ws.push_back(sample);
+		reference.push_back(sample);
+		if (reference.size() > window)
+			reference.pop_front();
+		sample *= 0.8;
+	}
+	// One periodic and at most one early recompute per window of updates.
+	CHECK(ws.recomputes() <= 2 * (updates / window + 1));
+
+	// Precision comes back with the next recompute once the input stops
+	// shrinking.
+	std::mt19937_64 rng(27);
+	std::uniform_real_distribution<double> unit(1.0, 2.0);
+	for (std::size_t i = 0; i < 2 * window; ++i) {
+		const double x = sample * unit(rng);
+		ws.push_back(x);
+		reference.push_back(x);
+		reference.pop_front();
+	}
+	const auto expected = compute(reference);
+	// Relative, as the samples are now far below Approx's default scale.
+	CHECK(ws.mean() / expected.mean == Approx(1.0).epsilon(1e-12));
+	CHECK(ws.variance() / expected.variance == Approx(1.0).epsilon(1e-5));
+}
@@ -0,0 +1,175 @@
+// work_stealing_deque.h
+//
+// Chase-Lev work-stealing deque, with the memory orderings of Le, Pop, Cohen
+// and Zappa Nardelli, "Correct and Efficient Work-Stealing for Weak Memory
+// Models" (PPoPP 2013).
+//
+// One owner thread pushes and pops at the bottom, LIFO, which keeps recently
+// spawned (cache-hot) work local. Any number of thieves steal from the top,
+// FIFO, taking the oldest and typically largest pieces of work. The owner's
+// push is plain stores plus a release fence, and pop uses no read-modify-write
+// unless it races a thief for the last element; a steal is one CAS on top.
+//
+// The storage is a power-of-two ring indexed by the ever-increasing top and
+// bottom counters, as in the other rings here. When push finds it full, the
+// owner copies the live range into a ring twice the size and swaps that in.
+// Thieves may still be reading the old ring, so retired rings are kept until
+// the deque is destroyed; that costs at most as much again as the largest
+// ring.
+//
+// Elements are read by thieves that may lose the race for them, so they must
+// be trivially copyable; in practice they are pointers or small handles.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "power_of_two.h"
+
+enum class steal_result { ok, empty, aborted };
+
+template <typename T>
+class work_stealing_deque
+{
+	static_assert(std::is_trivially_copyable<T>::value, "work_stealing_deque elements must be trivially copyable");
+
+public:
+	using value_type = T;
+	using size_type = std::size_t;
+
+	// capacity is the initial size, rounded up to a power of two; the deque
+	// grows as needed.
+	explicit work_stealing_deque(std::size_t capacity = 64)
+	{
+		m_rings.emplace_back(new ring(power_of_two::round_up(capacity)));
+		m_ring.store(m_rings.back().get(), std::memory_order_relaxed);
+	}
+
+	work_stealing_deque(const work_stealing_deque&) = delete;
+	work_stealing_deque& operator=(const work_stealing_deque&) = delete;
+
+	// Approximate when called while other threads are active.
+	size_type size() const
+	{
+		const std::int64_t b = m_bottom.value.load(std::memory_order_relaxed);
+		const std::int64_t t = m_top.value.load(std::memory_order_relaxed);
+		return b > t ? static_cast<size_type>(b - t) : 0;
+	}
+
+	bool empty() const { return size() == 0; }
+
+	size_type capacity() const { return m_ring.load(std::memory_order_relaxed)->capacity(); }
+
+	// Owner only.
+	void push(const value_type& value)
+	{
+		const std::int64_t b = m_bottom.value.load(std::memory_order_relaxed);
+		const std::int64_t t = m_top.value.load(std::memory_order_acquire);
+		ring* r = m_ring.load(std::memory_order_relaxed);
+		if (b - t > static_cast<std::int64_t>(r->capacity()) - 1)
+			r = grow(r, t, b);
+		r->put(b, value);
+		std::atomic_thread_fence(std::memory_order_release);
+		m_bottom.value.store(b + 1, std::memory_order_relaxed);
+	}
+
+	// Owner only. Takes the most recently pushed element; false if empty.
+	bool pop(value_type& out)
+	{
+		const std::int64_t b = m_bottom.value.load(std::memory_order_relaxed) - 1;
+		ring* const r = m_ring.load(std::memory_order_relaxed);
+		m_bottom.value.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		std::int64_t t = m_top.value.load(std::memory_order_relaxed);
+
+		if (t > b) {
+			// Was already empty.
+			m_bottom.value.store(b + 1, std::memory_order_relaxed);
+			return false;
+		}
+		const value_type value = r->get(b);
+		if (t == b) {
+			// The last element: race the thieves for it.
+			const bool won = m_top.value.compare_exchange_strong(t, t + 1,
+				std::memory_order_seq_cst, std::memory_order_relaxed);
+			m_bottom.value.store(b + 1, std::memory_order_relaxed);
+			if (!won)
+				return false;
+		}
+		out = value;
+		return true;
+	}
+
+	// Any thread. Takes the oldest element. Returns aborted if another thread
+	// took it first, in which case the deque may well still have work.
+	steal_result steal(value_type& out)
+	{
+		std::int64_t t = m_top.value.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const std::int64_t b = m_bottom.value.load(std::memory_order_acquire);
+		if (t >= b)
+			return steal_result::empty;
+
+		// Acquire rather than consume, which compilers promote anyway.
+		const ring* const r = m_ring.load(std::memory_order_acquire);
+		const value_type value = r->get(t);
+		if (!m_top.value.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			return steal_result::aborted;
+		out = value;
+		return steal_result::ok;
+	}
+
+private:
+	class ring
+	{
+	public:
+		explicit ring(std::size_t capacity)
+			: m_mask{ capacity - 1 },
+			m_slots(new std::atomic<value_type>[capacity])
+		{}
+
+		std::size_t capacity() const { return m_mask + 1; }
+
+		value_type get(std::int64_t i) const
+		{
+			return m_slots[static_cast<std::size_t>(i) & m_mask].load(std::memory_order_relaxed);
+		}
+
+		void put(std::int64_t i, const value_type& value)
+		{
+			m_slots[static_cast<std::size_t>(i) & m_mask].store(value, std::memory_order_relaxed);
+		}
+
+	private:
+		const std::size_t m_mask;
+		std::unique_ptr<std::atomic<value_type>[]> m_slots;
+	};
+
+	// Keeps the indices apart so that the owner and the thieves do not
+	// false-share.
+	struct alignas(64) padded_index {
+		std::atomic<std::int64_t> value{ 0 };
+	};
+
+	ring* grow(ring* old, std::int64_t top, std::int64_t bottom)
+	{
+		m_rings.emplace_back(new ring(old->capacity() * 2));
+		ring* const bigger = m_rings.back().get();
+		for (std::int64_t i = top; i < bottom; ++i)
+			bigger->put(i, old->get(i));
+		m_ring.store(bigger, std::memory_order_release);
+		return bigger;
+	}
+
+	padded_index m_top;
+	padded_index m_bottom;
+	std::atomic<ring*> m_ring{ nullptr };
+	// Every ring ever used, owned here; touched only by the owner.
+	std::vector<std::unique_ptr<ring>> m_rings;
+};
@@ -0,0 +1,219 @@
+#include "catch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "wait_strategy.h"
+#include "work_stealing_deque.h"
+
+namespace {
+
+// The baseline: a std::deque per worker behind a mutex.
+template <typename T>
+class locked_deque
+{
+public:
+	void push(const T& value)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_items.push_back(value);
+	}
+
+	bool pop(T& out)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_items.empty())
+			return false;
+		out = m_items.back();
+		m_items.pop_back();
+		return true;
+	}
+
+	steal_result steal(T& out)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_items.empty())
+			return steal_result::empty;
+		out = m_items.front();
+		m_items.pop_front();
+		return steal_result::ok;
+	}
+
+private:
+	std::mutex m_mutex;
+	std::deque<T> m_items;
+};
+
+struct job;
+
+// A fork-join pool: the calling thread is worker 0, and a worker waiting for
+// its children to finish runs other jobs meanwhile (its own first, then
+// stolen ones), so nobody blocks.
+template <template <typename> class Deque>
+class pool
+{
+public:
+	explicit pool(unsigned workers)
+		: m_queues(workers)
+	{
+		for (auto& q : m_queues)
+			q.reset(new Deque<job*>());
+		for (unsigned i = 1; i < workers; ++i) {
+			m_threads.emplace_back([this, i] {
+				while (!m_stop.load(std::memory_order_acquire)) {
+					if (!run_one(i))
+						std::this_thread::yield();
+				}
+			});
+		}
+	}
+
+	~pool()
+	{
+		m_stop.store(true, std::memory_order_release);
+		for (auto& t : m_threads)
+			t.join();
+	}
+
+	void spawn(unsigned self, job* j) { m_queues[self]->push(j); }
+
+	void wait(unsigned self, const std::atomic<int>& pending)
+	{
+		while (pending.load(std::memory_order_acquire) != 0) {
+			if (!run_one(self))
+				cpu_relax();
+		}
+	}
+
+private:
+	bool run_one(unsigned self);
+
+	std::vector<std::unique_ptr<Deque<job*>>> m_queues;
+	std::vector<std::thread> m_threads;
+	std::atomic<bool> m_stop{ false };
+};
+
+struct job {
+	virtual ~job() = default;
+	virtual void run(unsigned self) = 0;
+	std::atomic<int>* done = nullptr;
+};
+
+template <template <typename> class Deque>
+bool pool<Deque>::run_one(unsigned self)
+{
+	job* j = nullptr;
+	bool found = m_queues[self]->pop(j);
+	for (std::size_t k = 1; !found && k < m_queues.size(); ++k)
+		found = m_queues[(self + k) % m_queues.size()]->steal(j) == steal_result::ok;
+	if (!found)
+		return false;
+	j->run(self);
+	j->done->fetch_sub(1, std::memory_order_release);
+	return true;
+}
+
+std::uint64_t serial_fib(unsigned n)
+{
+	return n < 2 ? n : serial_fib(n - 1) + serial_fib(n - 2);
+}
+
+// Parallel fib with a cutoff: fork n - 1, compute n - 2 inline, join.
+template <template <typename> class Deque>
+struct fib_job : job {
+	fib_job(pool<Deque>& p, unsigned n) : m_pool{ p }, m_n{ n } {}
+
+	void run(unsigned self) override
+	{
+		if (m_n < 20) {
+			result = serial_fib(m_n);
+			return;
+		}
+		std::atomic<int> pending{ 1 };
+		fib_job child(m_pool, m_n - 1);
+		child.done = &pending;
+		m_pool.spawn(self, &child);
+		fib_job sibling(m_pool, m_n - 2);
+		sibling.run(self);
+		m_pool.wait(self, pending);
+		result = child.result + sibling.result;
+	}
+
+	pool<Deque>& m_pool;
+	unsigned m_n;
+	std::uint64_t result = 0;
+};
+
+// Parallel sum by recursive halving down to 4096-element leaves.
+template <template <typename> class Deque>
+struct sum_job : job {
+	sum_job(pool<Deque>& p, const std::uint32_t* first, std::size_t count) : m_pool{ p }, m_first{ first }, m_count{ count } {}
+
+	void run(unsigned self) override
+	{
+		if (m_count <= 4096) {
+			for (std::size_t i = 0; i < m_count; ++i)
+				result += m_first[i];
+			return;
+		}
+		const std::size_t half = m_count / 2;
+		std::atomic<int> pending{ 1 };
+		sum_job left(m_pool, m_first, half);
+		left.done = &pending;
+		m_pool.spawn(self, &left);
+		sum_job right(m_pool, m_first + half, m_count - half);
+		right.run(self);
+		m_pool.wait(self, pending);
+		result = left.result + right.result;
+	}
+
+	pool<Deque>& m_pool;
+	const std::uint32_t* m_first;
+	std::size_t m_count;
+	std::uint64_t result = 0;
+};
+
+template <template <typename> class Deque>
+void measure(const char* name, unsigned workers, const std::vector<std::uint32_t>& data)
+{
+	pool<Deque> p(workers);
+
+	auto start = std::chrono::steady_clock::now();
+	fib_job<Deque> fib(p, 32);
+	fib.run(0);
+	const double fib_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	start = std::chrono::steady_clock::now();
+	sum_job<Deque> sum(p, data.data(), data.size());
+	sum.run(0);
+	const double sum_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	std::printf("%-22s %2u workers  fib(32) %8.2f ms  sum %8.2f ms  (%llu, %llu)\n", name, workers, fib_ms, sum_ms,
+		static_cast<unsigned long long>(fib.result), static_cast<unsigned long long>(sum.result));
+}
+
+} // namespace
+
+TEST_CASE("Fork-join scaling with work-stealing and mutex-protected deques", "[.][benchmark][work_stealing_deque]")
+{
+	std::vector<std::uint32_t> data(1 << 24);
+	for (std::size_t i = 0; i < data.size(); ++i)
+		data[i] = static_cast<std::uint32_t>(i * 2654435761u);
+
+	const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+	for (unsigned workers = 1;; workers = std::min(workers * 2, cores)) {
+		measure<work_stealing_deque>("work_stealing_deque", workers, data);
+		measure<locked_deque>("mutex + std::deque", workers, data);
+		if (workers == cores)
+			break;
+	}
+	SUCCEED();
+}
@@ -0,0 +1,105 @@
+#include "catch.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "work_stealing_deque.h"
+
+TEST_CASE("Owner pops LIFO and thieves steal FIFO", "[work_stealing_deque]")
+{
+	work_stealing_deque<int> deque(4);
+	int value = 0;
+	REQUIRE(!deque.pop(value));
+	REQUIRE(deque.steal(value) == steal_result::empty);
+
+	for (int i = 1; i <= 4; ++i)
+		deque.push(i);
+	REQUIRE(deque.size() == 4);
+
+	REQUIRE(deque.pop(value));
+	REQUIRE(value == 4);
+	REQUIRE(deque.steal(value) == steal_result::ok);
+	REQUIRE(value == 1);
+	REQUIRE(deque.steal(value) == steal_result::ok);
+	REQUIRE(value == 2);
+	REQUIRE(deque.pop(value));
+	REQUIRE(value == 3);
+	REQUIRE(!deque.pop(value));
+	REQUIRE(deque.empty());
+}
+
+TEST_CASE("Growing keeps the contents across the wrap", "[work_stealing_deque]")
+{
+	work_stealing_deque<int> deque(4);
+	int value = 0;
+	// Move top and bottom along so that the live range wraps.
+	for (int i = 0; i < 3; ++i)
+		deque.push(-1);
+	for (int i = 0; i < 3; ++i)
+		REQUIRE(deque.steal(value) == steal_result::ok);
+
+	for (int i = 0; i < 100; ++i)
+		deque.push(i);
+	REQUIRE(deque.capacity() == 128);
+	REQUIRE(deque.size() == 100);
+
+	for (int i = 0; i < 50; ++i) {
+		REQUIRE(deque.steal(value) == steal_result::ok);
+		REQUIRE(value == i);
+	}
+	for (int i = 99; i >= 50; --i) {
+		REQUIRE(deque.pop(value));
+		REQUIRE(value == i);
+	}
+	REQUIRE(deque.empty());
+}
+
+TEST_CASE("Every element is taken exactly once under contention", "[work_stealing_deque]")
+{
+	constexpr int count = 200000;
+	work_stealing_deque<int> deque(8);
+	std::vector<std::atomic<int>> taken(count);
+	for (auto& t : taken)
+		t.store(0, std::memory_order_relaxed);
+	std::atomic<bool> done{ false };
+
+	std::vector<std::thread> thieves;
+	for (int i = 0; i < 3; ++i) {
+		thieves.emplace_back([&] {
+			int value = 0;
+			while (!done.load(std::memory_order_acquire)) {
+				if (deque.steal(value) == steal_result::ok)
+					taken[value].fetch_add(1, std::memory_order_relaxed);
+				else
+					std::this_thread::yield();
+			}
+		});
+	}
+
+	// The owner pushes in bursts and pops some back, so that pops and
+	// steals race for the last elements and the ring grows while thieves
+	// are reading it.
+	int value = 0;
+	for (int next = 0; next < count;) {
+		for (int i = 0; i < 37 && next < count; ++i)
+			deque.push(next++);
+		for (int i = 0; i < 20; ++i) {
+			if (deque.pop(value))
+				taken[value].fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+	while (deque.pop(value))
+		taken[value].fetch_add(1, std::memory_order_relaxed);
+	// Thieves may still be finishing steals of elements the owner saw
+	// before its last pop failed.
+	done.store(true, std::memory_order_release);
+	for (auto& t : thieves)
+		t.join();
+
+	int wrong = 0;
+	for (auto& t : taken)
+		wrong += t.load(std::memory_order_relaxed) != 1;
+	REQUIRE(wrong == 0);
+}